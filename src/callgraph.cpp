@@ -0,0 +1,617 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/callgraph.h"
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::set;
+using std::vector;
+
+namespace
+{
+    /** Returns the function called by a FUNCALL expression. */
+    function_t *getFunction(expression_t call)
+    {
+        symbol_t symbol = call[0].getSymbol();
+        if (!symbol.getType().isFunction())
+        {
+            return nullptr;
+        }
+        return static_cast<function_t*>(symbol.getData());
+    }
+
+    /** Collects the functions called by the expressions visited. */
+    class CollectCallsVisitor : public ExpressionVisitor
+    {
+    private:
+        set<function_t*> &callees;
+
+        void collect(expression_t expr)
+        {
+            if (expr.empty())
+            {
+                return;
+            }
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+            {
+                collect(expr[i]);
+            }
+            if (expr.getKind() == FUNCALL)
+            {
+                function_t *fun = getFunction(expr);
+                if (fun)
+                {
+                    callees.insert(fun);
+                }
+            }
+        }
+    protected:
+        void visitExpression(expression_t expr) override
+        {
+            collect(expr);
+        }
+    public:
+        CollectCallsVisitor(set<function_t*> &callees) : callees(callees) {}
+    };
+
+    /**
+     * Returns true if the expression can be evaluated any number of
+     * times without changing its value or the state.
+     */
+    bool isPure(expression_t expr)
+    {
+        if (expr.empty())
+        {
+            return true;
+        }
+        kind_t kind = expr.getKind();
+        if (kind == FUNCALL || kind == SPAWN || kind == EXIT
+            || (kind >= RANDOM_F && kind <= RANDOM_TRI_F))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+        {
+            if (!isPure(expr[i]))
+            {
+                return false;
+            }
+        }
+        return !expr.changesAnyVariable();
+    }
+
+    size_t getParameterCount(const function_t *fun)
+    {
+        return fun->uid.getType().size() - 1;
+    }
+
+    /** Returns the non-empty statements of a function body. */
+    vector<Statement*> getStatements(function_t *fun)
+    {
+        vector<Statement*> statements;
+        for (auto stat: *fun->body)
+        {
+            if (dynamic_cast<EmptyStatement*>(stat) == nullptr)
+            {
+                statements.push_back(stat);
+            }
+        }
+        return statements;
+    }
+
+    /** Collects the symbols named in \a expr. */
+    void collectIdentifiers(expression_t expr, set<symbol_t> &symbols)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        if (expr.getKind() == IDENTIFIER)
+        {
+            symbols.insert(expr.getSymbol());
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+        {
+            collectIdentifiers(expr[i], symbols);
+        }
+    }
+
+    /**
+     * Collects the symbols read to determine the variable an lvalue
+     * refers to, e.g. the index i of a[i].
+     */
+    void collectIndexReads(expression_t expr, set<symbol_t> &symbols)
+    {
+        switch (expr.getKind())
+        {
+        case IDENTIFIER:
+            break;
+        case DOT:
+            collectIndexReads(expr[0], symbols);
+            break;
+        case ARRAY:
+            collectIndexReads(expr[0], symbols);
+            expr[1].collectPossibleReads(symbols);
+            break;
+        default:
+            expr.collectPossibleReads(symbols);
+            break;
+        }
+    }
+
+    bool intersects(const set<symbol_t> &a, const set<symbol_t> &b)
+    {
+        return std::find_first_of(a.begin(), a.end(), b.begin(), b.end())
+            != a.end();
+    }
+
+    /** Substitutes the parameters of \a fun by the arguments of \a call. */
+    expression_t substitute(function_t *fun, expression_t call,
+                            expression_t expr)
+    {
+        frame_t frame = fun->body->getFrame();
+        for (size_t i = 0; i < getParameterCount(fun); ++i)
+        {
+            expr = expr.subst(frame[i], call[i + 1]);
+        }
+        return expr;
+    }
+}
+
+CallGraph::CallGraph(TimedAutomataSystem &system)
+    : system(system)
+{
+    addFunctions(system.getGlobals());
+    for (auto& templ: system.getTemplates())
+    {
+        addFunctions(templ);
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        addFunctions(*templ);
+    }
+    computeComponents();
+}
+
+void CallGraph::addFunctions(declarations_t &declarations)
+{
+    for (auto& fun: declarations.functions)
+    {
+        node_t &node = nodes[&fun];
+        node.component = 0;
+        node.recursive = false;
+        if (fun.body)
+        {
+            CollectCallsVisitor visitor(node.callees);
+            fun.body->accept(&visitor);
+        }
+    }
+}
+
+/**
+ * Tarjan's algorithm. Components are completed after all components
+ * reachable from them, thus callees end up before their callers.
+ */
+void CallGraph::computeComponents()
+{
+    map<const function_t*, size_t> index, lowlink;
+    vector<function_t*> stack;
+    set<const function_t*> onStack;
+    size_t next = 0;
+
+    std::function<void(function_t*)> visit = [&](function_t *fun) {
+        index[fun] = lowlink[fun] = next++;
+        stack.push_back(fun);
+        onStack.insert(fun);
+        for (auto callee: nodes[fun].callees)
+        {
+            if (index.find(callee) == index.end())
+            {
+                visit(callee);
+                lowlink[fun] = std::min(lowlink[fun], lowlink[callee]);
+            }
+            else if (onStack.find(callee) != onStack.end())
+            {
+                lowlink[fun] = std::min(lowlink[fun], index[callee]);
+            }
+        }
+        if (lowlink[fun] == index[fun])
+        {
+            size_t start = order.size();
+            function_t *member;
+            do
+            {
+                member = stack.back();
+                stack.pop_back();
+                onStack.erase(member);
+                order.push_back(member);
+                nodes[member].component = components.size();
+            } while (member != fun);
+            bool recursive = order.size() - start > 1
+                || nodes[fun].callees.count(fun) > 0;
+            for (size_t i = start; i < order.size(); ++i)
+            {
+                nodes[order[i]].recursive = recursive;
+            }
+            components.push_back(start);
+        }
+    };
+
+    /* Visit functions in declaration order to obtain a deterministic
+     * order.
+     */
+    auto visitAll = [&](declarations_t &declarations) {
+        for (auto& fun: declarations.functions)
+        {
+            if (index.find(&fun) == index.end())
+            {
+                visit(&fun);
+            }
+        }
+    };
+    visitAll(system.getGlobals());
+    for (auto& templ: system.getTemplates())
+    {
+        visitAll(templ);
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        visitAll(*templ);
+    }
+}
+
+const vector<function_t*> &CallGraph::getFunctions() const
+{
+    return order;
+}
+
+const set<function_t*> &CallGraph::getCallees(const function_t *fun) const
+{
+    auto node = nodes.find(fun);
+    assert(node != nodes.end());
+    return node->second.callees;
+}
+
+bool CallGraph::isRecursive(const function_t *fun) const
+{
+    auto node = nodes.find(fun);
+    return node != nodes.end() && node->second.recursive;
+}
+
+bool CallGraph::hasRecursion() const
+{
+    for (auto& node: nodes)
+    {
+        if (node.second.recursive)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CallGraph::computeSummaries()
+{
+    for (size_t c = 0; c < components.size(); ++c)
+    {
+        size_t begin = components[c];
+        size_t end = c + 1 < components.size() ? components[c + 1] : order.size();
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t i = begin; i < end; ++i)
+            {
+                function_t &fun = *order[i];
+                if (fun.body == nullptr)
+                {
+                    continue;
+                }
+                set<symbol_t> changes, depends;
+                CollectChangesVisitor visitor(changes);
+                fun.body->accept(&visitor);
+                CollectDependenciesVisitor visitor2(depends);
+                fun.body->accept(&visitor2);
+
+                /* The sets of callees in earlier components are final,
+                 * those in this component are approximated from below.
+                 */
+                for (auto callee: nodes[&fun].callees)
+                {
+                    changes.insert(callee->changes.begin(), callee->changes.end());
+                    depends.insert(callee->depends.begin(), callee->depends.end());
+                }
+                for (auto& variable: fun.variables)
+                {
+                    changes.erase(variable.uid);
+                    depends.erase(variable.uid);
+                }
+                for (size_t p = 0; p < getParameterCount(&fun); p++)
+                {
+                    changes.erase(fun.body->getFrame()[p]);
+                    depends.erase(fun.body->getFrame()[p]);
+                }
+                if (changes != fun.changes || depends != fun.depends)
+                {
+                    fun.changes.swap(changes);
+                    fun.depends.swap(depends);
+                    changed = nodes[&fun].recursive;
+                }
+            }
+        }
+    }
+}
+
+bool CallGraph::isInlineable(function_t *fun, size_t maxStatements,
+                             bool update) const
+{
+    if (fun == nullptr || fun->body == nullptr || isRecursive(fun)
+        || !fun->variables.empty())
+    {
+        return false;
+    }
+    vector<Statement*> statements = getStatements(fun);
+    if (statements.empty() || statements.size() > maxStatements)
+    {
+        return false;
+    }
+
+    type_t type = fun->uid.getType()[0];
+    if (update && type.isVoid())
+    {
+        /* A sequence of expression statements which does not assign
+         * to value parameters, optionally followed by a return.
+         */
+        set<symbol_t> params;
+        for (size_t i = 0; i < getParameterCount(fun); ++i)
+        {
+            symbol_t param = fun->body->getFrame()[i];
+            if (!param.getType().is(REF))
+            {
+                params.insert(param);
+            }
+        }
+        for (size_t i = 0; i < statements.size(); ++i)
+        {
+            ExprStatement *stat = dynamic_cast<ExprStatement*>(statements[i]);
+            if (stat == nullptr)
+            {
+                ReturnStatement *ret = dynamic_cast<ReturnStatement*>(statements[i]);
+                if (ret == nullptr || i + 1 < statements.size() || i == 0)
+                {
+                    return false;
+                }
+            }
+            else if (stat->expr.changesVariable(params))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* A single return statement without side effects.
+     */
+    ReturnStatement *ret = dynamic_cast<ReturnStatement*>(statements[0]);
+    if (type.isVoid() || statements.size() != 1 || ret == nullptr
+        || !fun->changes.empty() || !isPure(ret->value))
+    {
+        return false;
+    }
+    type_t value = ret->value.getType();
+    return (type.isIntegral() && value.isIntegral()
+            && type.isBoolean() == value.isBoolean())
+        || (type.isDouble() && value.isDouble());
+}
+
+expression_t CallGraph::inlineCall(expression_t call, bool update) const
+{
+    function_t *fun = getFunction(call);
+    vector<Statement*> statements = getStatements(fun);
+    if (!update || !fun->uid.getType()[0].isVoid())
+    {
+        ReturnStatement *ret = static_cast<ReturnStatement*>(statements[0]);
+        return substitute(fun, call, ret->value);
+    }
+
+    expression_t result;
+    for (auto stat: statements)
+    {
+        ExprStatement *expr = dynamic_cast<ExprStatement*>(stat);
+        if (expr == nullptr)
+        {
+            break; // the final return
+        }
+        expression_t e = substitute(fun, call, expr->expr);
+        if (result.empty())
+        {
+            result = e;
+        }
+        else
+        {
+            result = expression_t::createBinary(
+                COMMA, result, e, call.getPosition(), e.getType());
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns true if substituting the arguments of \a call for the
+ * parameters preserves its meaning. Value parameters are evaluated
+ * once on entry while their substitutes are evaluated at every use,
+ * and the variable a reference parameter refers to is fixed on entry,
+ * thus no argument may read a variable the body writes, except for
+ * the variable a reference argument refers to. Arguments to different
+ * reference parameters must not alias if one of them is written.
+ * Finally, the symbols named by the body must not be shadowed at the
+ * call site, where \a scope is the innermost frame.
+ */
+bool CallGraph::isSafeCall(expression_t call, frame_t scope) const
+{
+    function_t *fun = getFunction(call);
+    frame_t parameters = fun->body->getFrame();
+    vector<Statement*> statements = getStatements(fun);
+
+    set<symbol_t> changes, named;
+    for (auto stat: statements)
+    {
+        ExprStatement *expr = dynamic_cast<ExprStatement*>(stat);
+        ReturnStatement *ret = dynamic_cast<ReturnStatement*>(stat);
+        expression_t e = expr ? expr->expr : ret->value;
+        e.collectPossibleWrites(changes);
+        collectIdentifiers(e, named);
+    }
+
+    /* The variables written in terms of the call site. */
+    set<symbol_t> writes(fun->changes.begin(), fun->changes.end());
+    vector<set<symbol_t> > targets(getParameterCount(fun));
+    for (size_t i = 0; i < getParameterCount(fun); ++i)
+    {
+        expression_t arg = call[i + 1];
+        if (!isPure(arg))
+        {
+            return false;
+        }
+        if (parameters[i].getType().is(REF))
+        {
+            arg.getSymbols(targets[i]);
+            if (changes.count(parameters[i]))
+            {
+                writes.insert(targets[i].begin(), targets[i].end());
+            }
+        }
+    }
+
+    for (size_t i = 0; i < getParameterCount(fun); ++i)
+    {
+        set<symbol_t> reads;
+        if (!parameters[i].getType().is(REF))
+        {
+            call[i + 1].collectPossibleReads(reads);
+        }
+        else
+        {
+            collectIndexReads(call[i + 1], reads);
+            for (size_t j = i + 1; j < getParameterCount(fun); ++j)
+            {
+                if ((changes.count(parameters[i]) || changes.count(parameters[j]))
+                    && intersects(targets[i], targets[j]))
+                {
+                    return false;
+                }
+            }
+        }
+        if (intersects(reads, writes))
+        {
+            return false;
+        }
+        named.erase(parameters[i]);
+    }
+
+    for (auto& symbol: named)
+    {
+        symbol_t visible;
+        if (!scope.resolve(symbol.getName(), visible) || visible != symbol)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+expression_t CallGraph::inlineExpression(expression_t expr, frame_t scope,
+                                         size_t maxStatements, bool update,
+                                         size_t &count) const
+{
+    if (expr.empty())
+    {
+        return expr;
+    }
+
+    /* Only the operands of the comma operator are updates on their
+     * own, everything else contributes a value.
+     */
+    bool sequence = update && expr.getKind() == COMMA;
+    expression_t result = expr;
+    for (uint32_t i = 0; i < expr.getSize(); ++i)
+    {
+        expression_t sub = inlineExpression(expr[i], scope, maxStatements,
+                                            sequence, count);
+        if (!(sub == expr[i]))
+        {
+            if (result == expr)
+            {
+                result = expr.clone();
+            }
+            result[i] = sub;
+        }
+    }
+
+    if (result.getKind() != FUNCALL)
+    {
+        return result;
+    }
+    if (!isInlineable(getFunction(result), maxStatements, update)
+        || !isSafeCall(result, scope))
+    {
+        return result;
+    }
+    ++count;
+    return inlineExpression(inlineCall(result, update), scope, maxStatements,
+                            update, count);
+}
+
+size_t CallGraph::inlineCalls(size_t maxStatements)
+{
+    size_t count = 0;
+    auto inlineTemplate = [&](template_t &templ) {
+        for (auto& state: templ.states)
+        {
+            state.invariant = inlineExpression(
+                state.invariant, templ.frame, maxStatements, false, count);
+        }
+        for (auto& edge: templ.edges)
+        {
+            edge.guard = inlineExpression(
+                edge.guard, edge.select, maxStatements, false, count);
+            edge.assign = inlineExpression(
+                edge.assign, edge.select, maxStatements, true, count);
+        }
+    };
+    for (auto& templ: system.getTemplates())
+    {
+        inlineTemplate(templ);
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        inlineTemplate(*templ);
+    }
+    return count;
+}
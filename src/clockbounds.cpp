@@ -0,0 +1,604 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/clockbounds.h"
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::ostream;
+using std::vector;
+
+const int32_t ClockBounds::none;
+const int32_t ClockBounds::unknown;
+const uint32_t ClockBounds::noClock;
+
+namespace
+{
+    /** Whether a constraint must hold, must not hold or either. */
+    enum polarity_t { POSITIVE = 1, NEGATIVE = 2, BOTH = 3 };
+
+    int flip(int polarity)
+    {
+        return ((polarity & POSITIVE) << 1) | ((polarity & NEGATIVE) >> 1);
+    }
+
+    /** Returns the function called by a FUNCALL expression. */
+    function_t *getFunction(expression_t call)
+    {
+        symbol_t symbol = call[0].getSymbol();
+        if (!symbol.getType().isFunction())
+        {
+            return nullptr;
+        }
+        return static_cast<function_t*>(symbol.getData());
+    }
+
+    /** Substitutes the parameters of \a fun by the arguments of \a call. */
+    expression_t substitute(const function_t *fun, expression_t call,
+                            expression_t expr)
+    {
+        frame_t frame = fun->body->getFrame();
+        for (size_t i = 0; i + 1 < fun->uid.getType().size(); ++i)
+        {
+            expr = expr.subst(frame[i], call[i + 1]);
+        }
+        return expr;
+    }
+
+    /**
+     * Passes the expressions of a function body to a callback, telling
+     * whether they are returned.
+     */
+    class BodyVisitor : public ExpressionVisitor
+    {
+    private:
+        std::function<void(expression_t, bool)> callback;
+        bool returned;
+    protected:
+        void visitExpression(expression_t expr) override
+        {
+            callback(expr, returned);
+        }
+    public:
+        BodyVisitor(std::function<void(expression_t, bool)> callback)
+            : callback(callback), returned(false) {}
+
+        int32_t visitReturnStatement(ReturnStatement *stat) override
+        {
+            returned = true;
+            visitExpression(stat->value);
+            returned = false;
+            return 0;
+        }
+    };
+
+    /** Collects the clocks assigned at the top level of \a expr. */
+    void collectResets(expression_t expr, vector<symbol_t> &resets)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        if (expr.getKind() == COMMA)
+        {
+            collectResets(expr[0], resets);
+            collectResets(expr[1], resets);
+        }
+        else if (expr.getKind() == ASSIGN && expr[0].getKind() == IDENTIFIER
+                 && expr[0].getType().isClock())
+        {
+            resets.push_back(expr[0].getSymbol());
+        }
+    }
+}
+
+symbol_t ClockBounds::clockOf(expression_t expr)
+{
+    if (!expr.getType().isClock())
+    {
+        return symbol_t();
+    }
+    while (expr.getKind() == ARRAY || expr.getKind() == DOT)
+    {
+        expr = expr[0];
+    }
+    return expr.getKind() == IDENTIFIER ? expr.getSymbol() : symbol_t();
+}
+
+ClockBounds::ClockBounds(TimedAutomataSystem &system):
+    system(system), evaluator(system)
+{
+    for (auto& var: system.getGlobals().variables)
+    {
+        type_t type = var.uid.getType();
+        if (!type.is(REF) && type.stripArray().isClock()
+            && !system.isReferenceClock(var.uid))
+        {
+            globalClocks[var.uid] = clocks.size();
+            clocks.push_back({ var.uid, nullptr });
+        }
+    }
+
+    for (auto& templ: system.getTemplates())
+    {
+        if (templ.isTA)
+        {
+            analyse(templ, templates[&templ]);
+        }
+    }
+
+    for (auto& instance: system.getProcesses())
+    {
+        auto i = templates.find(instance.templ);
+        process_t process;
+        process.instance = &instance;
+        process.info = i == templates.end() ? nullptr : &i->second;
+        process.firstLocal = clocks.size();
+        process.locals = process.info ? process.info->clocks.size() : 0;
+        clocks.resize(clocks.size() + process.locals);
+        if (process.info)
+        {
+            for (auto& local: process.info->clocks)
+            {
+                clocks[process.firstLocal + local.second] =
+                    { local.first, &instance };
+            }
+        }
+        processes.push_back(process);
+        if (process.info)
+        {
+            evaluator.bind(instance);
+            propagate(processes.back());
+            evaluator.clear();
+        }
+    }
+
+    totals.assign(clocks.size(), { none, none });
+    uint32_t globals = globalClocks.size();
+    for (auto& process: processes)
+    {
+        uint32_t columns = globals + process.locals;
+        for (size_t i = 0; i < process.bounds.size(); ++i)
+        {
+            uint32_t column = i % columns;
+            bounds_t &total = totals[column < globals ? column
+                                     : process.firstLocal + column - globals];
+            total.lower = std::max(total.lower, process.bounds[i].lower);
+            total.upper = std::max(total.upper, process.bounds[i].upper);
+        }
+    }
+}
+
+/**
+ * Collects the clock constraints of a guard or an invariant, where
+ * \a polarity tells whether they must hold or not. Functions are
+ * followed unless they are already being collected in \a calls.
+ */
+void ClockBounds::collect(expression_t expr, int polarity,
+                          vector<atom_t> &atoms,
+                          vector<const function_t*> &calls) const
+{
+    if (expr.empty())
+    {
+        return;
+    }
+
+    /* Adds the atoms of side ~ value unless side is not a clock. */
+    auto add = [polarity, &atoms](expression_t side, expression_t value,
+                                  bool lower, bool upper) {
+        /* Fold integer offsets into the value: x + e ~ c is x ~ c - e. */
+        while (!value.getType().isClock()
+               && (side.getKind() == PLUS || side.getKind() == MINUS))
+        {
+            kind_t inverse = side.getKind() == PLUS ? MINUS : PLUS;
+            if (side[1].getType().isIntegral())
+            {
+                value = expression_t::createBinary(
+                    inverse, value, side[1], side.getPosition(), value.getType());
+                side = side[0];
+            }
+            else if (side.getKind() == PLUS && side[0].getType().isIntegral())
+            {
+                value = expression_t::createBinary(
+                    MINUS, value, side[0], side.getPosition(), value.getType());
+                side = side[1];
+            }
+            else
+            {
+                break;
+            }
+        }
+        bool l = ((polarity & POSITIVE) && lower)
+            || ((polarity & NEGATIVE) && upper);
+        bool u = ((polarity & POSITIVE) && upper)
+            || ((polarity & NEGATIVE) && lower);
+        symbol_t clock = clockOf(side);
+        if (clock != symbol_t())
+        {
+            if (!value.getType().isClock())
+            {
+                atoms.push_back({ clock, value, l, u, false });
+            }
+            return true;
+        }
+        if (side.getKind() == MINUS)
+        {
+            symbol_t a = clockOf(side[0]), b = clockOf(side[1]);
+            if (a != symbol_t() && b != symbol_t())
+            {
+                atoms.push_back({ a, value, true, true, true });
+                atoms.push_back({ b, value, true, true, true });
+                return true;
+            }
+        }
+        return false;
+    };
+
+    kind_t kind = expr.getKind();
+    switch (kind)
+    {
+    case LT: case LE: case GE: case GT: case EQ: case NEQ:
+    {
+        bool lower = kind != LT && kind != LE;
+        bool upper = kind != GT && kind != GE;
+        if (add(expr[0], expr[1], lower, upper)
+            || add(expr[1], expr[0], upper, lower))
+        {
+            return;
+        }
+        break;
+    }
+    case NOT:
+        collect(expr[0], flip(polarity), atoms, calls);
+        return;
+    case AND:
+    case OR:
+        collect(expr[0], polarity, atoms, calls);
+        collect(expr[1], polarity, atoms, calls);
+        return;
+    case INLINEIF:
+        collect(expr[0], BOTH, atoms, calls);
+        collect(expr[1], polarity, atoms, calls);
+        collect(expr[2], polarity, atoms, calls);
+        return;
+    case FUNCALL:
+        collectCall(expr, polarity, atoms, calls);
+        break;
+    default:
+        break;
+    }
+    for (uint32_t i = 0; i < expr.getSize(); ++i)
+    {
+        collect(expr[i], BOTH, atoms, calls);
+    }
+}
+
+/**
+ * Collects the clock constraints in the body of the function called,
+ * with its parameters replaced by the arguments.
+ */
+void ClockBounds::collectCall(expression_t call, int polarity,
+                              vector<atom_t> &atoms,
+                              vector<const function_t*> &calls) const
+{
+    const function_t *fun = getFunction(call);
+    if (fun == nullptr || fun->body == nullptr
+        || std::find(calls.begin(), calls.end(), fun) != calls.end())
+    {
+        return;
+    }
+    calls.push_back(fun);
+    BodyVisitor visitor([&](expression_t expr, bool returned) {
+        collect(substitute(fun, call, expr), returned ? polarity : BOTH,
+                atoms, calls);
+    });
+    fun->body->accept(&visitor);
+    calls.pop_back();
+}
+
+/** Collects the constraints and resets of a template once. */
+void ClockBounds::analyse(const template_t &templ, templinfo_t &info) const
+{
+    vector<const function_t*> calls;
+    uint32_t locations = templ.states.size();
+    info.nodes = locations + templ.branchpoints.size();
+    info.invariants.resize(locations);
+    for (auto& state: templ.states)
+    {
+        collect(state.invariant, POSITIVE, info.invariants[state.locNr], calls);
+    }
+    for (auto& edge: templ.edges)
+    {
+        edgeinfo_t e;
+        e.src = edge.src ? edge.src->locNr : locations + edge.srcb->bpNr;
+        e.dst = edge.dst ? edge.dst->locNr : locations + edge.dstb->bpNr;
+        collect(edge.guard, POSITIVE, e.atoms, calls);
+        collectResets(edge.assign, e.resets);
+        info.edges.push_back(e);
+    }
+    for (auto& var: templ.variables)
+    {
+        type_t type = var.uid.getType();
+        if (!type.is(REF) && type.stripArray().isClock())
+        {
+            uint32_t offset = info.clocks.size();
+            info.clocks.emplace(var.uid, offset);
+        }
+    }
+}
+
+/**
+ * Evaluates the constraints of a process and propagates the bounds
+ * backwards along the edges not resetting the clocks.
+ */
+void ClockBounds::propagate(process_t &process)
+{
+    const templinfo_t &info = *process.info;
+    uint32_t columns = globalClocks.size() + process.locals;
+    vector<bounds_t> &bounds = process.bounds;
+    bounds.assign(info.nodes * columns, { none, none });
+
+    auto add = [&](uint32_t node, const atom_t &atom) {
+        uint32_t clock = resolve(process, atom.clock);
+        if (clock == noClock)
+        {
+            return;
+        }
+        int32_t value;
+        if (!evaluator.evaluate(atom.value, value))
+        {
+            value = unknown;
+        }
+        else if (atom.diagonal && value < 0)
+        {
+            value = value == INT32_MIN ? unknown : -value;
+        }
+        bounds_t &b = bounds[node * columns + getColumn(process, clock)];
+        if (atom.lower)
+        {
+            b.lower = std::max(b.lower, value);
+        }
+        if (atom.upper)
+        {
+            b.upper = std::max(b.upper, value);
+        }
+    };
+    for (uint32_t l = 0; l < info.invariants.size(); ++l)
+    {
+        for (auto& atom: info.invariants[l])
+        {
+            add(l, atom);
+        }
+    }
+
+    vector<vector<uint32_t> > incoming(info.nodes);
+    vector<vector<uint32_t> > resets(info.edges.size()); // by column
+    for (uint32_t e = 0; e < info.edges.size(); ++e)
+    {
+        const edgeinfo_t &edge = info.edges[e];
+        for (auto& atom: edge.atoms)
+        {
+            add(edge.src, atom);
+        }
+        for (auto& reset: edge.resets)
+        {
+            uint32_t clock = resolve(process, reset);
+            if (clock != noClock)
+            {
+                resets[e].push_back(getColumn(process, clock));
+            }
+        }
+        incoming[edge.dst].push_back(e);
+    }
+
+    vector<uint32_t> queue;
+    vector<bool> queued(info.nodes, true);
+    for (uint32_t n = 0; n < info.nodes; ++n)
+    {
+        queue.push_back(n);
+    }
+    while (!queue.empty())
+    {
+        uint32_t node = queue.back();
+        queue.pop_back();
+        queued[node] = false;
+        for (uint32_t e: incoming[node])
+        {
+            uint32_t src = info.edges[e].src;
+            bool changed = false;
+            for (uint32_t c = 0; c < columns; ++c)
+            {
+                if (std::find(resets[e].begin(), resets[e].end(), c)
+                    != resets[e].end())
+                {
+                    continue;
+                }
+                const bounds_t &from = bounds[node * columns + c];
+                bounds_t &to = bounds[src * columns + c];
+                if (from.lower > to.lower)
+                {
+                    to.lower = from.lower;
+                    changed = true;
+                }
+                if (from.upper > to.upper)
+                {
+                    to.upper = from.upper;
+                    changed = true;
+                }
+            }
+            if (changed && !queued[src])
+            {
+                queued[src] = true;
+                queue.push_back(src);
+            }
+        }
+    }
+
+    /* The branchpoints come last. */
+    bounds.resize(info.invariants.size() * columns);
+}
+
+uint32_t ClockBounds::resolve(const process_t &process, symbol_t uid) const
+{
+    if (process.info)
+    {
+        auto local = process.info->clocks.find(uid);
+        if (local != process.info->clocks.end())
+        {
+            return process.firstLocal + local->second;
+        }
+    }
+    auto arg = process.instance->mapping.find(uid);
+    if (arg != process.instance->mapping.end())
+    {
+        uid = clockOf(arg->second);
+    }
+    auto global = globalClocks.find(uid);
+    return global == globalClocks.end() ? noClock : global->second;
+}
+
+/** Returns the column of \a clock in the bounds of \a process, or noClock. */
+uint32_t ClockBounds::getColumn(const process_t &process, uint32_t clock) const
+{
+    uint32_t globals = globalClocks.size();
+    if (clock < globals)
+    {
+        return clock;
+    }
+    if (clock >= process.firstLocal
+        && clock < process.firstLocal + process.locals)
+    {
+        return globals + clock - process.firstLocal;
+    }
+    return noClock;
+}
+
+uint32_t ClockBounds::findClock(uint32_t process, symbol_t uid) const
+{
+    return resolve(processes[process], uid);
+}
+
+ClockBounds::bounds_t ClockBounds::getBounds(uint32_t clock) const
+{
+    return totals[clock];
+}
+
+ClockBounds::bounds_t ClockBounds::getBounds(uint32_t process,
+                                             uint32_t clock) const
+{
+    const process_t &p = processes[process];
+    uint32_t column = getColumn(p, clock);
+    bounds_t total = { none, none };
+    if (column == noClock)
+    {
+        return total;
+    }
+    uint32_t columns = globalClocks.size() + p.locals;
+    for (size_t i = column; i < p.bounds.size(); i += columns)
+    {
+        total.lower = std::max(total.lower, p.bounds[i].lower);
+        total.upper = std::max(total.upper, p.bounds[i].upper);
+    }
+    return total;
+}
+
+ClockBounds::bounds_t ClockBounds::getBounds(uint32_t process,
+                                             const state_t &location,
+                                             uint32_t clock) const
+{
+    const process_t &p = processes[process];
+    uint32_t column = getColumn(p, clock);
+    if (column == noClock || p.bounds.empty())
+    {
+        return { none, none };
+    }
+    uint32_t columns = globalClocks.size() + p.locals;
+    return p.bounds[location.locNr * columns + column];
+}
+
+/* Prints a bound as a number, "-" if none or "?" if unknown. */
+static void printBound(ostream &os, int32_t bound)
+{
+    if (bound == ClockBounds::none)
+    {
+        os << "-";
+    }
+    else if (bound == ClockBounds::unknown)
+    {
+        os << "?";
+    }
+    else
+    {
+        os << bound;
+    }
+}
+
+void ClockBounds::print(ostream &os) const
+{
+    auto name = [this](uint32_t clock) {
+        const clock_t &c = clocks[clock];
+        return c.process ? c.process->uid.getName() + "." + c.uid.getName()
+            : c.uid.getName();
+    };
+    auto bounds = [&os](const bounds_t &b) {
+        printBound(os, b.lower);
+        os << "/";
+        printBound(os, b.upper);
+    };
+
+    for (uint32_t c = 0; c < clocks.size(); ++c)
+    {
+        os << "clock " << name(c) << ": ";
+        bounds(totals[c]);
+        os << "\n";
+    }
+    for (uint32_t p = 0; p < processes.size(); ++p)
+    {
+        const process_t &process = processes[p];
+        if (process.info == nullptr)
+        {
+            continue;
+        }
+        os << "process " << process.instance->uid.getName() << "\n";
+        for (auto& state: process.instance->templ->states)
+        {
+            os << "  location " << state.uid.getName() << ":";
+            uint32_t columns = globalClocks.size() + process.locals;
+            for (uint32_t c = 0; c < columns; ++c)
+            {
+                uint32_t clock = c < globalClocks.size() ? c
+                    : process.firstLocal + c - globalClocks.size();
+                const bounds_t &b = process.bounds[state.locNr * columns + c];
+                if (b.lower != none || b.upper != none)
+                {
+                    os << " " << name(clock) << " ";
+                    bounds(b);
+                }
+            }
+            os << "\n";
+        }
+    }
+}
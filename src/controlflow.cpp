@@ -0,0 +1,754 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/controlflow.h"
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::ostream;
+using std::set;
+using std::vector;
+
+namespace
+{
+    /**
+     * Lowers statements into basic blocks. Blocks following a jump
+     * (break, continue, return) are unreachable and are pruned
+     * afterwards.
+     */
+    class Lowering : public AbstractStatementVisitor
+    {
+    private:
+        vector<basicblock_t> &blocks;
+        set<symbol_t> locals;
+        size_t current;
+        size_t exit;
+        vector<size_t> breaks;
+        vector<size_t> continues;
+
+        size_t create()
+        {
+            blocks.push_back(basicblock_t());
+            return blocks.size() - 1;
+        }
+
+        void jump(size_t target)
+        {
+            blocks[current].successors.push_back(target);
+        }
+
+        void emit(instruction_t::type_t type, expression_t expr,
+                  symbol_t symbol = symbol_t())
+        {
+            blocks[current].instructions.push_back(
+                instruction_t(type, expr, symbol));
+        }
+
+        void lower(Statement *stat)
+        {
+            if (stat)
+            {
+                stat->accept(this);
+            }
+        }
+
+        /* Local variables are initialised where their block starts. */
+        void define(BlockStatement *block)
+        {
+            frame_t frame = block->getFrame();
+            for (uint32_t i = 0; i < frame.getSize(); ++i)
+            {
+                symbol_t symbol = frame[i];
+                if (locals.find(symbol) != locals.end())
+                {
+                    variable_t *var = static_cast<variable_t*>(symbol.getData());
+                    emit(instruction_t::DEFINE, var->expr, symbol);
+                }
+            }
+        }
+
+    public:
+        Lowering(function_t &fun, vector<basicblock_t> &blocks)
+            : blocks(blocks)
+        {
+            for (auto& variable: fun.variables)
+            {
+                locals.insert(variable.uid);
+            }
+            current = create();
+            exit = create();
+            lower(fun.body);
+            jump(exit);
+        }
+
+        size_t getExit() const { return exit; }
+
+        int32_t visitExprStatement(ExprStatement *stat) override
+        {
+            emit(instruction_t::EVAL, stat->expr);
+            return 0;
+        }
+
+        int32_t visitAssertStatement(AssertStatement *stat) override
+        {
+            emit(instruction_t::ASSERT, stat->expr);
+            return 0;
+        }
+
+        int32_t visitForStatement(ForStatement *stat) override
+        {
+            if (!stat->init.empty())
+            {
+                emit(instruction_t::EVAL, stat->init);
+            }
+            size_t header = create();
+            size_t body = create();
+            size_t step = create();
+            size_t after = create();
+            jump(header);
+            current = header;
+            if (stat->cond.empty())
+            {
+                jump(body);
+            }
+            else
+            {
+                emit(instruction_t::BRANCH, stat->cond);
+                jump(body);
+                jump(after);
+            }
+            breaks.push_back(after);
+            continues.push_back(step);
+            current = body;
+            lower(stat->stat);
+            jump(step);
+            current = step;
+            if (!stat->step.empty())
+            {
+                emit(instruction_t::EVAL, stat->step);
+            }
+            jump(header);
+            breaks.pop_back();
+            continues.pop_back();
+            current = after;
+            return 0;
+        }
+
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            size_t header = create();
+            size_t body = create();
+            size_t after = create();
+            jump(header);
+            current = header;
+            emit(instruction_t::ITERATE, expression_t(), stat->symbol);
+            jump(body);
+            jump(after);
+            breaks.push_back(after);
+            continues.push_back(header);
+            current = body;
+            lower(stat->stat);
+            jump(header);
+            breaks.pop_back();
+            continues.pop_back();
+            current = after;
+            return 0;
+        }
+
+        int32_t visitWhileStatement(WhileStatement *stat) override
+        {
+            size_t header = create();
+            size_t body = create();
+            size_t after = create();
+            jump(header);
+            current = header;
+            emit(instruction_t::BRANCH, stat->cond);
+            jump(body);
+            jump(after);
+            breaks.push_back(after);
+            continues.push_back(header);
+            current = body;
+            lower(stat->stat);
+            jump(header);
+            breaks.pop_back();
+            continues.pop_back();
+            current = after;
+            return 0;
+        }
+
+        int32_t visitDoWhileStatement(DoWhileStatement *stat) override
+        {
+            size_t body = create();
+            size_t cond = create();
+            size_t after = create();
+            jump(body);
+            breaks.push_back(after);
+            continues.push_back(cond);
+            current = body;
+            lower(stat->stat);
+            jump(cond);
+            current = cond;
+            emit(instruction_t::BRANCH, stat->cond);
+            jump(body);
+            jump(after);
+            breaks.pop_back();
+            continues.pop_back();
+            current = after;
+            return 0;
+        }
+
+        int32_t visitBlockStatement(BlockStatement *stat) override
+        {
+            define(stat);
+            for (auto s: *stat)
+            {
+                lower(s);
+            }
+            return 0;
+        }
+
+        int32_t visitSwitchStatement(SwitchStatement *stat) override
+        {
+            define(stat);
+            emit(instruction_t::SWITCH, stat->cond);
+            size_t selector = current;
+            size_t after = create();
+            bool hasDefault = false;
+            bool first = true;
+            breaks.push_back(after);
+            for (auto s: *stat)
+            {
+                /* Cases fall through to the next one.
+                 */
+                size_t entry = create();
+                if (!first)
+                {
+                    jump(entry);
+                }
+                first = false;
+                CaseStatement *label = dynamic_cast<CaseStatement*>(s);
+                blocks[selector].cases.push_back(
+                    label ? label->cond : expression_t());
+                blocks[selector].successors.push_back(entry);
+                hasDefault |= label == nullptr;
+                current = entry;
+                visitBlockStatement(static_cast<BlockStatement*>(s));
+            }
+            if (!first)
+            {
+                jump(after);
+            }
+            if (!hasDefault)
+            {
+                blocks[selector].cases.push_back(expression_t());
+                blocks[selector].successors.push_back(after);
+            }
+            breaks.pop_back();
+            current = after;
+            return 0;
+        }
+
+        int32_t visitCaseStatement(CaseStatement *stat) override
+        {
+            return visitBlockStatement(stat);
+        }
+
+        int32_t visitDefaultStatement(DefaultStatement *stat) override
+        {
+            return visitBlockStatement(stat);
+        }
+
+        int32_t visitIfStatement(IfStatement *stat) override
+        {
+            emit(instruction_t::BRANCH, stat->cond);
+            size_t trueCase = create();
+            size_t falseCase = create();
+            size_t after = create();
+            jump(trueCase);
+            jump(falseCase);
+            current = trueCase;
+            lower(stat->trueCase);
+            jump(after);
+            current = falseCase;
+            lower(stat->falseCase);
+            jump(after);
+            current = after;
+            return 0;
+        }
+
+        int32_t visitBreakStatement(BreakStatement *stat) override
+        {
+            assert(!breaks.empty());
+            jump(breaks.back());
+            current = create();
+            return 0;
+        }
+
+        int32_t visitContinueStatement(ContinueStatement *stat) override
+        {
+            assert(!continues.empty());
+            jump(continues.back());
+            current = create();
+            return 0;
+        }
+
+        int32_t visitReturnStatement(ReturnStatement *stat) override
+        {
+            emit(instruction_t::RETURN, stat->value);
+            jump(exit);
+            current = create();
+            return 0;
+        }
+    };
+
+    /**
+     * Collects the symbols whose value is used by an expression. The
+     * target of a plain assignment to a variable is not used, while
+     * partial updates (array elements, record fields) use the old
+     * value. Function calls use everything the callee depends on or
+     * changes.
+     */
+    void collectUses(expression_t expr, set<symbol_t> &uses)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        switch (expr.getKind())
+        {
+        case IDENTIFIER:
+            uses.insert(expr.getSymbol());
+            break;
+        case ASSIGN:
+            if (expr[0].getKind() != IDENTIFIER)
+            {
+                collectUses(expr[0], uses);
+            }
+            collectUses(expr[1], uses);
+            break;
+        case FUNCALL:
+        {
+            symbol_t symbol = expr[0].getSymbol();
+            if (symbol.getType().isFunction())
+            {
+                function_t *fun = static_cast<function_t*>(symbol.getData());
+                uses.insert(fun->depends.begin(), fun->depends.end());
+                uses.insert(fun->changes.begin(), fun->changes.end());
+            }
+            for (uint32_t i = 1; i < expr.getSize(); ++i)
+            {
+                collectUses(expr[i], uses);
+            }
+            break;
+        }
+        default:
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+            {
+                collectUses(expr[i], uses);
+            }
+        }
+    }
+}
+
+ControlFlowGraph::ControlFlowGraph(function_t &fun)
+    : fun(fun), exit(none), ssa(false)
+{
+    Lowering lowering(fun, blocks);
+    prune(lowering.getExit());
+    computeDominators();
+}
+
+/**
+ * Removes unreachable blocks and renumbers the remaining ones in
+ * reverse postorder.
+ */
+void ControlFlowGraph::prune(size_t oldExit)
+{
+    vector<size_t> postorder;
+    vector<bool> visited(blocks.size(), false);
+    vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(0, 0);
+    visited[0] = true;
+    while (!stack.empty())
+    {
+        size_t block = stack.back().first;
+        size_t &next = stack.back().second;
+        if (next < blocks[block].successors.size())
+        {
+            size_t succ = blocks[block].successors[next++];
+            if (!visited[succ])
+            {
+                visited[succ] = true;
+                stack.emplace_back(succ, 0);
+            }
+        }
+        else
+        {
+            postorder.push_back(block);
+            stack.pop_back();
+        }
+    }
+
+    vector<size_t> number(blocks.size(), none);
+    vector<basicblock_t> reachable;
+    for (auto i = postorder.rbegin(); i != postorder.rend(); ++i)
+    {
+        number[*i] = reachable.size();
+        reachable.push_back(blocks[*i]);
+    }
+    for (size_t i = 0; i < reachable.size(); ++i)
+    {
+        for (auto& succ: reachable[i].successors)
+        {
+            succ = number[succ];
+            reachable[succ].predecessors.push_back(i);
+        }
+    }
+    blocks.swap(reachable);
+    exit = number[oldExit];
+}
+
+/**
+ * The iterative algorithm by Cooper, Harvey and Kennedy. Since blocks
+ * are numbered in reverse postorder, comparing numbers is comparing
+ * postorder positions.
+ */
+void ControlFlowGraph::computeDominators()
+{
+    size_t n = blocks.size();
+    idom.assign(n, none);
+    idom[0] = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t b = 1; b < n; ++b)
+        {
+            size_t dom = none;
+            for (auto pred: blocks[b].predecessors)
+            {
+                if (idom[pred] == none)
+                {
+                    continue;
+                }
+                if (dom == none)
+                {
+                    dom = pred;
+                    continue;
+                }
+                size_t other = pred;
+                while (dom != other)
+                {
+                    while (dom > other)
+                    {
+                        dom = idom[dom];
+                    }
+                    while (other > dom)
+                    {
+                        other = idom[other];
+                    }
+                }
+            }
+            if (idom[b] != dom)
+            {
+                idom[b] = dom;
+                changed = true;
+            }
+        }
+    }
+    idom[0] = none;
+
+    dominated.assign(n, vector<size_t>());
+    for (size_t b = 1; b < n; ++b)
+    {
+        dominated[idom[b]].push_back(b);
+    }
+
+    frontier.assign(n, vector<size_t>());
+    for (size_t b = 0; b < n; ++b)
+    {
+        if (blocks[b].predecessors.size() < 2)
+        {
+            continue;
+        }
+        for (auto pred: blocks[b].predecessors)
+        {
+            for (size_t runner = pred; runner != idom[b]; runner = idom[runner])
+            {
+                vector<size_t> &df = frontier[runner];
+                if (std::find(df.begin(), df.end(), b) == df.end())
+                {
+                    df.push_back(b);
+                }
+                if (runner == 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+const basicblock_t &ControlFlowGraph::operator[](size_t block) const
+{
+    assert(block < blocks.size());
+    return blocks[block];
+}
+
+size_t ControlFlowGraph::getImmediateDominator(size_t block) const
+{
+    assert(block < blocks.size());
+    return idom[block];
+}
+
+bool ControlFlowGraph::dominates(size_t a, size_t b) const
+{
+    for (; b != none; b = idom[b])
+    {
+        if (a == b)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const vector<size_t> &ControlFlowGraph::getDominanceFrontier(size_t block) const
+{
+    assert(block < blocks.size());
+    return frontier[block];
+}
+
+const vector<size_t> &ControlFlowGraph::getDominated(size_t block) const
+{
+    assert(block < blocks.size());
+    return dominated[block];
+}
+
+uint32_t ControlFlowGraph::getVersions(symbol_t symbol) const
+{
+    auto i = versions.find(symbol);
+    return i == versions.end() ? 1 : i->second + 1;
+}
+
+void ControlFlowGraph::constructSSA()
+{
+    if (ssa)
+    {
+        return;
+    }
+    ssa = true;
+
+    /* Determine uses and definitions of all instructions.
+     */
+    map<symbol_t, set<size_t>> sites;
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        for (auto& instr: blocks[b].instructions)
+        {
+            set<symbol_t> uses, defs;
+            switch (instr.type)
+            {
+            case instruction_t::DEFINE:
+                defs.insert(instr.symbol);
+                collectUses(instr.expr, uses);
+                break;
+            case instruction_t::ITERATE:
+                defs.insert(instr.symbol);
+                uses.insert(instr.symbol);
+                break;
+            default:
+                collectUses(instr.expr, uses);
+                instr.expr.collectPossibleWrites(defs);
+            }
+            for (auto& symbol: uses)
+            {
+                instr.uses[symbol] = 0;
+            }
+            for (auto& symbol: defs)
+            {
+                instr.defs[symbol] = 0;
+                sites[symbol].insert(b);
+            }
+        }
+    }
+
+    /* Place phi functions at the iterated dominance frontiers.
+     */
+    for (auto& site: sites)
+    {
+        set<size_t> placed;
+        vector<size_t> work(site.second.begin(), site.second.end());
+        while (!work.empty())
+        {
+            size_t b = work.back();
+            work.pop_back();
+            for (auto d: frontier[b])
+            {
+                if (placed.insert(d).second)
+                {
+                    phi_t phi;
+                    phi.symbol = site.first;
+                    phi.version = 0;
+                    phi.operands.assign(blocks[d].predecessors.size(), 0);
+                    blocks[d].phis.push_back(phi);
+                    if (site.second.find(d) == site.second.end())
+                    {
+                        work.push_back(d);
+                    }
+                }
+            }
+        }
+    }
+
+    map<symbol_t, vector<uint32_t>> stacks;
+    rename(0, stacks);
+}
+
+/** Assigns versions in a preorder walk of the dominator tree. */
+void ControlFlowGraph::rename(size_t block,
+                              map<symbol_t, vector<uint32_t>> &stacks)
+{
+    auto top = [&](symbol_t symbol) -> uint32_t {
+        auto i = stacks.find(symbol);
+        return i == stacks.end() || i->second.empty() ? 0 : i->second.back();
+    };
+
+    vector<symbol_t> pushed;
+    basicblock_t &bb = blocks[block];
+    for (auto& phi: bb.phis)
+    {
+        phi.version = ++versions[phi.symbol];
+        stacks[phi.symbol].push_back(phi.version);
+        pushed.push_back(phi.symbol);
+    }
+    for (auto& instr: bb.instructions)
+    {
+        for (auto& use: instr.uses)
+        {
+            use.second = top(use.first);
+        }
+        for (auto& def: instr.defs)
+        {
+            def.second = ++versions[def.first];
+            stacks[def.first].push_back(def.second);
+            pushed.push_back(def.first);
+        }
+    }
+    for (auto succ: bb.successors)
+    {
+        basicblock_t &next = blocks[succ];
+        for (size_t j = 0; j < next.predecessors.size(); ++j)
+        {
+            if (next.predecessors[j] == block)
+            {
+                for (auto& phi: next.phis)
+                {
+                    phi.operands[j] = top(phi.symbol);
+                }
+            }
+        }
+    }
+    for (auto child: dominated[block])
+    {
+        rename(child, stacks);
+    }
+    for (auto& symbol: pushed)
+    {
+        stacks[symbol].pop_back();
+    }
+}
+
+void ControlFlowGraph::print(ostream &os) const
+{
+    static const char *names[] = {
+        "eval", "assert", "define", "branch", "switch", "iterate", "return"
+    };
+    auto printVersions = [&os](const char *label,
+                               const map<symbol_t, uint32_t> &symbols) {
+        if (!symbols.empty())
+        {
+            os << " " << label;
+            for (auto& s: symbols)
+            {
+                os << " " << s.first.getName() << "." << s.second;
+            }
+        }
+    };
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        const basicblock_t &bb = blocks[b];
+        os << "B" << b << ":";
+        if (b == exit)
+        {
+            os << " (exit)";
+        }
+        if (idom[b] != none)
+        {
+            os << " idom B" << idom[b];
+        }
+        os << "\n";
+        for (auto& phi: bb.phis)
+        {
+            os << "    " << phi.symbol.getName() << "." << phi.version << " = phi(";
+            for (size_t i = 0; i < phi.operands.size(); ++i)
+            {
+                os << (i ? ", " : "") << phi.symbol.getName() << "." << phi.operands[i];
+            }
+            os << ")\n";
+        }
+        for (auto& instr: bb.instructions)
+        {
+            os << "    " << names[instr.type];
+            if (instr.symbol != symbol_t())
+            {
+                os << " " << instr.symbol.getName();
+            }
+            if (!instr.expr.empty())
+            {
+                os << " " << instr.expr.toString();
+            }
+            if (ssa)
+            {
+                os << " [";
+                printVersions("uses", instr.uses);
+                printVersions("defs", instr.defs);
+                os << " ]";
+            }
+            os << "\n";
+        }
+        if (!bb.successors.empty())
+        {
+            os << "    ->";
+            for (auto succ: bb.successors)
+            {
+                os << " B" << succ;
+            }
+            os << "\n";
+        }
+    }
+}
@@ -0,0 +1,285 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/evaluator.h"
+
+#include <algorithm>
+
+using namespace UTAP;
+using namespace Constants;
+
+ConstantEvaluator::ConstantEvaluator(TimedAutomataSystem &system)
+{
+    system.accept(computable);
+}
+
+void ConstantEvaluator::bind(symbol_t symbol, int32_t value)
+{
+    bindings[symbol] = value;
+}
+
+void ConstantEvaluator::unbind(symbol_t symbol)
+{
+    bindings.erase(symbol);
+}
+
+bool ConstantEvaluator::bind(const instance_t &process)
+{
+    bool result = true;
+    for (auto& arg: process.mapping)
+    {
+        type_t type = arg.first.getType();
+        if (type.is(REF) || !type.isConstant() || !type.isIntegral())
+        {
+            continue;
+        }
+        int32_t value;
+        if (evaluate(arg.second, value))
+        {
+            bind(arg.first, value);
+        }
+        else
+        {
+            result = false;
+        }
+    }
+    return result;
+}
+
+void ConstantEvaluator::clear()
+{
+    bindings.clear();
+}
+
+/** Resolves an expression to the initialiser of a constant. */
+bool ConstantEvaluator::element(expression_t expr, expression_t &init) const
+{
+    switch (expr.getKind())
+    {
+    case IDENTIFIER:
+    {
+        symbol_t symbol = expr.getSymbol();
+        if (!computable.contains(symbol) || symbol.getData() == nullptr
+            || symbol.getType().isFunction())
+        {
+            return false;
+        }
+        init = static_cast<const variable_t*>(symbol.getData())->expr;
+        return !init.empty();
+    }
+    case ARRAY:
+    {
+        int32_t i;
+        expression_t array;
+        if (!element(expr[0], array) || array.getKind() != LIST
+            || !evaluate(expr[1], i) || i < 0 || (uint32_t)i >= array.getSize())
+        {
+            return false;
+        }
+        init = array[i];
+        return true;
+    }
+    case DOT:
+    {
+        expression_t record;
+        if (!element(expr[0], record) || record.getKind() != LIST
+            || expr.getIndex() < 0
+            || (uint32_t)expr.getIndex() >= record.getSize())
+        {
+            return false;
+        }
+        init = record[expr.getIndex()];
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool ConstantEvaluator::lookup(symbol_t symbol, int32_t &value) const
+{
+    auto binding = bindings.find(symbol);
+    if (binding != bindings.end())
+    {
+        value = binding->second;
+        return true;
+    }
+    expression_t init;
+    return element(expression_t::createIdentifier(symbol), init)
+        && evaluate(init, value);
+}
+
+bool ConstantEvaluator::evaluate(expression_t expr, int32_t &value) const
+{
+    if (expr.empty())
+    {
+        return false;
+    }
+
+    int32_t a, b;
+    kind_t kind = expr.getKind();
+    switch (kind)
+    {
+    case CONSTANT:
+        if (expr.getType().isDouble())
+        {
+            return false;
+        }
+        value = expr.getValue();
+        return true;
+
+    case IDENTIFIER:
+        return lookup(expr.getSymbol(), value);
+
+    case ARRAY:
+    case DOT:
+    {
+        expression_t init;
+        return element(expr, init) && evaluate(init, value);
+    }
+
+    case UNARY_MINUS:
+        if (!evaluate(expr[0], a) || a == INT32_MIN)
+        {
+            return false;
+        }
+        value = -a;
+        return true;
+
+    case NOT:
+        if (!evaluate(expr[0], a))
+        {
+            return false;
+        }
+        value = !a;
+        return true;
+
+    case INLINEIF:
+        if (!evaluate(expr[0], a))
+        {
+            return false;
+        }
+        return evaluate(expr[a ? 1 : 2], value);
+
+    case AND:
+    case OR:
+        /* Short circuit evaluation: the second operand need not be
+         * known.
+         */
+        if (!evaluate(expr[0], a))
+        {
+            return false;
+        }
+        if ((kind == AND && !a) || (kind == OR && a))
+        {
+            value = a != 0;
+            return true;
+        }
+        if (!evaluate(expr[1], b))
+        {
+            return false;
+        }
+        value = b != 0;
+        return true;
+
+    case PLUS: case MINUS: case MULT: case DIV: case MOD:
+    case BIT_AND: case BIT_OR: case BIT_XOR: case BIT_LSHIFT: case BIT_RSHIFT:
+    case XOR: case MIN: case MAX:
+    case LT: case LE: case EQ: case NEQ: case GE: case GT:
+        if (!evaluate(expr[0], a) || !evaluate(expr[1], b))
+        {
+            return false;
+        }
+        switch (kind)
+        {
+        /* Overflows and shifts by more than the width are not
+         * constant folded.
+         */
+        case PLUS:       return !__builtin_add_overflow(a, b, &value);
+        case MINUS:      return !__builtin_sub_overflow(a, b, &value);
+        case MULT:       return !__builtin_mul_overflow(a, b, &value);
+        case DIV:
+            if (b == 0 || (b == -1 && a == INT32_MIN))
+            {
+                return false;
+            }
+            value = a / b;
+            break;
+        case MOD:
+            if (b == 0 || (b == -1 && a == INT32_MIN))
+            {
+                return false;
+            }
+            value = a % b;
+            break;
+        case BIT_AND:    value = a & b; break;
+        case BIT_OR:     value = a | b; break;
+        case BIT_XOR:    value = a ^ b; break;
+        case BIT_LSHIFT:
+            if (b < 0 || b >= 32
+                || __builtin_mul_overflow(a, int64_t(1) << b, &value))
+            {
+                return false;
+            }
+            break;
+        case BIT_RSHIFT:
+            if (b < 0 || b >= 32)
+            {
+                return false;
+            }
+            value = a >> b;
+            break;
+        case XOR:        value = (a != 0) != (b != 0); break;
+        case MIN:        value = std::min(a, b); break;
+        case MAX:        value = std::max(a, b); break;
+        case LT:         value = a < b; break;
+        case LE:         value = a <= b; break;
+        case EQ:         value = a == b; break;
+        case NEQ:        value = a != b; break;
+        case GE:         value = a >= b; break;
+        case GT:         value = a > b; break;
+        default:         return false;
+        }
+        return true;
+
+    case ABS_F:
+        if (!evaluate(expr[0], a) || a == INT32_MIN)
+        {
+            return false;
+        }
+        value = a < 0 ? -a : a;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool ConstantEvaluator::evaluateRange(type_t type, int32_t &lower,
+                                      int32_t &upper) const
+{
+    if (!type.is(RANGE))
+    {
+        return false;
+    }
+    std::pair<expression_t, expression_t> range = type.getRange();
+    return evaluate(range.first, lower) && evaluate(range.second, upper);
+}
@@ -0,0 +1,251 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/flowgraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+using std::string;
+using std::vector;
+
+using namespace UTAP;
+
+const uint32_t FlowGraph::none;
+
+uint32_t FlowGraph::intern(const string &name,
+                           vector<string> &names, index_t &index)
+{
+    std::pair<index_t::iterator, bool> i = index.emplace(name, names.size());
+    if (i.second)
+    {
+        names.push_back(name);
+    }
+    return i.first->second;
+}
+
+uint32_t FlowGraph::addProcess(const string &name)
+{
+    return intern(name, processes, processIndex);
+}
+
+uint32_t FlowGraph::addChannel(const string &name)
+{
+    return intern(name, channels, channelIndex);
+}
+
+uint32_t FlowGraph::addVariable(const string &name)
+{
+    return intern(name, variables, variableIndex);
+}
+
+void FlowGraph::add(relation_t relation, uint32_t target, uint32_t label)
+{
+    assert(!processes.empty());
+    pairs[relation].push_back({ (uint32_t)processes.size() - 1, target, label });
+}
+
+void FlowGraph::merge(const FlowGraph &other)
+{
+    uint32_t offset = processes.size();
+    for (const string &name : other.processes)
+    {
+        addProcess(name);
+    }
+    vector<uint32_t> channelRename(other.channels.size());
+    for (size_t i = 0; i < other.channels.size(); ++i)
+    {
+        channelRename[i] = addChannel(other.channels[i]);
+    }
+    vector<uint32_t> variableRename(other.variables.size());
+    for (size_t i = 0; i < other.variables.size(); ++i)
+    {
+        variableRename[i] = addVariable(other.variables[i]);
+    }
+    for (int r = SEND; r <= WRITE; ++r)
+    {
+        const vector<uint32_t> &rename = r == READ || r == WRITE
+            ? variableRename : channelRename;
+        for (const pair_t &p : other.pairs[r])
+        {
+            pairs[r].push_back({ offset + p.process, rename[p.target],
+                                 p.label == none ? none
+                                 : channelRename[p.label] });
+        }
+    }
+}
+
+static uint32_t lookup(const std::unordered_map<string, uint32_t> &index,
+                      const string &name)
+{
+    std::unordered_map<string, uint32_t>::const_iterator i = index.find(name);
+    return i == index.end() ? FlowGraph::none : i->second;
+}
+
+uint32_t FlowGraph::findProcess(const string &name) const
+{
+    return lookup(processIndex, name);
+}
+
+uint32_t FlowGraph::findChannel(const string &name) const
+{
+    return lookup(channelIndex, name);
+}
+
+uint32_t FlowGraph::findVariable(const string &name) const
+{
+    return lookup(variableIndex, name);
+}
+
+const uint32_t *FlowGraph::findTarget(relation_t relation, uint32_t process,
+                                      uint32_t target) const
+{
+    range_t targets = getTargets(relation, process);
+    const uint32_t *i = std::lower_bound(targets.begin(), targets.end(), target);
+    return i != targets.end() && *i == target ? i : nullptr;
+}
+
+/**
+ * Sorts \a names alphabetically, updates \a index accordingly and
+ * returns the new id of every old id.
+ */
+vector<uint32_t> FlowGraph::sortNames(vector<string> &names, index_t &index)
+{
+    vector<uint32_t> order(names.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&names](uint32_t a, uint32_t b) {
+        return names[a] < names[b];
+    });
+
+    vector<uint32_t> rename(names.size());
+    vector<string> sorted(names.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        rename[order[i]] = i;
+        sorted[i].swap(names[order[i]]);
+        index[sorted[i]] = i;
+    }
+    names.swap(sorted);
+    return rename;
+}
+
+/* Orders none before all other ids. */
+static inline bool lessLabel(uint32_t a, uint32_t b)
+{
+    return a + 1 < b + 1;
+}
+
+void FlowGraph::buildRelation(relation_t relation, uint32_t targets,
+                              const vector<uint32_t> &rename,
+                              const vector<uint32_t> &channelRename)
+{
+    vector<pair_t> &ps = pairs[relation];
+    for (pair_t &p : ps)
+    {
+        p.target = rename[p.target];
+        if (p.label != none)
+        {
+            p.label = channelRename[p.label];
+        }
+    }
+    std::sort(ps.begin(), ps.end(), [](const pair_t &a, const pair_t &b) {
+        if (a.process != b.process)
+        {
+            return a.process < b.process;
+        }
+        if (a.target != b.target)
+        {
+            return a.target < b.target;
+        }
+        return lessLabel(a.label, b.label);
+    });
+    ps.erase(std::unique(ps.begin(), ps.end(),
+                         [](const pair_t &a, const pair_t &b) {
+                             return a.process == b.process
+                                 && a.target == b.target
+                                 && a.label == b.label;
+                         }),
+             ps.end());
+
+    /* Targets and labels from processes. */
+    csr_t &fw = forward[relation];
+    csr_t &ls = labels[relation];
+    fw.offsets.assign(processes.size() + 1, 0);
+    ls.offsets.assign(1, 0);
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        if (i == 0 || ps[i].process != ps[i - 1].process
+            || ps[i].target != ps[i - 1].target)
+        {
+            if (i > 0)
+            {
+                ls.offsets.push_back(ls.ids.size());
+            }
+            fw.ids.push_back(ps[i].target);
+            fw.offsets[ps[i].process + 1]++;
+        }
+        ls.ids.push_back(ps[i].label);
+    }
+    if (!ps.empty())
+    {
+        ls.offsets.push_back(ls.ids.size());
+    }
+    for (size_t p = 0; p < processes.size(); ++p)
+    {
+        fw.offsets[p + 1] += fw.offsets[p];
+    }
+
+    /* Sources of targets by counting sort, preserving process order. */
+    csr_t &bw = backward[relation];
+    bw.offsets.assign(targets + 1, 0);
+    for (uint32_t t : fw.ids)
+    {
+        bw.offsets[t + 1]++;
+    }
+    for (size_t t = 0; t < targets; ++t)
+    {
+        bw.offsets[t + 1] += bw.offsets[t];
+    }
+    bw.ids.resize(fw.ids.size());
+    vector<uint32_t> next(bw.offsets.begin(), bw.offsets.end() - 1);
+    for (uint32_t p = 0; p < processes.size(); ++p)
+    {
+        for (uint32_t t : getTargets(relation, p))
+        {
+            bw.ids[next[t]++] = p;
+        }
+    }
+
+    vector<pair_t>().swap(ps);
+}
+
+void FlowGraph::build()
+{
+    vector<uint32_t> channelRename = sortNames(channels, channelIndex);
+    vector<uint32_t> variableRename = sortNames(variables, variableIndex);
+    buildRelation(SEND, channels.size(), channelRename, channelRename);
+    buildRelation(RECEIVE, channels.size(), channelRename, channelRename);
+    buildRelation(READ, variables.size(), variableRename, channelRename);
+    buildRelation(WRITE, variables.size(), variableRename, channelRename);
+}
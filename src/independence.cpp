@@ -0,0 +1,276 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/independence.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::ostream;
+using std::set;
+using std::vector;
+
+namespace
+{
+    typedef map<symbol_t, uint32_t> index_t;
+
+    void add(const set<symbol_t> &symbols, const index_t &globals,
+             vector<uint32_t> &ids)
+    {
+        for (auto& symbol: symbols)
+        {
+            auto i = globals.find(symbol);
+            if (i != globals.end())
+            {
+                ids.push_back(i->second);
+            }
+        }
+    }
+
+    /**
+     * Adds the global symbols among \a symbols used by \a process to
+     * \a ids, following reference parameters to their arguments. With
+     * \a base only the variables an lvalue refers to are added and the
+     * symbols read by the argument are added to \a reads.
+     */
+    void resolve(const set<symbol_t> &symbols, const instance_t &process,
+                 const index_t &globals, bool base, vector<uint32_t> &ids,
+                 vector<uint32_t> &reads)
+    {
+        set<symbol_t> direct;
+        for (auto& symbol: symbols)
+        {
+            auto arg = process.mapping.find(symbol);
+            if (arg == process.mapping.end())
+            {
+                direct.insert(symbol);
+            }
+            else if (symbol.getType().is(REF))
+            {
+                set<symbol_t> used, read;
+                arg->second.collectPossibleReads(read);
+                if (base)
+                {
+                    arg->second.getSymbols(used);
+                    add(used, globals, ids);
+                    add(read, globals, reads);
+                }
+                else
+                {
+                    add(read, globals, ids);
+                }
+            }
+        }
+        add(direct, globals, ids);
+    }
+
+    void normalise(vector<uint32_t> &ids)
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    bool isCommitted(const state_t *state)
+    {
+        return state && state->uid.getType().is(COMMITTED);
+    }
+}
+
+Independence::Independence(TimedAutomataSystem &system):
+    system(system)
+{
+    index_t globals;
+    for (auto& var: system.getGlobals().variables)
+    {
+        globals.emplace(var.uid, globals.size());
+    }
+
+    vector<access_t> accesses;
+    firstEdges.push_back(0);
+    for (auto& process: system.getProcesses())
+    {
+        processes.push_back(&process);
+        if (process.templ->isTA)
+        {
+            for (auto& edge: process.templ->edges)
+            {
+                set<symbol_t> reads, writes, channels;
+                edge.guard.collectPossibleReads(reads);
+                edge.sync.collectPossibleReads(reads);
+                edge.assign.collectPossibleReads(reads);
+                if (edge.src)
+                {
+                    edge.src->invariant.collectPossibleReads(reads);
+                }
+                if (edge.dst)
+                {
+                    edge.dst->invariant.collectPossibleReads(reads);
+                }
+                edge.assign.collectPossibleWrites(writes);
+                if (!edge.sync.empty())
+                {
+                    edge.sync[0].getSymbols(channels);
+                }
+
+                access_t access;
+                resolve(reads, process, globals, false, access.reads,
+                        access.reads);
+                resolve(writes, process, globals, true, access.writes,
+                        access.reads);
+                resolve(channels, process, globals, true, access.channels,
+                        access.reads);
+                normalise(access.reads);
+                normalise(access.writes);
+                normalise(access.channels);
+                access.committed = isCommitted(edge.src)
+                    || isCommitted(edge.dst);
+                accesses.push_back(access);
+                edges.push_back(&edge);
+                owners.push_back(processes.size() - 1);
+            }
+        }
+        firstEdges.push_back(edges.size());
+    }
+
+    uint32_t count = edges.size();
+    words = (count + 63) / 64;
+    bits.assign(size_t(count) * words, 0);
+    if (system.hasPriorityDeclaration())
+    {
+        return;
+    }
+
+    /* Start from all pairs of different processes. */
+    for (uint32_t a = 0; a < count; ++a)
+    {
+        uint64_t *row = &bits[size_t(a) * words];
+        std::fill(row, row + words, ~uint64_t(0));
+        if (count % 64 != 0)
+        {
+            row[words - 1] = (uint64_t(1) << (count % 64)) - 1;
+        }
+        for (uint32_t b = firstEdges[owners[a]]; b < firstEdges[owners[a] + 1]; ++b)
+        {
+            row[b / 64] &= ~(uint64_t(1) << (b % 64));
+        }
+    }
+
+    /* Remove the conflicts, found through the variables and channels. */
+    vector<vector<uint32_t> > writers(globals.size()), accessors(globals.size());
+    vector<vector<uint32_t> > users(globals.size());
+    vector<uint32_t> all, committed;
+    for (uint32_t e = 0; e < count; ++e)
+    {
+        const access_t &access = accesses[e];
+        all.push_back(e);
+        if (access.committed)
+        {
+            committed.push_back(e);
+            continue;
+        }
+        for (uint32_t v: access.writes)
+        {
+            writers[v].push_back(e);
+            accessors[v].push_back(e);
+        }
+        for (uint32_t v: access.reads)
+        {
+            if (!std::binary_search(access.writes.begin(),
+                                    access.writes.end(), v))
+            {
+                accessors[v].push_back(e);
+            }
+        }
+        for (uint32_t c: access.channels)
+        {
+            users[c].push_back(e);
+        }
+    }
+    for (uint32_t v = 0; v < globals.size(); ++v)
+    {
+        clear(writers[v], accessors[v]);
+        clear(accessors[v], writers[v]);
+        clear(users[v], users[v]);
+    }
+    clear(committed, all);
+    clear(all, committed);
+}
+
+/* Makes the edges in \a rows dependent on the edges in \a columns. */
+void Independence::clear(const vector<uint32_t> &rows,
+                         const vector<uint32_t> &columns)
+{
+    if (rows.empty() || columns.empty())
+    {
+        return;
+    }
+    vector<uint64_t> mask(words, ~uint64_t(0));
+    for (uint32_t b: columns)
+    {
+        mask[b / 64] &= ~(uint64_t(1) << (b % 64));
+    }
+    for (uint32_t a: rows)
+    {
+        uint64_t *row = &bits[size_t(a) * words];
+        for (uint32_t w = 0; w < words; ++w)
+        {
+            row[w] &= mask[w];
+        }
+    }
+}
+
+/* Prints the source and target of an edge. */
+static void printEdge(ostream &os, const edge_t &edge)
+{
+    os << (edge.src ? edge.src->uid : edge.srcb->uid).getName() << " -> "
+       << (edge.dst ? edge.dst->uid : edge.dstb->uid).getName();
+}
+
+void Independence::print(ostream &os) const
+{
+    uint64_t pairs = 0;
+    for (uint64_t word: bits)
+    {
+        pairs += __builtin_popcountll(word);
+    }
+    os << "// " << edges.size() << " edges, " << pairs / 2
+       << " independent pairs\n";
+    for (uint32_t a = 0; a < edges.size(); ++a)
+    {
+        uint32_t count = 0;
+        for (uint32_t w = 0; w < words; ++w)
+        {
+            count += __builtin_popcountll(bits[size_t(a) * words + w]);
+        }
+        uint32_t others = edges.size()
+            - (firstEdges[owners[a] + 1] - firstEdges[owners[a]]);
+        os << "edge " << a << " " << processes[owners[a]]->uid.getName()
+           << ": ";
+        printEdge(os, *edges[a]);
+        os << ": independent of " << count << " of " << others
+           << " edges of other processes\n";
+    }
+}
@@ -0,0 +1,341 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/liveness.h"
+
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::ostream;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace
+{
+    typedef Liveness::bitset_t bitset_t;
+
+    /**
+     * The effect of an edge: the symbols it reads before possibly
+     * writing them and the symbols it always writes.
+     */
+    struct edgeinfo_t
+    {
+        uint32_t src, dst;      // nodes, branchpoints after the locations
+        bitset_t gen, kill;
+    };
+
+    /** Returns true if \a symbol is state of a process declared locally. */
+    bool isTracked(symbol_t symbol)
+    {
+        type_t type = symbol.getType();
+        type_t base = type.stripArray();
+        return !type.is(REF) && !type.isConstant()
+            && (base.isClock() || base.isIntegral() || base.isScalar()
+                || base.isRecord());
+    }
+
+    /** Flattens the top level sequence of an update. */
+    void flatten(expression_t expr, vector<expression_t> &exprs)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        if (expr.getKind() == COMMA)
+        {
+            flatten(expr[0], exprs);
+            flatten(expr[1], exprs);
+        }
+        else
+        {
+            exprs.push_back(expr);
+        }
+    }
+
+    /** Maps the symbols to their indices and joins them into \a bits. */
+    bool addSymbols(const set<symbol_t> &symbols,
+                    const map<symbol_t, uint32_t> &index, bitset_t &bits)
+    {
+        bool changed = false;
+        for (auto& symbol: symbols)
+        {
+            auto i = index.find(symbol);
+            if (i != index.end() && !bits[i->second])
+            {
+                bits[i->second] = true;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    /** Adds the symbols read by \a expr to \a bits. */
+    void addReads(expression_t expr, const map<symbol_t, uint32_t> &index,
+                  bitset_t &bits)
+    {
+        set<symbol_t> symbols;
+        expr.collectPossibleReads(symbols);
+        addSymbols(symbols, index, bits);
+    }
+}
+
+Liveness::Liveness(TimedAutomataSystem &system):
+    system(system)
+{
+    for (auto& templ: system.getTemplates())
+    {
+        if (templ.isTA)
+        {
+            index[&templ] = templates.size();
+            templates.emplace_back();
+            analyse(templ, templates.back());
+        }
+    }
+}
+
+/**
+ * Computes the live clocks and variables of every location of \a templ
+ * by a backwards fixpoint. Clocks come before variables in the
+ * internal bitsets, which are split at the end.
+ */
+void Liveness::analyse(const template_t &templ, templinfo_t &info) const
+{
+    info.templ = &templ;
+    vector<symbol_t> variables;
+    for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+    {
+        variables.push_back(templ.parameters[i]);
+    }
+    for (auto& var: templ.variables)
+    {
+        variables.push_back(var.uid);
+    }
+    for (auto& symbol: variables)
+    {
+        if (isTracked(symbol))
+        {
+            (symbol.getType().stripArray().isClock()
+             ? info.clocks : info.variables).push_back(symbol);
+        }
+    }
+    map<symbol_t, uint32_t> symbols;
+    for (auto& clock: info.clocks)
+    {
+        symbols.emplace(clock, symbols.size());
+    }
+    for (auto& var: info.variables)
+    {
+        symbols.emplace(var, symbols.size());
+    }
+
+    uint32_t size = symbols.size();
+    uint32_t locations = templ.states.size();
+    uint32_t nodes = locations + templ.branchpoints.size();
+    vector<bitset_t> live(nodes, bitset_t(size));
+    for (auto& state: templ.states)
+    {
+        bitset_t &uses = live[state.locNr];
+        addReads(state.invariant, symbols, uses);
+        addReads(state.exponentialRate, symbols, uses);
+        addReads(state.costRate, symbols, uses);
+    }
+
+    /* Composes the update backwards, then adds the guard and sync. */
+    vector<edgeinfo_t> edges;
+    vector<vector<uint32_t> > incoming(nodes);
+    for (auto& edge: templ.edges)
+    {
+        edgeinfo_t e;
+        e.src = edge.src ? edge.src->locNr : locations + edge.srcb->bpNr;
+        e.dst = edge.dst ? edge.dst->locNr : locations + edge.dstb->bpNr;
+        e.gen.resize(size);
+        e.kill.resize(size);
+        vector<expression_t> updates;
+        flatten(edge.assign, updates);
+        for (auto i = updates.rbegin(); i != updates.rend(); ++i)
+        {
+            expression_t expr = *i;
+            if (expr.getKind() == ASSIGN && expr[0].getKind() == IDENTIFIER)
+            {
+                auto target = symbols.find(expr[0].getSymbol());
+                if (target != symbols.end())
+                {
+                    e.gen[target->second] = false;
+                    e.kill[target->second] = true;
+                }
+                addReads(expr[1], symbols, e.gen);
+            }
+            else
+            {
+                addReads(expr, symbols, e.gen);
+            }
+        }
+        addReads(edge.guard, symbols, e.gen);
+        addReads(edge.sync, symbols, e.gen);
+        for (uint32_t s = 0; s < size; ++s)
+        {
+            if (e.gen[s])
+            {
+                live[e.src][s] = true;
+            }
+        }
+        incoming[e.dst].push_back(edges.size());
+        edges.push_back(e);
+    }
+
+    vector<uint32_t> queue;
+    vector<bool> queued(nodes, true);
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        queue.push_back(n);
+    }
+    while (!queue.empty())
+    {
+        uint32_t node = queue.back();
+        queue.pop_back();
+        queued[node] = false;
+        for (uint32_t i: incoming[node])
+        {
+            const edgeinfo_t &e = edges[i];
+            bool changed = false;
+            for (uint32_t s = 0; s < size; ++s)
+            {
+                if (live[node][s] && !e.kill[s] && !live[e.src][s])
+                {
+                    live[e.src][s] = true;
+                    changed = true;
+                }
+            }
+            if (changed && !queued[e.src])
+            {
+                queued[e.src] = true;
+                queue.push_back(e.src);
+            }
+        }
+    }
+
+    uint32_t clocks = info.clocks.size();
+    info.liveClocks.resize(locations);
+    info.liveVariables.resize(locations);
+    for (uint32_t l = 0; l < locations; ++l)
+    {
+        info.liveClocks[l].assign(live[l].begin(), live[l].begin() + clocks);
+        info.liveVariables[l].assign(live[l].begin() + clocks, live[l].end());
+    }
+}
+
+const Liveness::templinfo_t &Liveness::getInfo(const template_t &templ) const
+{
+    return templates[index.at(&templ)];
+}
+
+const vector<symbol_t> &Liveness::getClocks(const template_t &templ) const
+{
+    return getInfo(templ).clocks;
+}
+
+const vector<symbol_t> &Liveness::getVariables(const template_t &templ) const
+{
+    return getInfo(templ).variables;
+}
+
+const Liveness::bitset_t &Liveness::getLiveClocks(const template_t &templ,
+                                                  const state_t &location) const
+{
+    return getInfo(templ).liveClocks[location.locNr];
+}
+
+const Liveness::bitset_t &Liveness::getLiveVariables(const template_t &templ,
+                                                     const state_t &location) const
+{
+    return getInfo(templ).liveVariables[location.locNr];
+}
+
+bool Liveness::isLive(const template_t &templ, const state_t &location,
+                      symbol_t symbol) const
+{
+    const templinfo_t &info = getInfo(templ);
+    for (size_t i = 0; i < info.clocks.size(); ++i)
+    {
+        if (info.clocks[i] == symbol)
+        {
+            return info.liveClocks[location.locNr][i];
+        }
+    }
+    for (size_t i = 0; i < info.variables.size(); ++i)
+    {
+        if (info.variables[i] == symbol)
+        {
+            return info.liveVariables[location.locNr][i];
+        }
+    }
+    return true;
+}
+
+/* Lists the live clocks and variables of a location or "none". */
+string Liveness::describe(const templinfo_t &info, size_t location) const
+{
+    string names;
+    auto add = [&names](const vector<symbol_t> &symbols, const bitset_t &live) {
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            if (live[i])
+            {
+                names += names.empty() ? "" : ", ";
+                names += symbols[i].getName();
+            }
+        }
+    };
+    add(info.clocks, info.liveClocks[location]);
+    add(info.variables, info.liveVariables[location]);
+    return "live: " + (names.empty() ? string("none") : names);
+}
+
+map<string, string> Liveness::getAnnotations() const
+{
+    map<string, string> annotations;
+    for (auto& info: templates)
+    {
+        for (auto& state: info.templ->states)
+        {
+            annotations[info.templ->uid.getName() + "." + state.uid.getName()] =
+                describe(info, state.locNr);
+        }
+    }
+    return annotations;
+}
+
+void Liveness::print(ostream &os) const
+{
+    for (auto& info: templates)
+    {
+        os << "template " << info.templ->uid.getName() << "\n";
+        for (auto& state: info.templ->states)
+        {
+            os << "  location " << state.uid.getName() << ": "
+               << describe(info, state.locNr) << "\n";
+        }
+    }
+}
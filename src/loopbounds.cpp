@@ -0,0 +1,719 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/loopbounds.h"
+
+#include <algorithm>
+#include <map>
+#include <typeinfo>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::ostream;
+using std::set;
+using std::vector;
+
+namespace
+{
+    /**
+     * Returns true if \a stat may leave the loop it belongs to by a
+     * break or return statement, where \a nested tells whether it is
+     * inside an inner loop or switch.
+     */
+    bool mayLeave(Statement *stat, bool nested)
+    {
+        if (stat == nullptr)
+        {
+            return false;
+        }
+        if (dynamic_cast<ReturnStatement*>(stat))
+        {
+            return true;
+        }
+        if (dynamic_cast<BreakStatement*>(stat))
+        {
+            return !nested;
+        }
+        if (IfStatement *s = dynamic_cast<IfStatement*>(stat))
+        {
+            return mayLeave(s->trueCase, nested) || mayLeave(s->falseCase, nested);
+        }
+        if (ForStatement *s = dynamic_cast<ForStatement*>(stat))
+        {
+            return mayLeave(s->stat, true);
+        }
+        if (IterationStatement *s = dynamic_cast<IterationStatement*>(stat))
+        {
+            return mayLeave(s->stat, true);
+        }
+        if (WhileStatement *s = dynamic_cast<WhileStatement*>(stat))
+        {
+            return mayLeave(s->stat, true);
+        }
+        if (DoWhileStatement *s = dynamic_cast<DoWhileStatement*>(stat))
+        {
+            return mayLeave(s->stat, true);
+        }
+        if (BlockStatement *s = dynamic_cast<BlockStatement*>(stat))
+        {
+            bool inner = nested || dynamic_cast<SwitchStatement*>(stat);
+            return std::any_of(s->begin(), s->end(), [inner](Statement *sub) {
+                return mayLeave(sub, inner);
+            });
+        }
+        return false;
+    }
+
+    /** Returns true if \a expr calls a function. */
+    bool hasCall(expression_t expr)
+    {
+        if (expr.empty())
+        {
+            return false;
+        }
+        if (expr.getKind() == FUNCALL)
+        {
+            return true;
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+        {
+            if (hasCall(expr[i]))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Finds calls of functions in the statements visited. */
+    class CallFinder : public ExpressionVisitor
+    {
+    protected:
+        void visitExpression(expression_t expr) override
+        {
+            found = found || hasCall(expr);
+        }
+    public:
+        bool found;
+
+        CallFinder() : found(false) {}
+    };
+
+    /** Collects all loops of a function body. */
+    class LoopCollector : public AbstractStatementVisitor
+    {
+    private:
+        function_t &fun;
+        vector<loop_t> &loops;
+
+        void add(Statement *stat, Statement *body)
+        {
+            loop_t loop;
+            loop.function = &fun;
+            loop.statement = stat;
+            loop.leaves = mayLeave(body, false);
+            loop.bounded = false;
+            loop.exact = false;
+            loop.iterations = 0;
+            loop.last = 0;
+            loops.push_back(loop);
+        }
+    public:
+        LoopCollector(function_t &fun, vector<loop_t> &loops)
+            : fun(fun), loops(loops) {}
+
+        int32_t visitForStatement(ForStatement *stat) override
+        {
+            add(stat, stat->stat);
+            return stat->stat->accept(this);
+        }
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            add(stat, stat->stat);
+            return stat->stat->accept(this);
+        }
+        int32_t visitWhileStatement(WhileStatement *stat) override
+        {
+            add(stat, stat->stat);
+            return stat->stat->accept(this);
+        }
+        int32_t visitDoWhileStatement(DoWhileStatement *stat) override
+        {
+            add(stat, stat->stat);
+            return stat->stat->accept(this);
+        }
+        int32_t visitBlockStatement(BlockStatement *stat) override
+        {
+            for (auto s: *stat)
+            {
+                s->accept(this);
+            }
+            return 0;
+        }
+        int32_t visitSwitchStatement(SwitchStatement *stat) override
+        {
+            return visitBlockStatement(stat);
+        }
+        int32_t visitCaseStatement(CaseStatement *stat) override
+        {
+            return visitBlockStatement(stat);
+        }
+        int32_t visitDefaultStatement(DefaultStatement *stat) override
+        {
+            return visitBlockStatement(stat);
+        }
+        int32_t visitIfStatement(IfStatement *stat) override
+        {
+            stat->trueCase->accept(this);
+            if (stat->falseCase)
+            {
+                stat->falseCase->accept(this);
+            }
+            return 0;
+        }
+    };
+
+    /**
+     * Computes the value of \a var after executing \a step. Returns
+     * false if it is unknown or overflows.
+     */
+    bool next(const ConstantEvaluator &evaluator, expression_t step,
+              symbol_t var, int32_t value, int32_t &result)
+    {
+        if (step.getSize() == 0 || step[0].getKind() != IDENTIFIER
+            || step[0].getSymbol() != var)
+        {
+            return false;
+        }
+        int32_t delta;
+        switch (step.getKind())
+        {
+        case POSTINCREMENT:
+        case PREINCREMENT:
+            return !__builtin_add_overflow(value, 1, &result);
+        case POSTDECREMENT:
+        case PREDECREMENT:
+            return !__builtin_sub_overflow(value, 1, &result);
+        case ASSIGN:
+            return evaluator.evaluate(step[1], result);
+        case ASSPLUS:
+        case ASSMINUS:
+        case ASSMULT:
+            if (!evaluator.evaluate(step[1], delta))
+            {
+                return false;
+            }
+            return step.getKind() == ASSPLUS
+                ? !__builtin_add_overflow(value, delta, &result)
+                : step.getKind() == ASSMINUS
+                ? !__builtin_sub_overflow(value, delta, &result)
+                : !__builtin_mul_overflow(value, delta, &result);
+        default:
+            return false;
+        }
+    }
+
+    /** Returns true if the statement can be copied by Cloner. */
+    bool isClonable(Statement *stat)
+    {
+        if (stat == nullptr
+            || dynamic_cast<EmptyStatement*>(stat)
+            || dynamic_cast<ExprStatement*>(stat)
+            || dynamic_cast<AssertStatement*>(stat)
+            || dynamic_cast<ReturnStatement*>(stat))
+        {
+            return true;
+        }
+        if (IfStatement *s = dynamic_cast<IfStatement*>(stat))
+        {
+            return isClonable(s->trueCase) && isClonable(s->falseCase);
+        }
+        BlockStatement *block = dynamic_cast<BlockStatement*>(stat);
+        if (block == nullptr || typeid(*block) != typeid(BlockStatement)
+            || block->getFrame().getSize() > 0)
+        {
+            return false;
+        }
+        return std::all_of(block->begin(), block->end(), isClonable);
+    }
+
+    /** Counts the statements of a clonable statement. */
+    size_t countStatements(Statement *stat)
+    {
+        if (stat == nullptr)
+        {
+            return 0;
+        }
+        if (IfStatement *s = dynamic_cast<IfStatement*>(stat))
+        {
+            return 1 + countStatements(s->trueCase) + countStatements(s->falseCase);
+        }
+        if (BlockStatement *s = dynamic_cast<BlockStatement*>(stat))
+        {
+            size_t count = 0;
+            for (auto sub: *s)
+            {
+                count += countStatements(sub);
+            }
+            return count;
+        }
+        return dynamic_cast<EmptyStatement*>(stat) ? 0 : 1;
+    }
+
+    /**
+     * Copies a clonable statement while replacing a symbol by a
+     * constant.
+     */
+    class Cloner
+    {
+    private:
+        symbol_t symbol;
+        expression_t value;
+
+        expression_t subst(expression_t expr) const
+        {
+            return expr.subst(symbol, value);
+        }
+    public:
+        Cloner(symbol_t symbol, int32_t value)
+            : symbol(symbol), value(expression_t::createConstant(value)) {}
+
+        Statement *clone(Statement *stat) const
+        {
+            if (stat == nullptr)
+            {
+                return nullptr;
+            }
+            if (ExprStatement *s = dynamic_cast<ExprStatement*>(stat))
+            {
+                return new ExprStatement(subst(s->expr));
+            }
+            if (AssertStatement *s = dynamic_cast<AssertStatement*>(stat))
+            {
+                return new AssertStatement(subst(s->expr));
+            }
+            if (ReturnStatement *s = dynamic_cast<ReturnStatement*>(stat))
+            {
+                return new ReturnStatement(subst(s->value));
+            }
+            if (IfStatement *s = dynamic_cast<IfStatement*>(stat))
+            {
+                return new IfStatement(subst(s->cond), clone(s->trueCase),
+                                       clone(s->falseCase));
+            }
+            if (BlockStatement *s = dynamic_cast<BlockStatement*>(stat))
+            {
+                BlockStatement *block = new BlockStatement(frame_t::createFrame());
+                for (auto sub: *s)
+                {
+                    block->push_stat(clone(sub));
+                }
+                return block;
+            }
+            return new EmptyStatement();
+        }
+    };
+
+    /** Replaces loops by their unrolled bodies, innermost first. */
+    class Unroller
+    {
+    private:
+        const map<const Statement*, const loop_t*> &loops;
+        size_t maxStatements;
+    public:
+        size_t count;
+        set<symbol_t> iterators; /**< Variables of unrolled range loops */
+
+        Unroller(const map<const Statement*, const loop_t*> &loops,
+                 size_t maxStatements)
+            : loops(loops), maxStatements(maxStatements), count(0) {}
+
+        void transform(Statement *&stat)
+        {
+            if (stat == nullptr)
+            {
+                return;
+            }
+            if (BlockStatement *s = dynamic_cast<BlockStatement*>(stat))
+            {
+                for (auto i = s->begin(); i != s->end(); ++i)
+                {
+                    transform(*i);
+                }
+                return;
+            }
+            if (IfStatement *s = dynamic_cast<IfStatement*>(stat))
+            {
+                transform(s->trueCase);
+                transform(s->falseCase);
+                return;
+            }
+            Statement **body = nullptr;
+            if (ForStatement *s = dynamic_cast<ForStatement*>(stat))
+            {
+                body = &s->stat;
+            }
+            else if (IterationStatement *s = dynamic_cast<IterationStatement*>(stat))
+            {
+                body = &s->stat;
+            }
+            else if (WhileStatement *s = dynamic_cast<WhileStatement*>(stat))
+            {
+                body = &s->stat;
+            }
+            else if (DoWhileStatement *s = dynamic_cast<DoWhileStatement*>(stat))
+            {
+                body = &s->stat;
+            }
+            if (body == nullptr)
+            {
+                return;
+            }
+            transform(*body);
+
+            auto i = loops.find(stat);
+            if (i == loops.end())
+            {
+                return;
+            }
+            const loop_t &loop = *i->second;
+            if (!loop.exact || loop.variable == symbol_t()
+                || loop.variable.getType().isScalar() || !isClonable(*body))
+            {
+                return;
+            }
+
+            /* Functions called by the body may read the variable of a
+             * for loop, thus it is assigned before every copy.
+             */
+            bool assigned = dynamic_cast<ForStatement*>(stat) != nullptr;
+            CallFinder finder;
+            (*body)->accept(&finder);
+            size_t size = countStatements(*body) + (assigned && finder.found);
+            if (size * loop.values.size() > maxStatements)
+            {
+                return;
+            }
+            auto assign = [&loop](int32_t value) {
+                return new ExprStatement(
+                    expression_t::createBinary(
+                        ASSIGN,
+                        expression_t::createIdentifier(loop.variable),
+                        expression_t::createConstant(value),
+                        position_t(), loop.variable.getType()));
+            };
+
+            BlockStatement *block = new BlockStatement(frame_t::createFrame());
+            for (auto value: loop.values)
+            {
+                if (assigned && finder.found)
+                {
+                    block->push_stat(assign(value));
+                }
+                block->push_stat(Cloner(loop.variable, value).clone(*body));
+            }
+            if (assigned)
+            {
+                block->push_stat(assign(loop.last));
+            }
+            else if (dynamic_cast<IterationStatement*>(stat))
+            {
+                iterators.insert(loop.variable);
+            }
+            /* Loop statements do not own their bodies. */
+            delete *body;
+            delete stat;
+            stat = block;
+            ++count;
+        }
+    };
+}
+
+LoopBounds::LoopBounds(TimedAutomataSystem &system, uint32_t limit)
+    : system(system), evaluator(system), limit(limit)
+{
+    vector<instance_t*> none;
+    for (auto& fun: system.getGlobals().functions)
+    {
+        analyse(fun, none);
+    }
+    for (auto& templ: system.getTemplates())
+    {
+        vector<instance_t*> processes;
+        for (auto& process: system.getProcesses())
+        {
+            if (process.templ == &templ)
+            {
+                processes.push_back(&process);
+            }
+        }
+        for (auto& fun: templ.functions)
+        {
+            analyse(fun, processes);
+        }
+    }
+}
+
+const vector<loop_t> &LoopBounds::getLoops() const
+{
+    return loops;
+}
+
+const loop_t *LoopBounds::getLoop(const Statement *stat) const
+{
+    for (auto& loop: loops)
+    {
+        if (loop.statement == stat)
+        {
+            return &loop;
+        }
+    }
+    return nullptr;
+}
+
+void LoopBounds::analyse(function_t &fun, const vector<instance_t*> &processes)
+{
+    if (fun.body == nullptr)
+    {
+        return;
+    }
+    size_t first = loops.size();
+    LoopCollector collector(fun, loops);
+    fun.body->accept(&collector);
+
+    /* Constant local variables are known if their initialiser is.
+     */
+    vector<symbol_t> locals;
+    for (auto& variable: fun.variables)
+    {
+        type_t type = variable.uid.getType();
+        int32_t value;
+        if (type.isConstant() && type.isIntegral()
+            && evaluator.evaluate(variable.expr, value))
+        {
+            evaluator.bind(variable.uid, value);
+            locals.push_back(variable.uid);
+        }
+    }
+
+    for (size_t i = first; i < loops.size(); ++i)
+    {
+        loop_t &loop = loops[i];
+        if (computeBound(loop))
+        {
+            loop.bounded = loop.exact = true;
+            continue;
+        }
+
+        /* The bound may depend on template parameters, thus bound it
+         * for every process.
+         */
+        uint32_t iterations = 0;
+        bool bounded = !processes.empty();
+        for (auto process: processes)
+        {
+            evaluator.bind(*process);
+            bounded &= computeBound(loop);
+            iterations = std::max(iterations, loop.iterations);
+            for (auto& arg: process->mapping)
+            {
+                evaluator.unbind(arg.first);
+            }
+        }
+        loop.bounded = bounded;
+        loop.iterations = bounded ? iterations : 0;
+        loop.values.clear();
+    }
+
+    for (auto& local: locals)
+    {
+        evaluator.unbind(local);
+    }
+}
+
+bool LoopBounds::computeBound(loop_t &loop)
+{
+    loop.values.clear();
+    loop.iterations = 0;
+
+    if (IterationStatement *stat = dynamic_cast<IterationStatement*>(loop.statement))
+    {
+        int32_t lower, upper;
+        loop.variable = stat->symbol;
+        if (!evaluator.evaluateRange(stat->symbol.getType(), lower, upper)
+            || (int64_t)upper - lower + 1 > limit)
+        {
+            return false;
+        }
+        for (int32_t value = lower; value <= upper; ++value)
+        {
+            loop.values.push_back(value);
+        }
+        loop.iterations = loop.values.size();
+        loop.last = upper;
+        return true;
+    }
+
+    ForStatement *stat = dynamic_cast<ForStatement*>(loop.statement);
+    if (stat == nullptr || stat->init.getKind() != ASSIGN
+        || stat->init[0].getKind() != IDENTIFIER || stat->cond.empty())
+    {
+        return false;
+    }
+    symbol_t var = stat->init[0].getSymbol();
+    loop.variable = var;
+
+    /* The step only changes the loop variable, and the body changes
+     * neither the variable nor what the condition and the step
+     * depend on.
+     */
+    set<symbol_t> writes, reads, changes;
+    stat->step.collectPossibleWrites(writes);
+    stat->init.collectPossibleWrites(writes);
+    writes.erase(var);
+    if (!writes.empty())
+    {
+        return false;
+    }
+    CollectChangesVisitor visitor(changes);
+    stat->stat->accept(&visitor);
+    stat->cond.collectPossibleReads(reads);
+    stat->step.collectPossibleReads(reads);
+    reads.insert(var);
+    for (auto& symbol: reads)
+    {
+        if (changes.find(symbol) != changes.end())
+        {
+            return false;
+        }
+    }
+
+    /* Run the loop.
+     */
+    int32_t value, cond;
+    bool result = false;
+    if (evaluator.evaluate(stat->init[1], value))
+    {
+        while (true)
+        {
+            evaluator.bind(var, value);
+            if (!evaluator.evaluate(stat->cond, cond))
+            {
+                break;
+            }
+            if (!cond)
+            {
+                loop.iterations = loop.values.size();
+                loop.last = value;
+                result = true;
+                break;
+            }
+            if (loop.values.size() >= limit)
+            {
+                break;
+            }
+            loop.values.push_back(value);
+            if (!next(evaluator, stat->step, var, value, value))
+            {
+                break;
+            }
+        }
+    }
+    evaluator.unbind(var);
+    if (!result)
+    {
+        loop.values.clear();
+    }
+    return result;
+}
+
+size_t LoopBounds::unroll(size_t maxStatements)
+{
+    map<const Statement*, const loop_t*> index;
+    for (auto& loop: loops)
+    {
+        index[loop.statement] = &loop;
+    }
+    Unroller unroller(index, maxStatements);
+    auto transform = [&](declarations_t &declarations) {
+        for (auto& fun: declarations.functions)
+        {
+            if (fun.body)
+            {
+                for (auto i = fun.body->begin(); i != fun.body->end(); ++i)
+                {
+                    unroller.transform(*i);
+                }
+            }
+            /* The variables of unrolled range loops are gone. */
+            fun.variables.remove_if([&](const variable_t &variable) {
+                return unroller.iterators.count(variable.uid) > 0;
+            });
+        }
+    };
+    transform(system.getGlobals());
+    for (auto& templ: system.getTemplates())
+    {
+        transform(templ);
+    }
+    loops.clear();
+    return unroller.count;
+}
+
+void LoopBounds::print(ostream &os) const
+{
+    for (auto& loop: loops)
+    {
+        const Statement *stat = loop.statement;
+        os << loop.function->uid.getName() << ": ";
+        if (dynamic_cast<const ForStatement*>(stat))
+        {
+            os << "for";
+        }
+        else if (dynamic_cast<const IterationStatement*>(stat))
+        {
+            os << "for (:)";
+        }
+        else if (dynamic_cast<const WhileStatement*>(stat))
+        {
+            os << "while";
+        }
+        else
+        {
+            os << "do-while";
+        }
+        if (loop.variable != symbol_t())
+        {
+            os << " over " << loop.variable.getName();
+        }
+        if (!loop.bounded)
+        {
+            os << " is unbounded\n";
+        }
+        else
+        {
+            os << (loop.exact && !loop.leaves ? " iterates " : " iterates at most ")
+               << loop.iterations << " time(s)\n";
+        }
+    }
+}
@@ -0,0 +1,426 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/metrics.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::map;
+using std::ostream;
+using std::vector;
+
+/* Returns the number of bits needed to distinguish \a width values. */
+static uint64_t bitsOf(uint64_t width)
+{
+    uint64_t bits = 0;
+    while (bits < 64 && (uint64_t(1) << bits) < width)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+/*
+ * Adds the clocks \a expr refers to, if not already in \a clocks. Calls
+ * of functions are not followed.
+ */
+static void getClocks(expression_t expr, vector<symbol_t> &clocks)
+{
+    if (expr.empty() || expr.getKind() == FUNCALL)
+    {
+        return;
+    }
+    symbol_t clock = ClockBounds::clockOf(expr);
+    if (clock != symbol_t())
+    {
+        if (std::find(clocks.begin(), clocks.end(), clock) == clocks.end())
+        {
+            clocks.push_back(clock);
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < expr.getSize(); ++i)
+    {
+        getClocks(expr[i], clocks);
+    }
+}
+
+Metrics::Metrics(TimedAutomataSystem &system):
+    system(system), evaluator(system), clockBounds(system)
+{
+    globals = metrics_t();
+    globals.known = true;
+    for (auto& var: system.getGlobals().variables)
+    {
+        if (!system.isReferenceClock(var.uid))
+        {
+            addVariable(globals, var.uid);
+        }
+    }
+
+    /* The constraints are collected once per template. */
+    map<const template_t*, vector<constraint_t> > constraints;
+    for (auto& templ: system.getTemplates())
+    {
+        if (!templ.isTA)
+        {
+            continue;
+        }
+        vector<constraint_t> &tconstraints = constraints[&templ];
+        for (auto& state: templ.states)
+        {
+            collect(state.invariant, tconstraints);
+        }
+        for (auto& edge: templ.edges)
+        {
+            collect(edge.guard, tconstraints);
+        }
+        templates.push_back(analyse(templ, tconstraints));
+    }
+
+    total = globals;
+    total.vars.clear();
+    map<symbol_t, size_t> globalClocks; // index in globals.clockUses
+    for (auto& var: system.getGlobals().variables)
+    {
+        if (var.uid.getType().stripArray().isClock()
+            && !system.isReferenceClock(var.uid))
+        {
+            globalClocks[var.uid] = globals.clockUses.size();
+            globals.clockUses.push_back({ var.uid, 0, true, -1 });
+        }
+    }
+    for (auto& process: system.getProcesses())
+    {
+        if (!process.templ->isTA)
+        {
+            continue;
+        }
+        evaluator.bind(process);
+        processes.push_back(analyse(process, constraints[process.templ]));
+        evaluator.clear();
+
+        const metrics_t &metrics = processes.back();
+        total.locations += metrics.locations;
+        total.edges += metrics.edges;
+        total.clocks += metrics.clocks;
+        total.variables += metrics.variables;
+        total.clockConstraints += metrics.clockConstraints;
+        total.known = total.known && metrics.known;
+        total.stateBits += metrics.stateBits;
+
+        /* Gather the uses of global clocks, also through parameters. */
+        for (auto& use: metrics.clockUses)
+        {
+            symbol_t clock = use.uid;
+            auto arg = process.mapping.find(clock);
+            if (arg != process.mapping.end())
+            {
+                clock = ClockBounds::clockOf(arg->second);
+            }
+            auto i = globalClocks.find(clock);
+            if (i == globalClocks.end())
+            {
+                continue; // a local clock
+            }
+            clockmetrics_t &global = globals.clockUses[i->second];
+            global.constraints += use.constraints;
+            global.bounded = global.bounded && use.bounded;
+            global.maxConstant = std::max(global.maxConstant, use.maxConstant);
+        }
+    }
+}
+
+/**
+ * Collects the clock constraints of a guard or an invariant. Calls of
+ * functions are not followed.
+ */
+void Metrics::collect(expression_t expr,
+                      vector<constraint_t> &constraints) const
+{
+    if (expr.empty() || expr.getKind() == FUNCALL)
+    {
+        return;
+    }
+    switch (expr.getKind())
+    {
+    case LT: case LE: case EQ: case NEQ: case GE: case GT:
+    {
+        constraint_t constraint;
+        getClocks(expr[0], constraint.clocks);
+        getClocks(expr[1], constraint.clocks);
+        if (!constraint.clocks.empty())
+        {
+            constraints.push_back(constraint);
+            return;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    for (uint32_t i = 0; i < expr.getSize(); ++i)
+    {
+        collect(expr[i], constraints);
+    }
+}
+
+/**
+ * Computes the elements, width and bits of a value of \a type. Returns
+ * false if some size or range could not be evaluated.
+ */
+bool Metrics::measure(type_t type, varmetrics_t &var) const
+{
+    var.elements = 0;
+    var.width = 0;
+    var.bits = 0;
+    if (type.isArray())
+    {
+        int32_t lower, upper;
+        varmetrics_t element;
+        if (!evaluator.evaluateRange(type.getArraySize(), lower, upper)
+            || !measure(type.getSub(), element))
+        {
+            return false;
+        }
+        uint32_t size = upper >= lower ? upper - lower + 1 : 0;
+        var.elements = size * element.elements;
+        var.width = element.width;
+        var.bits = size * element.bits;
+        return true;
+    }
+    if (type.isRecord())
+    {
+        bool known = true;
+        for (size_t i = 0; i < type.getRecordSize(); ++i)
+        {
+            varmetrics_t field;
+            known = measure(type.getSub(i), field) && known;
+            var.elements += field.elements;
+            var.width = std::max(var.width, field.width);
+            var.bits += field.bits;
+        }
+        return known;
+    }
+    if (type.isBoolean())
+    {
+        var.elements = 1;
+        var.width = 2;
+        var.bits = 1;
+        return true;
+    }
+    if (type.isInteger() || type.isScalar())
+    {
+        int32_t lower, upper;
+        var.elements = 1;
+        if (!type.is(RANGE))
+        {
+            var.width = uint64_t(1) << 32;
+        }
+        else if (evaluator.evaluateRange(type, lower, upper))
+        {
+            var.width = upper >= lower ? int64_t(upper) - lower + 1 : 0;
+        }
+        else
+        {
+            return false;
+        }
+        var.bits = bitsOf(var.width);
+        return true;
+    }
+    if (type.isClock())
+    {
+        var.elements = 1;
+    }
+    return true;
+}
+
+/** Adds a variable or clock declaration to \a metrics. */
+void Metrics::addVariable(metrics_t &metrics, symbol_t symbol) const
+{
+    type_t type = symbol.getType();
+    type_t base = type.stripArray();
+    if (type.is(REF) || type.isConstant()
+        || !(base.isIntegral() || base.isScalar() || base.isRecord()
+             || base.isClock()))
+    {
+        return;
+    }
+
+    varmetrics_t var;
+    var.uid = symbol;
+    var.known = measure(type, var);
+    metrics.known = metrics.known && var.known;
+    if (base.isClock())
+    {
+        metrics.clocks += var.elements;
+        return;
+    }
+    metrics.variables += var.elements;
+    metrics.stateBits += var.bits;
+    metrics.vars.push_back(var);
+}
+
+/**
+ * Counts the clock constraints of \a metrics and takes the maximal
+ * constants from the clock bounds. Those of a template are the ones of
+ * its processes.
+ */
+void Metrics::addBounds(metrics_t &metrics,
+                        const vector<constraint_t> &constraints) const
+{
+    map<symbol_t, size_t> index;
+    for (auto& constraint: constraints)
+    {
+        for (auto& clock: constraint.clocks)
+        {
+            auto i = index.emplace(clock, metrics.clockUses.size());
+            if (i.second)
+            {
+                metrics.clockUses.push_back({ clock, 0, true, -1 });
+            }
+            metrics.clockUses[i.first->second].constraints++;
+        }
+    }
+    metrics.clockConstraints += constraints.size();
+
+    for (uint32_t p = 0; p < clockBounds.getProcessCount(); ++p)
+    {
+        const instance_t &process = clockBounds.getProcess(p);
+        if (&process != metrics.instance && process.templ != metrics.instance)
+        {
+            continue;
+        }
+        for (auto& use: metrics.clockUses)
+        {
+            uint32_t clock = clockBounds.findClock(p, use.uid);
+            if (clock == ClockBounds::noClock)
+            {
+                continue;
+            }
+            int32_t value = clockBounds.getBounds(p, clock).max();
+            if (value == ClockBounds::unknown)
+            {
+                use.bounded = false;
+            }
+            else
+            {
+                use.maxConstant = std::max(use.maxConstant, value);
+            }
+        }
+    }
+}
+
+/** Computes the metrics of a template or a process of it. */
+metrics_t Metrics::analyse(const instance_t &instance,
+                           const vector<constraint_t> &constraints) const
+{
+    const template_t &templ = *instance.templ;
+    metrics_t metrics = metrics_t();
+    metrics.instance = &instance;
+    metrics.locations = templ.states.size();
+    metrics.edges = templ.edges.size();
+    metrics.known = true;
+    metrics.stateBits = bitsOf(metrics.locations);
+    for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+    {
+        addVariable(metrics, templ.parameters[i]);
+    }
+    for (auto& var: templ.variables)
+    {
+        addVariable(metrics, var.uid);
+    }
+    addBounds(metrics, constraints);
+    return metrics;
+}
+
+/* Prints the summary line of \a metrics. */
+static void printCounts(ostream &os, const metrics_t &metrics, bool automata)
+{
+    if (automata)
+    {
+        os << "locations " << metrics.locations
+           << ", edges " << metrics.edges << ", ";
+    }
+    os << "clocks " << metrics.clocks
+       << ", variables " << metrics.variables
+       << ", clock constraints " << metrics.clockConstraints
+       << ", state bits " << metrics.stateBits
+       << (metrics.known ? "" : "+") << "\n";
+}
+
+/* Prints the variables and clock uses of \a metrics. */
+static void printDetails(ostream &os, const metrics_t &metrics)
+{
+    for (auto& var: metrics.vars)
+    {
+        os << "  variable " << var.uid.getName() << ": ";
+        if (var.known)
+        {
+            os << "elements " << var.elements << ", width " << var.width
+               << ", bits " << var.bits << "\n";
+        }
+        else
+        {
+            os << "size unknown\n";
+        }
+    }
+    for (auto& use: metrics.clockUses)
+    {
+        os << "  clock " << use.uid.getName()
+           << ": constraints " << use.constraints;
+        if (!use.bounded)
+        {
+            os << ", max constant unknown";
+        }
+        else if (use.constraints > 0)
+        {
+            os << ", max constant " << use.maxConstant;
+        }
+        os << "\n";
+    }
+}
+
+void Metrics::print(ostream &os) const
+{
+    os << "global: ";
+    printCounts(os, globals, false);
+    printDetails(os, globals);
+    for (auto& metrics: templates)
+    {
+        os << "template " << metrics.instance->uid.getName() << ": ";
+        printCounts(os, metrics, true);
+        printDetails(os, metrics);
+    }
+    for (auto& metrics: processes)
+    {
+        os << "process " << metrics.instance->uid.getName() << " of "
+           << metrics.instance->templ->uid.getName() << ": ";
+        printCounts(os, metrics, true);
+        printDetails(os, metrics);
+    }
+    os << "total: processes " << processes.size() << ", ";
+    printCounts(os, total, true);
+}
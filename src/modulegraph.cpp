@@ -0,0 +1,374 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/modulegraph.h"
+
+#include <algorithm>
+#include <utility>
+
+using std::ostream;
+using std::pair;
+using std::string;
+using std::vector;
+
+using namespace UTAP;
+
+ModuleGraph::ModuleGraph(const FlowGraph &graph):
+    graph(graph), channelBase(graph.getProcessCount()),
+    variableBase(channelBase + graph.getChannelCount())
+{
+    buildEdges();
+    numberComponents(findComponents(), findSubsystems());
+}
+
+void ModuleGraph::buildEdges()
+{
+    uint32_t nodes = variableBase + graph.getVariableCount();
+    edges.offsets.assign(1, 0);
+    for (uint32_t p = 0; p < channelBase; ++p)
+    {
+        for (uint32_t c: graph.getTargets(FlowGraph::SEND, p))
+        {
+            edges.ids.push_back(channelBase + c);
+        }
+        for (uint32_t v: graph.getTargets(FlowGraph::WRITE, p))
+        {
+            edges.ids.push_back(variableBase + v);
+        }
+        edges.offsets.push_back(edges.ids.size());
+    }
+    for (uint32_t n = channelBase; n < nodes; ++n)
+    {
+        FlowGraph::range_t readers = n < variableBase
+            ? graph.getSources(FlowGraph::RECEIVE, n - channelBase)
+            : graph.getSources(FlowGraph::READ, n - variableBase);
+        edges.ids.insert(edges.ids.end(), readers.begin(), readers.end());
+        edges.offsets.push_back(edges.ids.size());
+    }
+}
+
+/**
+ * Tarjan's algorithm with an explicit stack, since chains of processes
+ * may be long. Returns the component of every node, where components
+ * are completed after all components reachable from them.
+ */
+vector<uint32_t> ModuleGraph::findComponents() const
+{
+    size_t nodes = edges.offsets.size() - 1;
+    vector<uint32_t> index(nodes, FlowGraph::none), lowlink(nodes);
+    vector<uint32_t> component(nodes, FlowGraph::none);
+    vector<uint32_t> stack;
+    vector<pair<uint32_t, uint32_t> > calls; // node and its next edge
+    uint32_t next = 0, count = 0;
+
+    for (uint32_t root = 0; root < nodes; ++root)
+    {
+        if (index[root] != FlowGraph::none)
+        {
+            continue;
+        }
+        index[root] = lowlink[root] = next++;
+        stack.push_back(root);
+        calls.emplace_back(root, edges.offsets[root]);
+        while (!calls.empty())
+        {
+            uint32_t node = calls.back().first;
+            uint32_t edge = calls.back().second;
+            if (edge < edges.offsets[node + 1])
+            {
+                calls.back().second++;
+                uint32_t succ = edges.ids[edge];
+                if (index[succ] == FlowGraph::none)
+                {
+                    index[succ] = lowlink[succ] = next++;
+                    stack.push_back(succ);
+                    calls.emplace_back(succ, edges.offsets[succ]);
+                }
+                else if (component[succ] == FlowGraph::none)
+                {   // still on the stack
+                    lowlink[node] = std::min(lowlink[node], index[succ]);
+                }
+                continue;
+            }
+            if (lowlink[node] == index[node])
+            {
+                uint32_t member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    component[member] = count;
+                } while (member != node);
+                ++count;
+            }
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                uint32_t caller = calls.back().first;
+                lowlink[caller] = std::min(lowlink[caller], lowlink[node]);
+            }
+        }
+    }
+    return component;
+}
+
+/**
+ * Returns the weakly connected component of every node, numbered in
+ * the order of their first process.
+ */
+vector<uint32_t> ModuleGraph::findSubsystems() const
+{
+    size_t nodes = edges.offsets.size() - 1;
+    vector<uint32_t> parent(nodes);
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        parent[n] = n;
+    }
+    auto find = [&parent](uint32_t n) {
+        while (parent[n] != n)
+        {
+            n = parent[n] = parent[parent[n]];
+        }
+        return n;
+    };
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        for (uint32_t i = edges.offsets[n]; i < edges.offsets[n + 1]; ++i)
+        {
+            uint32_t a = find(n), b = find(edges.ids[i]);
+            parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    /* Roots are the smallest nodes, hence processes come first. */
+    vector<uint32_t> subsystem(nodes, FlowGraph::none);
+    uint32_t count = 0;
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        uint32_t root = find(n);
+        if (subsystem[root] == FlowGraph::none)
+        {
+            subsystem[root] = count++;
+        }
+        subsystem[n] = subsystem[root];
+    }
+    return subsystem;
+}
+
+/**
+ * Renumbers the components found by Tarjan's algorithm by subsystem
+ * and topologically within it and fills the members and successors.
+ */
+void ModuleGraph::numberComponents(const vector<uint32_t> &tarjan,
+                                   const vector<uint32_t> &subsystem)
+{
+    size_t nodes = tarjan.size();
+    uint32_t count = 0;
+    for (uint32_t c: tarjan)
+    {
+        count = std::max(count, c + 1);
+    }
+    vector<uint32_t> subsystemOf(count);
+    for (size_t n = 0; n < nodes; ++n)
+    {
+        subsystemOf[tarjan[n]] = subsystem[n];
+    }
+
+    /* Tarjan completes the components in reverse topological order. */
+    vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        order[i] = count - 1 - i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&subsystemOf](uint32_t a, uint32_t b) {
+                         return subsystemOf[a] < subsystemOf[b];
+                     });
+    vector<uint32_t> rename(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rename[order[i]] = i;
+        if (i == 0 || subsystemOf[order[i]] != subsystemOf[order[i - 1]])
+        {
+            subsystems.push_back(i);
+        }
+    }
+    subsystems.push_back(count);
+
+    components.resize(nodes);
+    for (size_t n = 0; n < nodes; ++n)
+    {
+        components[n] = rename[tarjan[n]];
+    }
+
+    /* Members by counting sort, keeping them in increasing order. */
+    auto members = [this, count](csr_t &csr, uint32_t first, uint32_t last) {
+        csr.offsets.assign(count + 1, 0);
+        for (uint32_t n = first; n < last; ++n)
+        {
+            csr.offsets[components[n] + 1]++;
+        }
+        for (uint32_t c = 0; c < count; ++c)
+        {
+            csr.offsets[c + 1] += csr.offsets[c];
+        }
+        csr.ids.resize(last - first);
+        vector<uint32_t> next(csr.offsets.begin(), csr.offsets.end() - 1);
+        for (uint32_t n = first; n < last; ++n)
+        {
+            csr.ids[next[components[n]]++] = n - first;
+        }
+    };
+    members(processes, 0, channelBase);
+    members(channels, channelBase, variableBase);
+    members(variables, variableBase, nodes);
+
+    vector<pair<uint32_t, uint32_t> > links;
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        for (uint32_t i = edges.offsets[n]; i < edges.offsets[n + 1]; ++i)
+        {
+            uint32_t from = components[n], to = components[edges.ids[i]];
+            if (from != to)
+            {
+                links.emplace_back(from, to);
+            }
+        }
+    }
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+    successors.offsets.assign(count + 1, 0);
+    for (const pair<uint32_t, uint32_t> &link: links)
+    {
+        successors.offsets[link.first + 1]++;
+        successors.ids.push_back(link.second);
+    }
+    for (uint32_t c = 0; c < count; ++c)
+    {
+        successors.offsets[c + 1] += successors.offsets[c];
+    }
+}
+
+uint32_t ModuleGraph::getSubsystem(uint32_t component) const
+{
+    return std::upper_bound(subsystems.begin(), subsystems.end(), component)
+        - subsystems.begin() - 1;
+}
+
+/* Prints the modules of the processes related to target or "-" if none. */
+void ModuleGraph::printConnector(ostream &os, const char *kind,
+                                 const string &name,
+                                 FlowGraph::relation_t in,
+                                 FlowGraph::relation_t out, uint32_t target,
+                                 const vector<uint32_t> &moduleIds) const
+{
+    auto print = [&](FlowGraph::relation_t relation) {
+        vector<uint32_t> modules;
+        for (uint32_t p: graph.getSources(relation, target))
+        {
+            modules.push_back(moduleIds[components[p]]);
+        }
+        std::sort(modules.begin(), modules.end());
+        modules.erase(std::unique(modules.begin(), modules.end()),
+                      modules.end());
+        const char *infix = "";
+        for (uint32_t m: modules)
+        {
+            os << infix << m;
+            infix = ", ";
+        }
+        if (modules.empty())
+        {
+            os << "-";
+        }
+    };
+    os << "  " << kind << " " << name << ": ";
+    print(in);
+    os << " -> ";
+    print(out);
+    os << "\n";
+}
+
+void ModuleGraph::print(ostream &os, const char *title) const
+{
+    uint32_t count = getComponentCount(), modules = 0;
+    vector<uint32_t> moduleIds(count, FlowGraph::none);
+    for (uint32_t c = 0; c < count; ++c)
+    {
+        if (isModule(c))
+        {
+            moduleIds[c] = modules++;
+        }
+    }
+
+    typedef const string &(FlowGraph::*name_t)(uint32_t) const;
+    auto names = [this, &os](range_t ids, name_t name) {
+        const char *infix = "";
+        for (uint32_t id: ids)
+        {
+            os << infix << (graph.*name)(id);
+            infix = ", ";
+        }
+    };
+
+    os << "// " << title << ": " << getSubsystemCount() << " subsystem"
+       << (getSubsystemCount() == 1 ? "" : "s") << ", " << modules
+       << " module" << (modules == 1 ? "" : "s") << "\n";
+    for (uint32_t s = 0; s < getSubsystemCount(); ++s)
+    {
+        os << "subsystem " << s << "\n";
+        for (uint32_t c = subsystems[s]; c < subsystems[s + 1]; ++c)
+        {
+            if (isModule(c))
+            {
+                os << "  module " << moduleIds[c] << ": ";
+                names(getProcesses(c), &FlowGraph::getProcessName);
+                os << "\n";
+                if (!getChannels(c).empty())
+                {
+                    os << "    channels: ";
+                    names(getChannels(c), &FlowGraph::getChannelName);
+                    os << "\n";
+                }
+                if (!getVariables(c).empty())
+                {
+                    os << "    variables: ";
+                    names(getVariables(c), &FlowGraph::getVariableName);
+                    os << "\n";
+                }
+            }
+            else if (!getChannels(c).empty())
+            {
+                uint32_t chan = *getChannels(c).begin();
+                printConnector(os, "channel", graph.getChannelName(chan),
+                               FlowGraph::SEND, FlowGraph::RECEIVE, chan,
+                               moduleIds);
+            }
+            else
+            {
+                uint32_t var = *getVariables(c).begin();
+                printConnector(os, "variable", graph.getVariableName(var),
+                               FlowGraph::WRITE, FlowGraph::READ, var,
+                               moduleIds);
+            }
+        }
+    }
+}
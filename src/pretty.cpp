@@ -21,17 +21,27 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <unistd.h>
 #include <string>
 #include <strings.h>
 
+#include "utap/callgraph.h"
+#include "utap/liveness.h"
+#include "utap/loopbounds.h"
 #include "utap/prettyprinter.h"
+#include "utap/slicer.h"
+#include "utap/typechecker.h"
+#include "utap/utap.h"
 
 using namespace std;
 using namespace UTAP::Constants;
 
 static bool newSyntax = (getenv("UPPAAL_OLD_SYNTAX") == NULL);
 
+/* The maximal number of statements of an unrolled loop. */
+static const size_t maxUnrolled = 64;
+
 /**
  * Test for pretty printer
  */
@@ -39,20 +49,134 @@ int main(int argc, char *argv[])
 {
     try
     {
-        std::string filename;
+        std::string filename, buffer;
+        bool live = false;
+        bool slice = false;
+        bool inlining = false;
+        bool unrolling = false;
+        int query = -1;
+        int c;
 
-        if (argc != 2)
+        while ((c = getopt(argc, argv, "ilq:su")) != -1)
         {
-            std::cerr << "Usage: " << argv[0] << " MODEL\n\n";
-            std::cerr << "where MODEL is a UPPAAL .xml, xta, or .ta file\n";
+            switch (c)
+            {
+            case 'i':
+                inlining = true;
+                break;
+            case 'l':
+                live = true;
+                break;
+            case 'q':
+                query = atoi(optarg);
+                break;
+            case 's':
+                slice = true;
+                break;
+            case 'u':
+                unrolling = true;
+                break;
+            default:
+                argc = 0;
+                break;
+            }
+        }
+
+        if (argc - optind != 1)
+        {
+            std::cerr << "Usage: " << argv[0] << " [-i] [-l] [-s] [-u] [-q N] MODEL\n\n";
+            std::cerr << "where MODEL is a UPPAAL .xml, xta, or .ta file,\n";
+            std::cerr << "-i inlines calls of small functions,\n";
+            std::cerr << "-l annotates locations with their live clocks and variables,\n";
+            std::cerr << "-s removes everything which cannot influence the queries,\n";
+            std::cerr << "-u unrolls loops with small constant bounds\n";
+            std::cerr << "and -q N removes everything which cannot influence query N\n";
             return 1;
         }
 
-        filename = argv[1];
+        filename = argv[optind];
+        bool xml =
+            strcasecmp(".xml", filename.c_str() + filename.length() - 4) == 0;
 
         UTAP::PrettyPrinter pretty(cout);
+        bool transform = unrolling || inlining || slice || query >= 0;
+
+        if (live || transform)
+        {
+            UTAP::TimedAutomataSystem system;
+            if (xml)
+            {
+                parseXMLFile(filename.c_str(), &system, newSyntax);
+            }
+            else
+            {
+                FILE *file = fopen(filename.c_str(), "r");
+                if (file == NULL)
+                {
+                    char msg[256];
+                    snprintf(msg, 255, "Error opening %s", filename.c_str());
+                    perror(msg);
+                    return 1;
+                }
+                parseXTA(file, &system, newSyntax);
+                fclose(file);
+            }
+            UTAP::TypeChecker checker(&system);
+            system.accept(checker);
+            if (system.hasErrors())
+            {
+                for (auto& error: system.getErrors())
+                {
+                    std::cerr << error << std::endl;
+                }
+                return 1;
+            }
+            if (unrolling)
+            {
+                UTAP::LoopBounds bounds(system);
+                std::cerr << "Unrolled " << bounds.unroll(maxUnrolled)
+                          << " loop(s).\n";
+            }
+            if (inlining)
+            {
+                UTAP::CallGraph graph(system);
+                graph.computeSummaries();
+                std::cerr << "Inlined " << graph.inlineCalls() << " call(s).\n";
+            }
+            if (slice || query >= 0)
+            {
+                UTAP::Slicer slicer(system);
+                if (query >= (int)system.getQueries().size())
+                {
+                    std::cerr << filename << " has no query " << query << std::endl;
+                    return 1;
+                }
+                if (query >= 0)
+                {
+                    slicer.sliceQuery(query);
+                }
+                else
+                {
+                    slicer.removeDeadCode();
+                }
+                slicer.printReport(std::cerr);
+            }
+            if (transform)
+            {
+                /* Print the transformed system from its XML. */
+                writeXMLBuffer(buffer, &system);
+            }
+            if (live)
+            {
+                pretty.setAnnotations(UTAP::Liveness(system).getAnnotations());
+            }
+        }
 
-        if (strcasecmp(".xml", filename.c_str() + filename.length() - 4) == 0)
+        if (!buffer.empty())
+        {
+            parseXMLBuffer(buffer.c_str(), &pretty, newSyntax);
+        }
+        else if (xml)
         {
             parseXMLFile(filename.c_str(), &pretty, newSyntax);
         }
@@ -59,6 +59,11 @@ PrettyPrinter::PrettyPrinter(ostream &stream)
     select = guard = sync = update = probability = -1;
 }
 
+void PrettyPrinter::setAnnotations(const std::map<string, string> &annotations)
+{
+    this->annotations = annotations;
+}
+
 void PrettyPrinter::addPosition(
     uint32_t position, uint32_t offset, uint32_t line, const std::string& path)
 {
@@ -507,6 +512,7 @@ void PrettyPrinter::procBegin(const char *id, const bool isTA,
              << "{" << endl;
     param.clear();
     templateset = "" ;
+    procName = id ? id : "";
 
     level += 1;
 }
@@ -546,6 +552,13 @@ void PrettyPrinter::procState(const char *id, bool hasInvariant, bool hasExpRate
     {
         *o.top() << " { ; " << expRate << "}";
     }
+
+    std::map<string, string>::const_iterator i =
+        annotations.find(procName + "." + id);
+    if (i != annotations.end())
+    {
+        *o.top() << " /* " << i->second << " */";
+    }
 }
 
 void PrettyPrinter::procBranchpoint(const char *id)
@@ -29,11 +29,17 @@
 #include <algorithm>
 #include <functional>
 #include <cassert>
+#include <atomic>
+#include <queue>
+#include <system_error>
+#include <thread>
+#include <tuple>
 
 using std::list;
 using std::deque;
 using std::map;
 using std::set;
+using std::vector;
 using std::ostream;
 using std::istream;
 using std::string;
@@ -41,15 +47,79 @@ using std::ostream_iterator;
 using std::cerr;
 using std::endl;
 using UTAP::DistanceCalculator;
+using UTAP::FlowGraph;
 using UTAP::SignalFlow;
 using UTAP::Partitioner;
 using UTAP::TimedAutomataSystem;
+using namespace UTAP;
 using namespace UTAP::Constants;
 
+static const char* noChan = "-";
 
-SignalFlow::SignalFlow(const char* _title, TimedAutomataSystem& tas):
-    verbosity(0), title(_title), cTA(NULL), cP(NULL), inp(false), out(false),
-    sync(false), paramsExpanded(false)
+namespace
+{
+    /**
+     * Extracts the I/O information of a single process into a graph of
+     * its own, so that processes can be visited concurrently.
+     */
+    class ProcessFlow: public UTAP::StatementVisitor
+    {
+        typedef SignalFlow::exprref_t exprref_t;
+
+        FlowGraph &graph; // the summary of the process
+        instance_t* cP; // current process in traversal
+        uint32_t cChan; // channel on current transition in traversal
+        string chanString;
+        bool inp, out, sync, paramsExpanded;// current expression state
+        std::stack<std::pair<bool, bool> > ioStack;// remember I/O state
+        std::stack<exprref_t> refparams; // parameter passed by reference
+        std::stack<exprref_t> valparams; // parameter passed by value
+
+        bool checkParams(const symbol_t &s);// maps parameter to global symbol
+        void addChan(const std::string &, FlowGraph::relation_t);
+        void addVar(const symbol_t &, FlowGraph::relation_t);
+        void visitExpression(const expression_t &);
+        void pushIO(){
+            ioStack.push(std::make_pair(inp, out));
+        }
+        void popIO() {
+            inp = ioStack.top().first;
+            out = ioStack.top().second;
+            ioStack.pop();
+        }
+
+    public:
+        ProcessFlow(FlowGraph &g):
+            graph(g), cP(NULL), cChan(FlowGraph::none), inp(false),
+            out(false), sync(false), paramsExpanded(false) {}
+
+        void visitProcess(instance_t &);
+
+/**
+ * System visitor pattern extracts read/write information from UCode.
+ * This is actually "const" visitor and should contain "const Statement *stat".
+ */
+        int32_t visitEmptyStatement(EmptyStatement *stat) override;
+        int32_t visitExprStatement(ExprStatement *stat) override;
+        int32_t visitForStatement(ForStatement *stat) override;
+        int32_t visitIterationStatement(IterationStatement *stat) override;
+        int32_t visitWhileStatement(WhileStatement *stat) override;
+        int32_t visitDoWhileStatement(DoWhileStatement *stat) override;
+        int32_t visitBlockStatement(BlockStatement *stat) override;
+        int32_t visitSwitchStatement(SwitchStatement *stat) override;
+        int32_t visitCaseStatement(CaseStatement *stat) override;
+        int32_t visitDefaultStatement(DefaultStatement *stat) override;
+        int32_t visitIfStatement(IfStatement *stat) override;
+        int32_t visitBreakStatement(BreakStatement *stat) override;
+        int32_t visitContinueStatement(ContinueStatement *stat) override;
+        int32_t visitReturnStatement(ReturnStatement *stat) override;
+        int32_t visitAssertStatement(UTAP::AssertStatement *stat) override;
+    };
+}
+
+SignalFlow::SignalFlow(const char* _title, TimedAutomataSystem& tas,
+                       unsigned threads):
+    verbosity(0), title(_title)
 {
 /*
  * Visit all processes in the system.
@@ -57,41 +127,91 @@ SignalFlow::SignalFlow(const char* _title, TimedAutomataSystem& tas):
  *        unfolding is intricate and is done outside UTAP.
  */
     list<instance_t> &ps(tas.getProcesses());
+    vector<instance_t*> procs;
     for (list<instance_t>::iterator it=ps.begin(), e=ps.end(); it!=e; ++it)
     {
-        visitProcess(*it);
+        procs.push_back(&*it);
     }
+
+    // every process is summarised separately, workers take the next one
+    vector<FlowGraph> flows(procs.size());
+    std::atomic<size_t> next(0);
+    auto work = [&procs, &flows, &next]() {
+        for (size_t i = next++; i < procs.size(); i = next++)
+        {
+            ProcessFlow(flows[i]).visitProcess(*procs[i]);
+        }
+    };
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    vector<std::thread> workers;
+    for (size_t t = 1; t < threads && t < procs.size(); ++t)
+    {
+        try {
+            workers.emplace_back(work);
+        } catch (std::system_error&) {
+            break; // the remaining threads do the work
+        }
+    }
+    work();
+    for (std::thread &w: workers)
+    {
+        w.join();
+    }
+
+    // merge in the system order to keep the process ids deterministic
+    for (const FlowGraph &flow: flows)
+    {
+        graph.merge(flow);
+    }
+    graph.build();
+}
+
+static void printChans(ostream &os, const FlowGraph &graph,
+                       FlowGraph::range_t chans, const char* sep)
+{
+    const char* infix = "";
+    for (uint32_t c: chans)
+    {
+        os << infix;
+        if (c == FlowGraph::none) os << noChan;
+        else os << graph.getChannelName(c);
+        infix = sep;
+    }
+}
+
+void SignalFlow::printLabels(ostream &os, FlowGraph::relation_t relation,
+                             const uint32_t* variable, const char* sep)
+{
+    printChans(os, graph, graph.getLabels(relation, variable), sep);
 }
 
 void SignalFlow::printForTron(ostream &os)
 {
-    for (procs_t::const_iterator p=procs.begin(), e=procs.end(); p!=e; ++p)
+    for (uint32_t p=0; p<graph.getProcessCount(); ++p)
     {
-        os << (*p)->name << ":\n  "; // automaton:
+        os << graph.getProcessName(p) << ":\n  "; // automaton:
         // input channels,
-        for_each((*p)->inChans.begin(), (*p)->inChans.end(),
-                 print<const char*>(os, " "));
+        printChans(os, graph, graph.getTargets(FlowGraph::RECEIVE, p), " ");
         os << ",\n  ";
         // output channels,
-        for_each((*p)->outChans.begin(), (*p)->outChans.end(),
-                 print<const char*>(os, " "));
+        printChans(os, graph, graph.getTargets(FlowGraph::SEND, p), " ");
         os << ",\n ";
-        str2strs_t::const_iterator v;
         // input variables(channels),
-        for (v = (*p)->rdVars.begin(); v != (*p)->rdVars.end(); ++v)
+        for (const uint32_t& v: graph.getTargets(FlowGraph::READ, p))
         {
-            os << " " << v->first << "(";
-            for_each(v->second.begin(), v->second.end(),
-                     print<const char*>(os, " "));
+            os << " " << graph.getVariableName(v) << "(";
+            printLabels(os, FlowGraph::READ, &v, " ");
             os << ")";
         }
         os << ",\n ";
         // output variables(channels);
-        for (v = (*p)->wtVars.begin(); v != (*p)->wtVars.end(); ++v)
+        for (const uint32_t& v: graph.getTargets(FlowGraph::WRITE, p))
         {
-            os << " " << v->first << "(";
-            for_each(v->second.begin(), v->second.end(),
-                     print<const char*>(os, " "));
+            os << " " << graph.getVariableName(v) << "(";
+            printLabels(os, FlowGraph::WRITE, &v, " ");
             os << ")";
         }
         os << "\n;\n";
@@ -112,8 +232,8 @@ void SignalFlow::printProcsForDot(ostream &os, bool erd)
     }
     os << "    ";
     
-    for (procs_t::const_iterator p=procs.begin(), e=procs.end(); p!=e; ++p)
-        os << (*p)->name << "; ";
+    for (uint32_t p=0; p<graph.getProcessCount(); ++p)
+        os << graph.getProcessName(p) << "; ";
     os << "\n  }\n";
 }
 
@@ -135,16 +255,15 @@ void SignalFlow::printVarsForDot(ostream &os, bool ranked, bool erd)
     {
         os << "    node [shape=rectangle,color=blue];\n    ";
     }
-    for (strs_t::const_iterator i=variables.begin(), e=variables.end(); 
-         i!=e; ++i)
+    for (uint32_t v=0; v<graph.getVariableCount(); ++v)
     {
-        if (transmitters.find(*i) == transmitters.end())
+        if (graph.getSources(FlowGraph::WRITE, v).empty())
         {
-            os << *i << "; "; // const variables are slim
-            }
+            os << graph.getVariableName(v) << "; "; // const variables are slim
+        }
         else
         {
-            os << *i << "[style=bold]; "; // others bold
+            os << graph.getVariableName(v) << "[style=bold]; "; // others bold
         }
     }
     os << "\n  }\n";
@@ -155,19 +274,15 @@ void SignalFlow::printVarsWriteForDot(ostream &os)
     /* 'variable write' edges are bold */
     os<<"  edge [style=bold,color=blue,fontcolor=blue,weight=100];\n";
     /* draw variable write edges */
-    for (procs_t::const_iterator a=procs.begin(), ae=procs.end(); a!=ae; ++a)
+    for (uint32_t a=0; a<graph.getProcessCount(); ++a)
     {
-        if (!(*a)->wtVars.empty())
+        for (const uint32_t& v: graph.getTargets(FlowGraph::WRITE, a))
         {
-            for (str2strs_t::const_iterator v=(*a)->wtVars.begin(),
-                     ve=(*a)->wtVars.end(); v!=ve; ++v)
-            {
-                os<<"  "<<(*a)->name<< " -> " << v->first << " [label=\"(";
-                /* enumerate channels when variable is accessed */
-                for_each(v->second.begin(), v->second.end(),
-                         print<const char*>(os, ","));
-                os<<")\"];\n";
-            }
+            os<<"  "<<graph.getProcessName(a)<< " -> "
+              << graph.getVariableName(v) << " [label=\"(";
+            /* enumerate channels when variable is accessed */
+            printLabels(os, FlowGraph::WRITE, &v, ",");
+            os<<")\"];\n";
         }
     }
 }
@@ -177,116 +292,129 @@ void SignalFlow::printVarsReadForDot(ostream &os)
     /* 'variable read' edges are slim  */
     os<<"  edge [style=solid,color=blue,fontcolor=blue,weight=1];\n";
     /* draw variable edges */
-    for (procs_t::const_iterator a=procs.begin(),ae=procs.end(); a!=ae; ++a)
+    for (uint32_t a=0; a<graph.getProcessCount(); ++a)
     {
-        if (!(*a)->rdVars.empty())
+        for (const uint32_t& v: graph.getTargets(FlowGraph::READ, a))
         {
-            for (str2strs_t::const_iterator v = (*a)->rdVars.begin(),
-                     ve=(*a)->rdVars.end(); v!=ve; ++v)
-            {
-                os<<"  " << v->first << " -> " <<(*a)->name<<" [label=\"(";
-                /* enumerate channels when variable is accessed */
-                for_each(v->second.begin(), v->second.end(),
-                         print<const char*>(os, ","));
-                os<<")\"];\n";
-            }
+            os<<"  " << graph.getVariableName(v) << " -> "
+              << graph.getProcessName(a) <<" [label=\"(";
+            /* enumerate channels when variable is accessed */
+            printLabels(os, FlowGraph::READ, &v, ",");
+            os<<")\"];\n";
         }
     }
 }
 
-void SignalFlow::printChansOnEdgesForDot(ostream &os)
+/**
+ * Returns the channels on which the process sends, paired with and
+ * sorted by the receiving processes, where sends without receivers
+ * are paired with FlowGraph::none and come first.
+ */
+static vector<std::pair<uint32_t, uint32_t> > getOutEdges(const FlowGraph &graph,
+                                                          uint32_t process)
 {
-    /* channels appear only on I/O edges */
-    const char* src = "NO_SRC";
-    const char* dst = "NO_DST";
-    /* build an index of outgoing edges sorted by destination TA */
-    for (procs_t::const_iterator a=procs.begin(),ae=procs.end(); a!=ae; ++a)
+    vector<std::pair<uint32_t, uint32_t> > edges;
+    for (uint32_t c: graph.getTargets(FlowGraph::SEND, process))
     {
-        /* traverse all outgoing channels */
-        for (strs_t::const_iterator i=(*a)->outChans.begin(), 
-                 e=(*a)->outChans.end(); i!=e; ++i)
-        {
-            str2procs_t::const_iterator dests = receivers.find(*i);
-            if (dests != receivers.end())
-            { // there are destinations
-                for (procs_t::const_iterator rec = dests->second.begin();
-                     rec != dests->second.end(); ++rec)
-                {
-                    (*a)->outEdges[*rec].insert(*i);
-                }
-            }
-            else
-            { // no destination
-                (*a)->outEdges[NULL].insert(*i);
-            }
+        FlowGraph::range_t dests = graph.getSources(FlowGraph::RECEIVE, c);
+        if (dests.empty())
+        { // no destination
+            edges.push_back(std::make_pair(FlowGraph::none, c));
+        }
+        for (uint32_t rec: dests)
+        { // there are destinations
+            edges.push_back(std::make_pair(rec, c));
         }
     }
-    bool noDst = false;
-    /* display all edges: */
-    os<<"  edge[style=solid,color=black,fontcolor=black,weight=50];\n";
-    for (procs_t::const_iterator a=procs.begin(),ae=procs.end(); a!=ae; ++a)
+    /* none wraps around to be the smallest */
+    std::sort(edges.begin(), edges.end(),
+              [](const std::pair<uint32_t, uint32_t> &a,
+                 const std::pair<uint32_t, uint32_t> &b) {
+                  return a.first + 1 < b.first + 1
+                      || (a.first == b.first && a.second < b.second);
+              });
+    return edges;
+}
+
+/**
+ * Prints the channel communication of the process as labelled edges
+ * to the receiving processes, where quote surrounds channel names.
+ */
+static void printOutEdges(ostream &os, const FlowGraph &graph, uint32_t p,
+                          const char* quote, bool& noDst)
+{
+    const char* dst = "NO_DST";
+    vector<std::pair<uint32_t, uint32_t> > edges = getOutEdges(graph, p);
+    /* display outgoing edges: */
+    for (size_t i=0; i<edges.size(); ++i)
     {
-        /* display outgoing edges: */
-        for (proc2strs_t::const_iterator edge = (*a)->outEdges.begin(),
-                 edgeEnd=(*a)->outEdges.end(); edge!=edgeEnd; ++edge)
+        if (i>0 && edges[i].first == edges[i-1].first)
         {
-            // display edge:
-            if (edge->first != NULL)
-            {
-                //normal destination TA
-                os<<"  " <<(*a)->name << " -> " << edge->first->name
-                  << " [label=\"[";
-            }
-            else
-            { // there was no destination TA
-                if (!noDst)
-                {
-                    os<<"  "<<dst
-                      <<" [style=filled,fillcolor=red];\n";
-                    noDst = true;
-                }
-                os<<"  " <<(*a)->name << " -> " << dst
-                  << " [label=\"[";
-            }
-            // enumerate all channels on the edge:
-            strs_t::const_iterator ch=edge->second.begin();
-            while (true)
+            os << "," << quote << graph.getChannelName(edges[i].second)
+               << quote;
+            continue;
+        }
+        if (i>0)
+        {
+            os << "]\"];\n";
+        }
+        // display edge:
+        if (edges[i].first != FlowGraph::none)
+        {
+            //normal destination TA
+            os<<"  " << graph.getProcessName(p) << " -> "
+              << graph.getProcessName(edges[i].first) << " [label=\"[";
+        }
+        else
+        { // there was no destination TA
+            if (!noDst)
             {
-                    os<< *ch;
-                    ++ch;
-                    if (ch != edge->second.end())
-                    {
-                        os << ",";
-                    }
-                    else
-                    {
-                        break;
-                    }
+                os<<"  "<<dst
+                  <<" [style=filled,fillcolor=red];\n";
+                noDst = true;
             }
-            os << "]\"];\n";
+            os<<"  " << graph.getProcessName(p) << " -> " << dst
+              << " [label=\"[";
         }
-        /* by now all inps with sources are displayed as outputs
-         * search and display inputs w/o sources */
-        bool noSrc = false;
-        for (strs_t::const_iterator i=(*a)->inChans.begin(), 
-                 e=(*a)->inChans.end(); i!=e; ++i)
+        // enumerate all channels on the edge:
+        os << quote << graph.getChannelName(edges[i].second) << quote;
+    }
+    if (!edges.empty())
+    {
+        os << "]\"];\n";
+    }
+    /* by now all inps with sources are displayed as outputs
+     * search and display inputs w/o sources */
+    const char* src = "NO_SRC";
+    bool noSrc = false;
+    for (uint32_t c: graph.getTargets(FlowGraph::RECEIVE, p))
+    {
+        if (graph.getSources(FlowGraph::SEND, c).empty())
         {
-            str2procs_t::const_iterator trans = transmitters.find(*i);
-            if (trans==transmitters.end())
+            if (!noSrc)
             {
-                if (!noSrc)
-                {
-                    os<<"  "<<src
-                      <<" [style=filled,fillcolor=red];\n";
-                    noSrc = true;
-                }
-                os<<"  "<<src<<" -> " << (*a)->name << " [label=\""
-                  << *i << "\"];\n";
+                os<<"  "<<src
+                  <<" [style=filled,fillcolor=red];\n";
+                noSrc = true;
             }
+            os<<"  "<<src<<" -> " << graph.getProcessName(p) << " [label=\""
+              << graph.getChannelName(c) << "\"];\n";
         }
     }
 }
 
+void SignalFlow::printChansOnEdgesForDot(ostream &os)
+{
+    /* channels appear only on I/O edges */
+    bool noDst = false;
+    /* display all edges: */
+    os<<"  edge[style=solid,color=black,fontcolor=black,weight=50];\n";
+    for (uint32_t a=0; a<graph.getProcessCount(); ++a)
+    {
+        printOutEdges(os, graph, a, "", noDst);
+    }
+}
+
 void SignalFlow::printChansSeparateForDot(ostream &os, bool ranked, bool erd)
 {
     /* channels displayed as separate nodes (like variables) */
@@ -304,21 +432,24 @@ void SignalFlow::printChansSeparateForDot(ostream &os, bool ranked, bool erd)
     {
         os<<"    node [shape=diamond,color=red];\n    ";
     }
-    for_each(channels.begin(), channels.end(),
-             print<const char*>(os, "; "));
+    for (uint32_t c=0; c<graph.getChannelCount(); ++c)
+    {
+        if (c>0) os << "; ";
+        os << graph.getChannelName(c);
+    }
     os<< "\n  }\n";
     
-    for (procs_t::const_iterator a=procs.begin(),ae=procs.end(); a!=ae; ++a)
+    for (uint32_t a=0; a<graph.getProcessCount(); ++a)
     {
-        for (strs_t::const_iterator i=(*a)->inChans.begin(), 
-                 e=(*a)->inChans.end(); i!=e; ++i)
+        for (uint32_t c: graph.getTargets(FlowGraph::RECEIVE, a))
         {
-            os << "  " << *i << " -> " << (*a)->name << ";\n";
+            os << "  " << graph.getChannelName(c) << " -> "
+               << graph.getProcessName(a) << ";\n";
         }
-        for (strs_t::const_iterator i=(*a)->outChans.begin(),
-                 e=(*a)->outChans.end(); i!=e; ++i)
+        for (uint32_t c: graph.getTargets(FlowGraph::SEND, a))
         {
-            os << "  " << (*a)->name << " -> " << *i << " [style=bold];\n";
+            os << "  " << graph.getProcessName(a) << " -> "
+               << graph.getChannelName(c) << " [style=bold];\n";
         }
     }
 }
@@ -339,24 +470,24 @@ void SignalFlow::printForDot(ostream &os, bool ranked, bool erd, bool cEdge)
 //    os << "  edge [decorate];\n"; // use 'dot -Edecorate' if you wish
     delete [] name;
 
-    if (!procs.empty()) printProcsForDot(os, erd);
+    if (graph.getProcessCount() > 0) printProcsForDot(os, erd);
 
 /* Enumerate variables, with common look-attributes */
-    if (!variables.empty()) {
+    if (graph.getVariableCount() > 0) {
         printVarsForDot(os, ranked, erd);
         printVarsWriteForDot(os);
         printVarsReadForDot(os);
     }
 
 /* enumerate draw channels */
-    if (!channels.empty()) {
+    if (graph.getChannelCount() > 0) {
         if (cEdge) printChansOnEdgesForDot(os);
         else printChansSeparateForDot(os, ranked, erd);
     }
     os << "}" << endl;
 }
 
-bool SignalFlow::checkParams(const symbol_t &s)
+bool ProcessFlow::checkParams(const symbol_t &s)
 {
     if (!paramsExpanded)
     {
@@ -391,57 +522,45 @@ bool SignalFlow::checkParams(const symbol_t &s)
     return true;
 }
 
-void SignalFlow::addChan(const std::string &s, strs_t &ids, str2procs_t& index)
+
+void ProcessFlow::addChan(const std::string &s, FlowGraph::relation_t relation)
 {
-    const char* s2;
-    strs_t::iterator it = channels.find(s.c_str());
-    if (it == channels.end()) {
-        s2 = strdup(s.c_str());
-        channels.insert(s2);
-    } else s2 = *it;
-    ids.insert(s2);
-    index[s2].insert(cTA);
-    cChan = s2;
+    cChan = graph.addChannel(s);
+    graph.add(relation, cChan);
 }
 
-void SignalFlow::addVar(const symbol_t &s, str2strs_t &ids,
-                         str2procs_t& index)
+void ProcessFlow::addVar(const symbol_t &s, FlowGraph::relation_t relation)
 {
     if (checkParams(s))
     {
-        ids[s.getName().c_str()].insert(cChan);
-        variables.insert(s.getName().c_str());
-        index[s.getName().c_str()].insert(cTA);
+        graph.add(relation, graph.addVariable(s.getName()), cChan);
     }
 }
 
-static const char* noChan = "-";
-
-void SignalFlow::visitProcess(instance_t &p)
+void ProcessFlow::visitProcess(instance_t &p)
 {
     cP = &p;
-    procs.insert(cTA = new proc_t(p.uid.getName().c_str()));
-    processes.insert(p.uid.getName().c_str());
+    graph.addProcess(p.uid.getName());
 
     const template_t* temp = p.templ;
     deque<state_t>::const_iterator s = temp->states.begin();
     while (s != temp->states.end())
     {
-        cChan = noChan; // invariants should not use shared
+        cChan = FlowGraph::none; // invariants should not use shared
         visitExpression(s->invariant);
         ++s;
     }
     deque<edge_t>::const_iterator t; 
     for (t = temp->edges.begin(); t != temp->edges.end(); ++t)
     {
-        cChan = noChan;// guards should not use shared
+        cChan = FlowGraph::none;// guards should not use shared
         visitExpression(t->guard);
         visitExpression(t->sync);
         visitExpression(t->assign);
     }
 }
 
-void SignalFlow::visitExpression(const expression_t &e)
+void ProcessFlow::visitExpression(const expression_t &e)
 {
     if (e.empty())
     {
@@ -554,8 +673,8 @@ void SignalFlow::visitExpression(const expression_t &e)
                 }
                 // else: local function variable but not parameter, don't care
             } else { // global variable
-                if (inp) addVar(sym, cTA->rdVars, receivers);
-                if (out) addVar(sym, cTA->wtVars, transmitters);
+                if (inp) addVar(sym, FlowGraph::READ);
+                if (out) addVar(sym, FlowGraph::WRITE);
             }
         }
         break;
@@ -651,12 +770,10 @@ void SignalFlow::visitExpression(const expression_t &e)
         chanString.clear();
         visitExpression(e[0]);
         if (inp) {
-            addChan(chanString, cTA->inChans, receivers);
-//            std::cerr << cTA->name << " receives on " << chanString << endl;
+            addChan(chanString, FlowGraph::RECEIVE);
         }
         if (out) {
-            addChan(chanString, cTA->outChans, transmitters);
-//            std::cerr << cTA->name << " sends on " << chanString << endl;
+            addChan(chanString, FlowGraph::SEND);
         }
         sync = false;
         break;
@@ -688,24 +805,24 @@ void SignalFlow::visitExpression(const expression_t &e)
     }
 }
 
-int32_t SignalFlow::visitEmptyStatement(EmptyStatement *stat)
+int32_t ProcessFlow::visitEmptyStatement(EmptyStatement *stat)
 {
     return 0;
 }
 
-int32_t SignalFlow::visitExprStatement(ExprStatement *stat)
+int32_t ProcessFlow::visitExprStatement(ExprStatement *stat)
 {
     visitExpression(stat->expr);
     return 0;
 }
 
-int32_t SignalFlow::visitIterationStatement(IterationStatement *stat)
+int32_t ProcessFlow::visitIterationStatement(IterationStatement *stat)
 {
 // FixMe: there is mysterious field called symbol, do smth about it.
     return stat->stat->accept(this);
 }
 
-int32_t SignalFlow::visitForStatement(ForStatement *stat)
+int32_t ProcessFlow::visitForStatement(ForStatement *stat)
 {
     visitExpression(stat->init);
     visitExpression(stat->cond);
@@ -713,20 +830,20 @@ int32_t SignalFlow::visitForStatement(ForStatement *stat)
     return stat->stat->accept(this);
 }
 
-int32_t SignalFlow::visitWhileStatement(WhileStatement *stat)
+int32_t ProcessFlow::visitWhileStatement(WhileStatement *stat)
 {
     visitExpression(stat->cond);
     return stat->stat->accept(this);
 }
 
-int32_t SignalFlow::visitDoWhileStatement(DoWhileStatement *stat)
+int32_t ProcessFlow::visitDoWhileStatement(DoWhileStatement *stat)
 {
     int32_t res = stat->stat->accept(this);
     visitExpression(stat->cond);
     return res;
 }
 
-int32_t SignalFlow::visitBlockStatement(BlockStatement *stat)
+int32_t ProcessFlow::visitBlockStatement(BlockStatement *stat)
 {
     int32_t res = 0;
     BlockStatement::iterator it = stat->begin();
@@ -738,24 +855,24 @@ int32_t SignalFlow::visitBlockStatement(BlockStatement *stat)
     return res;
 }
 
-int32_t SignalFlow::visitSwitchStatement(SwitchStatement *stat)
+int32_t ProcessFlow::visitSwitchStatement(SwitchStatement *stat)
 {
     visitExpression(stat->cond);
     return visitBlockStatement(stat);
 }
 
-int32_t SignalFlow::visitCaseStatement(CaseStatement *stat)
+int32_t ProcessFlow::visitCaseStatement(CaseStatement *stat)
 {
     visitExpression(stat->cond);
     return visitBlockStatement(stat);
 }
 
-int32_t SignalFlow::visitDefaultStatement(DefaultStatement *stat)
+int32_t ProcessFlow::visitDefaultStatement(DefaultStatement *stat)
 {
     return visitBlockStatement(stat);
 }
 
-int32_t SignalFlow::visitIfStatement(IfStatement *stat)
+int32_t ProcessFlow::visitIfStatement(IfStatement *stat)
 {
     visitExpression(stat->cond);
     int32_t res = stat->trueCase->accept(this);
@@ -765,253 +882,192 @@ int32_t SignalFlow::visitIfStatement(IfStatement *stat)
     }
     else return res;
 }
-int32_t SignalFlow::visitBreakStatement(BreakStatement *stat)
+int32_t ProcessFlow::visitBreakStatement(BreakStatement *stat)
 {
     return 0;
 }
 
-int32_t SignalFlow::visitContinueStatement(ContinueStatement *stat)
+int32_t ProcessFlow::visitContinueStatement(ContinueStatement *stat)
 {
     return 0;
 }
 
-int32_t SignalFlow::visitAssertStatement(UTAP::AssertStatement *stat)
+int32_t ProcessFlow::visitAssertStatement(UTAP::AssertStatement *stat)
 {
     return 0;
 }
 
-int32_t SignalFlow::visitReturnStatement(ReturnStatement *stat)
+int32_t ProcessFlow::visitReturnStatement(ReturnStatement *stat)
 {
     visitExpression(stat->value);
     return 0;
 }
 
+
 SignalFlow::~SignalFlow()
 {
-    procs_t::const_iterator p;
-    for (p = procs.begin(); p != procs.end(); ++p) delete *p;
-    strs_t::const_iterator c;
-    for (c = channels.begin(); c != channels.end(); ++c) delete *c;
 }
 
-Partitioner::~Partitioner()
+void Partitioner::printViolation(uint32_t proc, const string& name)
 {
-    strs_t::const_iterator s;
-    for (s=chansInp.begin(); s!=chansInp.end(); ++s) free((char*)*s);
-    for (s=chansOut.begin(); s!=chansOut.end(); ++s) free((char*)*s);
-    chansInp.clear(); chansOut.clear();
+    if (verbosity>=1)
+        cerr << "Violated rule \"" << rule << "\" for process \""
+             << graph.getProcessName(proc) << "\" accessing \"" << name
+             << "\"" << endl;
 }
 
-inline void Partitioner::printViolation(const proc_t* proc, const char* var)
+/**
+ * Puts the entity on the given side because of the process using it.
+ * Reports inconsistency if the entity is on the other side already.
+ * Returns true if the entity was not categorized before.
+ */
+bool Partitioner::classify(side_t& current, side_t side, uint32_t process,
+                           const string& name)
 {
-    if (verbosity>=1)
-        cerr << "Violated rule \"" << rule << "\" for process \""
-             << proc->name << "\" accessing \"" << var << "\"" << endl;
+    if (current == FREE) {
+        current = side;
+        changed = true;
+        return true;
+    }
+    if (current != side && current != BAD) {// if it was excluded
+        current = BAD; // report as inconsistent
+        changed = true;
+        printViolation(process, name);
+    }
+    return false;
+}
+
+/**
+ * Returns the internal channels of the scope on the given side.
+ */
+vector<uint32_t> Partitioner::getChans(const scope_t& scope, side_t side) const
+{
+    vector<uint32_t> chans;
+    for (uint32_t c: scope.chans)
+        if (chanSides[c] == side) chans.push_back(c);
+    return chans;
 }
 
 /**
- * Adds processes to the result which use the channels from chans list
- * according to index. Reports inconsistency if some process happens to be
- * in exclude list.
+ * Returns true if all the labels are observable channels.
  */
-void Partitioner::addProcs(const strs_t& chans, const str2procs_t& index,
-                           procs_t& result, procs_t& exclude)
+bool Partitioner::isObservable(FlowGraph::range_t labels) const
 {
+    for (uint32_t c: labels)
+        if (c == FlowGraph::none || !observable[c]) return false;
+    return true;
+}
 
-    for (strs_t::const_iterator c=chans.begin(), ce=chans.end(); c!=ce; ++c)
+/**
+ * Adds processes to the side which use the channels from chans list
+ * according to relation. Reports inconsistency if some process happens to
+ * be on the other side.
+ */
+void Partitioner::addProcs(const vector<uint32_t>& chans,
+                           FlowGraph::relation_t relation, side_t side)
+{
+    for (uint32_t c: chans)
     {    // take each channel from the given set
-        str2procs_t::const_iterator c2p;
-        c2p = index.find(*c);//find processes that use the channel
-        if (c2p != index.end()) {
-            for (procs_t::const_iterator p=c2p->second.begin(),
-                     pe=c2p->second.end(); p!=pe; ++p)
-            {
-                if (exclude.erase(*p) > 0) {// if process was excluded
-                    procsBad.insert(*p);// report as inconsistent process
-                    printViolation(*p, *c);
-                } else if (result.find(*p) == result.end() &&
-                           procsBad.find(*p) == procsBad.end()) {
-                    // if process has not been added nor excluded, then add it:
-                    if (verbosity>=3)
-                        cerr << "Adding \""<<(*p)->name <<"\" using \""<<(*c)
-                             <<"\" by rule \""<<rule<<"\""<<endl;
-                    result.insert(*p);
-                }
-            }
+        const string& chan = graph.getChannelName(c);
+        for (uint32_t p: graph.getSources(relation, c))
+        {//find processes that use the channel
+            if (classify(procSides[p], side, p, chan) && verbosity>=3)
+                cerr << "Adding \""<<graph.getProcessName(p)<<"\" using \""
+                     <<chan<<"\" by rule \""<<rule<<"\""<<endl;
         }
     }
 }
 
 /**
- * Takes the internal channels of each process from procs list and adds
- * them to the result list. Reports inconcistency if channel is in the
- * exclude list.
+ * Takes the internal channels of each process of the scope from the side
+ * and adds them to the side. Reports inconcistency if channel is on the
+ * other side.
  */
-void Partitioner::addIntChans(const procs_t& procs,
-                              strs_t& result, strs_t& exclude)
-{
-    for (procs_t::const_iterator p=procs.begin(), pe=procs.end(); p!=pe; ++p)
-    {// take each process from the list
-        for (strs_t::const_iterator c=(*p)->inChans.begin(),
-                 ce=(*p)->inChans.end(); c!=ce; ++c)
-        { // consider the input channels used by the process
-            if (observable.find(*c) == observable.end()) {// if not observed
-                if (exclude.erase(*c) > 0) {// if it's excluded
-                    chansBad.insert(*c); // report inconsistency
-                    printViolation(*p, *c);
-                } else if (result.find(*c) == result.end() &&
-                           chansBad.find(*c) == chansBad.end()) {
-                    if (verbosity>=3)
-                        cerr << "Adding \""<<(*c)<<"\" because of \""
-                             <<(*p)->name <<"\" by rule \""<<rule
-                             <<"\""<<endl;
-                    result.insert(*c);
-                }
-            }
-        }
-        for (strs_t::const_iterator c=(*p)->outChans.begin(),
-                 ce=(*p)->outChans.end(); c!=ce; ++c)
-        { // conside the output channels used by p
-            if (observable.find(*c) == observable.end()) {// if not observed
-                if (exclude.erase(*c) > 0) {// if it's excluded
-                    chansBad.insert(*c);// report inconsistency
-                    printViolation(*p, *c);
-                } else if (result.find(*c) == result.end() &&
-                           chansBad.find(*c) == chansBad.end()) {
-                    if (verbosity>=3)
-                        cerr << "Adding \""<<(*c)<<"\" because of \""
-                             <<(*p)->name <<"\" by rule \""<<rule
-                             <<"\""<<endl;
-                    result.insert(*c);
-                }
+void Partitioner::addIntChans(const scope_t& scope, side_t side)
+{
+    const FlowGraph::relation_t relations[] =
+        { FlowGraph::RECEIVE, FlowGraph::SEND };
+    for (uint32_t p: scope.procs)
+    {// take each process from the side
+        if (procSides[p] != side) continue;
+        for (FlowGraph::relation_t relation: relations)
+        {
+            for (uint32_t c: graph.getTargets(relation, p))
+            { // consider the channels used by the process
+                if (observable[c]) continue;
+                const string& chan = graph.getChannelName(c);
+                if (classify(chanSides[c], side, p, chan) && verbosity>=3)
+                    cerr << "Adding \""<<chan<<"\" because of \""
+                         <<graph.getProcessName(p)<<"\" by rule \""<<rule
+                         <<"\""<<endl;
             }
         }
     }
 }
 
 /**
- * Takes the variables of each process from procs list and adds them to
- * the result list. Reports inconcistency if variable is in the exclude list.
+ * Takes the variables of each process of the scope from the side and adds
+ * them to the side. Reports inconcistency if variable is on the other side.
  */
-void Partitioner::addIntVars(const procs_t& procs, strs_t& result,
-                             strs_t& exclude)
-{
-    for (procs_t::const_iterator p=procs.begin(), pe=procs.end(); p!=pe; ++p)
-    { // take each process p
-        assert(*p);
-        for (str2strs_t::const_iterator v2c=(*p)->rdVars.begin(),
-                 v2ce=(*p)->rdVars.end(); v2c!=v2ce; ++v2c)
-        { // consider the variables being read
-            if (!includes(observable.begin(), observable.end(),
-                          v2c->second.begin(), v2c->second.end(), less_str()))
-            {// contains non-observable channels
-                if (exclude.erase(v2c->first) > 0) {
-                    varsBad.insert(v2c->first);
-                    printViolation(*p, v2c->first);
-                } else if (result.find(v2c->first) == result.end() &&
-                           varsBad.find(v2c->first) == varsBad.end()) {
-                    if (verbosity>=3)
-                        cerr << "Adding \""<<(v2c->first)<<"\" because of \""
-                             <<(*p)->name <<"\" by rule \""<<rule<<"\""<<endl;
-                    result.insert(v2c->first);
-                }
-            }// else used only observably
-        }
-        for (str2strs_t::const_iterator v2c=(*p)->wtVars.begin(),
-                 v2ce=(*p)->wtVars.end(); v2c!=v2ce; ++v2c)
-        { // consider the variables being written to by p
-            if (!includes(observable.begin(), observable.end(),
-                          v2c->second.begin(), v2c->second.end(), less_str()))
-            {// contains non-observable channels
-                if (exclude.erase(v2c->first) > 0) {
-                    varsBad.insert(v2c->first);
-                    printViolation(*p, v2c->first);
-                } else if (result.find(v2c->first) == result.end() &&
-                           varsBad.find(v2c->first) == varsBad.end()) {
-                    if (verbosity>=3)
-                        cerr << "Adding \""<<(v2c->first)<<"\" because of \""
-                             <<(*p)->name <<"\" by rule \""<<rule<<"\""<<endl;
-                    result.insert(v2c->first);
-                }
-            }// else used only observably
+void Partitioner::addIntVars(const scope_t& scope, side_t side)
+{
+    const FlowGraph::relation_t relations[] =
+        { FlowGraph::READ, FlowGraph::WRITE };
+    for (uint32_t p: scope.procs)
+    { // take each process p from the side
+        if (procSides[p] != side) continue;
+        for (FlowGraph::relation_t relation: relations)
+        {
+            for (const uint32_t& v: graph.getTargets(relation, p))
+            { // consider the variables being read or written
+                if (isObservable(graph.getLabels(relation, &v)))
+                    continue; // used only observably
+                const string& var = graph.getVariableName(v);
+                if (classify(varSides[v], side, p, var) && verbosity>=3)
+                    cerr << "Adding \""<<var<<"\" because of \""
+                         <<graph.getProcessName(p)<<"\" by rule \""<<rule
+                         <<"\""<<endl;
+            }
         }
     }
 }
 
 /**
- * Take all variables and add all accessing processes to the list.
- * Report inconcistencies if process happens to be in exclude list.
+ * Take all variables of the scope on the side and add all accessing
+ * processes to it. Report inconcistencies if process happens to be on the
+ * other side.
  */
-void Partitioner::addProcsByVars(const strs_t& vars, procs_t& procs,
-                                 procs_t& exclude)
-{
-    str2procs_t::const_iterator v2p;
-    str2strs_t::const_iterator v2c;
-    for (strs_t::const_iterator v=vars.begin(), ve=vars.end(); v!=ve; ++v)
-    { // take every variable v from the vars list
-        v2p=receivers.find(*v); // find list of processes that read from v
-        if (v2p != receivers.end()) {
-            for(procs_t::const_iterator p=v2p->second.begin(),
-                    pe=v2p->second.end(); p!=pe; ++p)
-            {// take each process reading the value of v
-                v2c = (*p)->rdVars.find(*v);
-                if (v2c != (*p)->rdVars.end()) {
-                    if (!includes(observable.begin(), observable.end(),
-                                  v2c->second.begin(), v2c->second.end(),
-                                  less_str()))
-                    {// has unobservable synchronizations
-                        if (exclude.erase(*p) > 0) {
-                            procsBad.insert(*p);
-                            printViolation(*p, *v);
-                        } else if (procs.find(*p) == procs.end() &&
-                                   procsBad.find(*p) == procsBad.end()) {
-                            if (verbosity>=3)
-                                cerr << "Adding \""<<(*p)->name
-                                     <<"\" using \""<<(*v)
-                                     <<"\" by rule \""<<rule<<"\""<<endl;
-                            procs.insert(*p);
-                        }
-                    }// else used observably
-                } else {
-                    if (verbosity>=1)
-                        cerr<<"addProcsByVars could not find in rdVars"<<endl;
-                }
-            }
-        } else {
-            if (verbosity>=1)
-                cerr << "addProcsByVars could not find readers"<<endl;
+void Partitioner::addProcsByVars(const scope_t& scope, side_t side)
+{
+    for (uint32_t v: scope.vars)
+    { // take every variable v from the side
+        if (varSides[v] != side) continue;
+        const string& var = graph.getVariableName(v);
+        FlowGraph::range_t readers = graph.getSources(FlowGraph::READ, v);
+        if (readers.empty() && verbosity>=1)
+            cerr << "addProcsByVars could not find readers for "<<var<<endl;
+        for (uint32_t p: readers)
+        {// take each process reading the value of v
+            const uint32_t* t = graph.findTarget(FlowGraph::READ, p, v);
+            if (isObservable(graph.getLabels(FlowGraph::READ, t)))
+                continue; // used observably
+            if (classify(procSides[p], side, p, var) && verbosity>=3)
+                cerr << "Adding \""<<graph.getProcessName(p)
+                     <<"\" using \""<<var
+                     <<"\" by rule \""<<rule<<"\""<<endl;
         }
-        v2p=transmitters.find(*v);
-        if (v2p != transmitters.end()) {
-            for(procs_t::const_iterator p=v2p->second.begin(),
-                    pe=v2p->second.end(); p!=pe; ++p)
-            { // consider the process p which writes to v
-                v2c = (*p)->wtVars.find(*v);
-                if (v2c != (*p)->wtVars.end()) {
-                    if (!includes(observable.begin(), observable.end(),
-                                  v2c->second.begin(), v2c->second.end(),
-                                  less_str()))
-                    {// has unobservable synchronizations
-                        if (exclude.erase(*p) > 0) {
-                            procsBad.insert(*p);
-                            printViolation(*p, *v);
-                        } else if (procs.find(*p) == procs.end() &&
-                                   procsBad.find(*p) == procsBad.end()) {
-                            if (verbosity>=3)
-                                cerr << "Adding \""<<(*p)->name
-                                     <<"\" using \""<<(*v)
-                                     <<"\" by rule \""<<rule<<"\""<<endl;
-                            procs.insert(*p);
-                        }
-                    }// else used observably
-                } else {
-                    if (verbosity>=1)
-                        cerr<<"addProcsByVars could not find in wtVars"<<endl;
-                }
-            }
-        } else {
-            if (verbosity>=1)
-                cerr<<"addProcsByVars could not find writers for "<<(*v)<<endl;
+        FlowGraph::range_t writers = graph.getSources(FlowGraph::WRITE, v);
+        if (writers.empty() && verbosity>=1)
+            cerr << "addProcsByVars could not find writers for "<<var<<endl;
+        for (uint32_t p: writers)
+        { // consider the process p which writes to v
+            const uint32_t* t = graph.findTarget(FlowGraph::WRITE, p, v);
+            if (isObservable(graph.getLabels(FlowGraph::WRITE, t)))
+                continue; // used observably
+            if (classify(procSides[p], side, p, var) && verbosity>=3)
+                cerr << "Adding \""<<graph.getProcessName(p)
+                     <<"\" using \""<<var
+                     <<"\" by rule \""<<rule<<"\""<<endl;
         }
     }
 }
@@ -1068,43 +1124,51 @@ int Partitioner::partition(istream& ioinfo)
     return res;
 }
 
-int Partitioner::partition(const strs_t& inputs, const strs_t& outputs)
+/**
+ * Prints the names of the entities on the side separated by sep.
+ */
+template <class Name>
+static void printSide(ostream& os, const vector<Partitioner::side_t>& sides,
+                      Partitioner::side_t side, Name name, const char* sep)
 {
-    procsEnv.clear(); procsIUT.clear();
-    chansIntEnv.clear(); chansIntIUT.clear();
-    varsEnv.clear(); varsIUT.clear();
-    strs_t::const_iterator s;
-    for (s=chansInp.begin(); s!=chansInp.end(); ++s) free((char*)*s);
-    for (s=chansOut.begin(); s!=chansOut.end(); ++s) free((char*)*s);
-    chansInp.clear(); chansOut.clear();
-
-    for (s=inputs.begin(); s!=inputs.end(); ++s)
-        chansInp.insert(strdup(*s));
-    for (s=outputs.begin(); s!=outputs.end(); ++s)
-        chansOut.insert(strdup(*s));
-
-    observable.clear();
-    observable.insert(chansInp.begin(), chansInp.end());
-    observable.insert(chansOut.begin(), chansOut.end());
+    const char* infix = "";
+    for (uint32_t i=0; i<sides.size(); ++i)
+    {
+        if (sides[i] == side) {
+            os << infix << name(i);
+            infix = sep;
+        }
+    }
+}
 
-    if (verbosity>=3) {
-        cerr << "Inputs:  " << chansInp << endl;
-        cerr << "Outputs: " << chansOut << endl;
+/**
+ * Applies the partitioning rules to the scope until no side changes.
+ * The scope must contain the internal channels and the variables used by
+ * its processes and the processes using its internal channels and
+ * variables.
+ */
+void Partitioner::close(const scope_t& scope)
+{
+    vector<uint32_t> chansIn, chansOutput;
+    for (uint32_t c: scope.chans) {
+        if (!observable[c]) continue;
+        const string& chan = graph.getChannelName(c);
+        if (chansInp.count(chan)) chansIn.push_back(c);
+        if (chansOut.count(chan)) chansOutput.push_back(c);
     }
 
-    size_t oldProgress=0, progress=0;
     do {
-        oldProgress = progress;
+        changed = false;
 /* Environment processes shout on inputs and listens to outputs, while IUT
  * processes shout on outputs and listen to inputs. */
         rule="transmitters on input channels belong to Env";
-        addProcs(inputs, transmitters, procsEnv, procsIUT);
+        addProcs(chansIn, FlowGraph::SEND, ENV);
         rule="receivers on output channels belong to Env";
-        addProcs(outputs, receivers, procsEnv, procsIUT);
+        addProcs(chansOutput, FlowGraph::RECEIVE, ENV);
         rule="receivers on input channels belong IUT";
-        addProcs(inputs, receivers, procsIUT, procsEnv);
+        addProcs(chansIn, FlowGraph::RECEIVE, IUT);
         rule="transmitters on output channels belong IUT";
-        addProcs(outputs, transmitters, procsIUT, procsEnv);
+        addProcs(chansOutput, FlowGraph::SEND, IUT);
 
 /* 1) channels, that are not declared as inputs/outputs, are non-observable,
  *    called internal.*/
@@ -1114,102 +1178,245 @@ int Partitioner::partition(const strs_t& inputs, const strs_t& outputs)
  *    cannot be partitioned if the internal channel is used by both environment
  *    and IUT. */
         rule="internal channel belongs to Env if it is used by Env";
-        addIntChans(procsEnv, chansIntEnv, chansIntIUT);
+        addIntChans(scope, ENV);
         rule="internal channel belongs to IUT if it is used by IUT";
-        addIntChans(procsIUT, chansIntIUT, chansIntEnv);
+        addIntChans(scope, IUT);
 
 /* 3) process belongs to environment (IUT) if it uses the internal environment
  *    (IUT) channel (respectively). */
+        vector<uint32_t> chansIntEnv = getChans(scope, ENV);
+        vector<uint32_t> chansIntIUT = getChans(scope, IUT);
         rule="process belongs to Env if it shouts on internal Env channel";
-        addProcs(chansIntEnv, transmitters, procsEnv, procsIUT);
+        addProcs(chansIntEnv, FlowGraph::SEND, ENV);
         rule="process belongs to Env if it listens to internal Env channel";
-        addProcs(chansIntEnv, receivers, procsEnv, procsIUT);
+        addProcs(chansIntEnv, FlowGraph::RECEIVE, ENV);
         rule="process belongs to IUT if it shouts on internal IUT channel";
-        addProcs(chansIntIUT, transmitters, procsIUT, procsEnv);
+        addProcs(chansIntIUT, FlowGraph::SEND, IUT);
         rule="process belongs to IUT if it listens to internal IUT channel";
-        addProcs(chansIntIUT, receivers, procsIUT, procsEnv);
+        addProcs(chansIntIUT, FlowGraph::RECEIVE, IUT);
 
 /* 4) variable belongs to environment (IUT) if it is accessed by environment
  *    (IUT) process without observable input/output channel synchronization.
  *    Variable is not cathegorized (can be either) if accessed consistently
  *    only during observable input/output channel synchronization. */
         rule="variable belongs to Env if accessed by Env without observable sync";
-        addIntVars(procsEnv, varsEnv, varsIUT);
+        addIntVars(scope, ENV);
         rule="variable belongs to IUT if accessed by IUT without observable sync";
-        addIntVars(procsIUT, varsIUT, varsEnv);
+        addIntVars(scope, IUT);
 
 /* 5) process belongs to environment (IUT) if it accesses environment (IUT)
  *    variable (respectively) without observable channel synchronization. */
         rule="process belongs to Env if it access Env variable without observable synchronization";
-        addProcsByVars(varsEnv, procsEnv, procsIUT);
+        addProcsByVars(scope, ENV);
         rule="process belongs to IUT if it access IUT variable without observable synchronization";
-        addProcsByVars(varsIUT, procsIUT, procsEnv);
-        progress = procsEnv.size() + procsIUT.size() + procsBad.size();
-    } while (progress>oldProgress);
-    procs_t::const_iterator p;
+        addProcsByVars(scope, IUT);
+    } while (changed);
+}
 
+int Partitioner::partition(const strs_t& inputs, const strs_t& outputs)
+{
+    procSides.assign(graph.getProcessCount(), FREE);
+    chanSides.assign(graph.getChannelCount(), FREE);
+    varSides.assign(graph.getVariableCount(), FREE);
+    observable.assign(graph.getChannelCount(), false);
+    chansInp.clear(); chansOut.clear();
+
+    strs_t::const_iterator s;
+    for (s=inputs.begin(); s!=inputs.end(); ++s) {
+        chansInp.insert(*s);
+        uint32_t c = graph.findChannel(*s);
+        if (c != FlowGraph::none) observable[c] = true;
+    }
+    for (s=outputs.begin(); s!=outputs.end(); ++s) {
+        chansOut.insert(*s);
+        uint32_t c = graph.findChannel(*s);
+        if (c != FlowGraph::none) observable[c] = true;
+    }
+
+    if (verbosity>=3) {
+        cerr << "Inputs:  ";
+        for_each(chansInp.begin(), chansInp.end(), print<string>(cerr, ", "));
+        cerr << endl;
+        cerr << "Outputs: ";
+        for_each(chansOut.begin(), chansOut.end(), print<string>(cerr, ", "));
+        cerr << endl;
+    }
+
+    scope_t scope;
+    for (uint32_t p=0; p<procSides.size(); ++p) scope.procs.push_back(p);
+    for (uint32_t c=0; c<chanSides.size(); ++c) scope.chans.push_back(c);
+    for (uint32_t v=0; v<varSides.size(); ++v) scope.vars.push_back(v);
+    close(scope);
+
+    auto procName = [this](uint32_t p) -> const string& {
+        return graph.getProcessName(p);
+    };
+    auto chanName = [this](uint32_t c) -> const string& {
+        return graph.getChannelName(c);
+    };
+    auto varName = [this](uint32_t v) -> const string& {
+        return graph.getVariableName(v);
+    };
     if (verbosity>=3) {
         cerr << "==== Partitioned =========================================\n";
-        cerr << "Env procs: " << procsEnv << endl;
-        cerr << "Env chans: " << chansIntEnv << endl;
-        cerr << "Env vars:  " << varsEnv << endl;
-        cerr << "----------------------------------------------------------\n";
-        cerr << "IUT procs: " << procsIUT << endl;
-        cerr << "IUT chans: " << chansIntIUT << endl;
-        cerr << "IUT vars:  " << varsIUT << endl;
-        cerr << "==========================================================\n";
+        cerr << "Env procs: "; printSide(cerr, procSides, ENV, procName, ", ");
+        cerr << "\nEnv chans: "; printSide(cerr, chanSides, ENV, chanName, ", ");
+        cerr << "\nEnv vars:  "; printSide(cerr, varSides, ENV, varName, ", ");
+        cerr << "\n----------------------------------------------------------\n";
+        cerr << "IUT procs: "; printSide(cerr, procSides, IUT, procName, ", ");
+        cerr << "\nIUT chans: "; printSide(cerr, chanSides, IUT, chanName, ", ");
+        cerr << "\nIUT vars:  "; printSide(cerr, varSides, IUT, varName, ", ");
+        cerr << "\n==========================================================\n";
     }
     if (verbosity>=1) {
-        if (!procsBad.empty())
-            cerr << "Inconsistent procs: " << procsBad << endl;
-        if (!chansBad.empty())
-            cerr << "Inconsistent chans: " << chansBad << endl;
-        if (!varsBad.empty())
-            cerr << "Inconsistent vars:  " << varsBad << endl;
+        if (std::count(procSides.begin(), procSides.end(), BAD) > 0) {
+            cerr << "Inconsistent procs: ";
+            printSide(cerr, procSides, BAD, procName, ", ");
+            cerr << endl;
+        }
+        if (std::count(chanSides.begin(), chanSides.end(), BAD) > 0) {
+            cerr << "Inconsistent chans: ";
+            printSide(cerr, chanSides, BAD, chanName, ", ");
+            cerr << endl;
+        }
+        if (std::count(varSides.begin(), varSides.end(), BAD) > 0) {
+            cerr << "Inconsistent vars:  ";
+            printSide(cerr, varSides, BAD, varName, ", ");
+            cerr << endl;
+        }
     }
     if (verbosity>=2) {
-        procs_t leftovers;
-        for (p=procs.begin(); p!=procs.end(); ++p)
-            if (procsEnv.find(*p) == procsEnv.end() &&
-                procsIUT.find(*p) == procsIUT.end())
-                leftovers.insert(*p);
-        if (!leftovers.empty()) {
+        vector<side_t> leftovers(procSides); // neither Env nor IUT
+        std::replace(leftovers.begin(), leftovers.end(), BAD, FREE);
+        if (std::count(leftovers.begin(), leftovers.end(), FREE) > 0) {
             cerr << "==== Not partitioned: ====================================\n";
-            cerr << "procs: " << leftovers << endl;
+            cerr << "procs: ";
+            printSide(cerr, leftovers, FREE, procName, ", ");
+            cerr << endl;
         }
     }
 
-    if (!procsBad.empty() || !chansBad.empty() || !varsBad.empty()) return 2;
-    if (progress==procs.size()) return 0; // all procs are partitioned
+    return getStatus();
+}
+
+int Partitioner::getStatus() const
+{
+    if (std::count(procSides.begin(), procSides.end(), BAD) > 0 ||
+        std::count(chanSides.begin(), chanSides.end(), BAD) > 0 ||
+        std::count(varSides.begin(), varSides.end(), BAD) > 0)
+        return 2;
+    if (std::count(procSides.begin(), procSides.end(), FREE) == 0)
+        return 0; // all procs are partitioned
     else return 1;// some left unpartitioned
 }
 
+/**
+ * Returns the processes, channels and variables connected to the users of
+ * chan by internal channels and unobservable variable accesses, counting
+ * chan itself as internal.  Only these can change their side when chan
+ * becomes observable or internal.
+ */
+Partitioner::scope_t Partitioner::getScope(uint32_t chan) const
+{
+    const FlowGraph::relation_t chanRelations[] =
+        { FlowGraph::SEND, FlowGraph::RECEIVE };
+    const FlowGraph::relation_t varRelations[] =
+        { FlowGraph::READ, FlowGraph::WRITE };
+    auto internal = [this, chan](FlowGraph::range_t labels) {
+        for (uint32_t c: labels)
+            if (c == FlowGraph::none || c == chan || !observable[c])
+                return true;
+        return false;
+    };
+    scope_t scope;
+    vector<bool> procSeen(procSides.size(), false);
+    vector<bool> chanSeen(chanSides.size(), false);
+    vector<bool> varSeen(varSides.size(), false);
+    auto addProc = [&scope, &procSeen](uint32_t p) {
+        if (!procSeen[p]) {
+            procSeen[p] = true;
+            scope.procs.push_back(p);
+        }
+    };
+    for (FlowGraph::relation_t relation: chanRelations)
+        for (uint32_t p: graph.getSources(relation, chan))
+            addProc(p);
+    for (size_t i=0; i<scope.procs.size(); ++i)
+    {// scope.procs grows while the processes are visited
+        uint32_t p = scope.procs[i];
+        for (FlowGraph::relation_t relation: chanRelations)
+        {
+            for (uint32_t c: graph.getTargets(relation, p))
+            {
+                if (chanSeen[c]) continue;
+                chanSeen[c] = true;
+                scope.chans.push_back(c);
+                if (observable[c] && c != chan) continue;
+                for (FlowGraph::relation_t r: chanRelations)
+                    for (uint32_t q: graph.getSources(r, c))
+                        addProc(q);
+            }
+        }
+        for (FlowGraph::relation_t relation: varRelations)
+        {
+            for (const uint32_t& v: graph.getTargets(relation, p))
+            {
+                if (varSeen[v] || !internal(graph.getLabels(relation, &v)))
+                    continue;
+                varSeen[v] = true;
+                scope.vars.push_back(v);
+                for (FlowGraph::relation_t r: varRelations)
+                    for (uint32_t q: graph.getSources(r, v))
+                        if (internal(graph.getLabels(r,
+                                     graph.findTarget(r, q, v))))
+                            addProc(q);
+            }
+        }
+    }
+    return scope;
+}
+
+int Partitioner::update(const string& name, std::set<string>& chans,
+                        bool add, changes_t& changes)
+{
+    if (add) chans.insert(name);
+    else chans.erase(name);
+    uint32_t chan = graph.findChannel(name);
+    if (chan == FlowGraph::none)
+        return getStatus(); // not used by any process
+
+    // forget the sides within the scope and partition it again
+    scope_t scope = getScope(chan);
+    vector<side_t> before(scope.procs.size());
+    for (size_t i=0; i<scope.procs.size(); ++i) {
+        before[i] = procSides[scope.procs[i]];
+        procSides[scope.procs[i]] = FREE;
+    }
+    for (uint32_t c: scope.chans) chanSides[c] = FREE;
+    for (uint32_t v: scope.vars) varSides[v] = FREE;
+    observable[chan] = chansInp.count(name) > 0 || chansOut.count(name) > 0;
+    close(scope);
+
+    for (size_t i=0; i<scope.procs.size(); ++i) {
+        uint32_t p = scope.procs[i];
+        if (procSides[p] != before[i])
+            changes.push_back({ p, before[i], procSides[p] });
+    }
+    return getStatus();
+}
+
 #define BADSTYLE "style=filled,fillcolor=\"#FF8080\""
 #define IUTSTYLE "style=filled,fillcolor=\"#B8C0FF\""
 #define ENVSTYLE "style=filled,fillcolor=\"#C8FFC8\""
 #define MEDSTYLE "style=filled,fillcolor=\"#C0C0C0\""
 
-inline void set_remove(SignalFlow::strs_t& from, 
-                       const SignalFlow::strs_t& what) 
+/* prints quoted channel names each followed by a semicolon */
+static void printQuoted(ostream& os, const std::set<string>& chans)
 {
-    for (SignalFlow::strs_t::const_iterator b=what.begin(), e=what.end(); 
-         b!=e; ++b)
-        from.erase(*b);
+    for (const string& c: chans)
+        os << "\"" << c << "\"; ";
 }
 
-struct surround: public std::unary_function<const char*, void>
-{
-    ostream &out;
-    const char* pre;
-    const char* post;
-    surround(ostream &os, const char* prefix, const char* postfix):
-        out(os), pre(prefix), post(postfix) {}
-    void operator()(const char* x) {
-        out << pre << x << post;
-    }
-};
-
-
 void Partitioner::printForDot(ostream &os, bool ranked, bool erd, bool cEdge)
 {
     char* name = strcpy(new char[strlen(title)+1], title);
@@ -1235,269 +1442,164 @@ void Partitioner::printForDot(ostream &os, bool ranked, bool erd, bool cEdge)
         "// legend:\n"
         "// process[shape=ellipse]; int[shape=rectangle]; chan[shape=diamond];\n\n";
 
-    procs_t::const_iterator p, pe;
-    strs_t procsR(processes), chansR(channels), varsR(variables); // remaining
-    
-    ostream_iterator<const char*> osi(os, "; ");
-
-    if (!procsBad.empty()) {
+    auto procName = [this](uint32_t p) -> const string& {
+        return graph.getProcessName(p);
+    };
+    auto chanName = [this](uint32_t c) {
+        return "\"" + graph.getChannelName(c) + "\"";
+    };
+    auto varName = [this](uint32_t v) -> const string& {
+        return graph.getVariableName(v);
+    };
+
+    if (std::count(procSides.begin(), procSides.end(), BAD) > 0) {
         os << "// processes in conflict:\n"
             "  node [shape=ellipse,peripheries=1," BADSTYLE "];\n  ";
-        for (p = procsBad.begin(), pe = procsBad.end(); p!=pe; ++p) {
-            os << (*p)->name << "; ";
-            procsR.erase((*p)->name);
-        }
-        os << endl;
+        printSide(os, procSides, BAD, procName, "; ");
+        os << "; " << endl;
     }
-    if (!chansBad.empty()) {
+    if (std::count(chanSides.begin(), chanSides.end(), BAD) > 0) {
         os << "// channels in conflict:\n"
             "  node [shape=diamond,peripheries=1," BADSTYLE "];\n  ";
-        for_each(chansBad.begin(), chansBad.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansBad.begin(), chansBad.end(), osi);
-        set_remove(chansR, chansBad);
-        os << endl;
+        printSide(os, chanSides, BAD, chanName, "; ");
+        os << "; " << endl;
     }
-    if (!varsBad.empty()) {
+    if (std::count(varSides.begin(), varSides.end(), BAD) > 0) {
         os << "// variables in conflict:\n"
             "  node [shape=diamond,peripheries=1," BADSTYLE "];\n  ";
-        copy(varsBad.begin(), varsBad.end(), osi);
-        set_remove(varsR, varsBad);
-        os << endl;
+        printSide(os, varSides, BAD, varName, "; ");
+        os << "; " << endl;
     }
 
-    if (!procsIUT.empty()) {
+    if (std::count(procSides.begin(), procSides.end(), IUT) > 0) {
         os << "// IUT processes:\n";
         os << "  node [shape=ellipse,peripheries=1," IUTSTYLE "];\n  ";
-        for (p = procsIUT.begin(), pe = procsIUT.end(); p!=pe; ++p) {
-            os << (*p)->name << "; ";
-            procsR.erase((*p)->name);
-        }
-        os << endl;
+        printSide(os, procSides, IUT, procName, "; ");
+        os << "; " << endl;
     }
-    if (!chansIntIUT.empty()) {
+    if (std::count(chanSides.begin(), chanSides.end(), IUT) > 0) {
         os << "// IUT channels:\n";
         os << "  node [shape=diamond,peripheries=1," IUTSTYLE "];\n  ";
-        for_each(chansIntIUT.begin(), chansIntIUT.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansIntIUT.begin(), chansIntIUT.end(), osi);
-        set_remove(chansR, chansIntIUT);
-        os << endl;
+        printSide(os, chanSides, IUT, chanName, "; ");
+        os << "; " << endl;
     }
-    if (!varsIUT.empty()) {
+    if (std::count(varSides.begin(), varSides.end(), IUT) > 0) {
         os << "// IUT variables:\n";
         os << "  node [shape=rectangle,peripheries=1," IUTSTYLE "];\n  ";
-        copy(varsIUT.begin(), varsIUT.end(), osi);
-        set_remove(varsR, varsIUT);
-        os << endl;
+        printSide(os, varSides, IUT, varName, "; ");
+        os << "; " << endl;
     }
 
     if (!chansOut.empty()) {
         os << "// observable output channels (controlled by IUT):\n"
             "  node [shape=diamond,peripheries=2," IUTSTYLE "];\n  ";
-        for_each(chansOut.begin(), chansOut.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansOut.begin(), chansOut.end(), osi);
-        set_remove(chansR, chansOut);
+        printQuoted(os, chansOut);
         os << endl;
     }
     if (!chansInp.empty()) {
         os << "// observable input channels (controlled by Env):\n"
             "  node [shape=diamond,peripheries=2," ENVSTYLE "];\n  ";
-        for_each(chansInp.begin(), chansInp.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansInp.begin(), chansInp.end(), osi);
-        set_remove(chansR, chansInp);
+        printQuoted(os, chansInp);
         os << endl;
     }
 
-    if (!procsEnv.empty()) {
+    if (std::count(procSides.begin(), procSides.end(), ENV) > 0) {
         os << "// Env processes:\n";
         os << "  node [shape=ellipse,peripheries=1," ENVSTYLE "];\n  ";
-        for (p = procsEnv.begin(), pe = procsEnv.end(); p!=pe; ++p) {
-            os << (*p)->name << "; ";
-            procsR.erase((*p)->name);
-        }
-        os << endl;
+        printSide(os, procSides, ENV, procName, "; ");
+        os << "; " << endl;
     }
-    if (!chansIntEnv.empty()) {
+    if (std::count(chanSides.begin(), chanSides.end(), ENV) > 0) {
         os << "// Env channels:\n";
         os << "  node [shape=diamond,peripheries=1," ENVSTYLE "];\n  ";
-        for_each(chansIntEnv.begin(), chansIntEnv.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansIntEnv.begin(), chansIntEnv.end(), osi);
-        set_remove(chansR, chansIntEnv);
-        os << endl;
+        printSide(os, chanSides, ENV, chanName, "; ");
+        os << "; " << endl;
     }
-    if (!varsEnv.empty()) {
+    if (std::count(varSides.begin(), varSides.end(), ENV) > 0) {
         os << "// Env variables:\n";
         os << "  node [shape=rectangle,peripheries=1," ENVSTYLE "];\n  ";
-        copy(varsEnv.begin(), varsEnv.end(), osi);
-        set_remove(varsR, varsEnv);
-        os << endl;
+        printSide(os, varSides, ENV, varName, "; ");
+        os << "; " << endl;
     }
     os << "// set attributes for non-partitioned procs/chans/vars:\n";
+    std::set<string> procsR; // remaining processes in alphabetical order
+    for (uint32_t p=0; p<procSides.size(); ++p)
+        if (procSides[p] == FREE) procsR.insert(graph.getProcessName(p));
     if (!procsR.empty()) {
         os << "  node [shape=ellipse,peripheries=1," MEDSTYLE "];\n";
-        copy(procsR.begin(), procsR.end(), osi);
+        copy(procsR.begin(), procsR.end(), ostream_iterator<string>(os, "; "));
         os << endl;
     }
-    if (!chansR.empty()) {
+    vector<side_t> chansR(chanSides); // observable channels are printed
+    for (uint32_t c=0; c<chansR.size(); ++c)
+        if (observable[c]) chansR[c] = BAD;
+    if (std::count(chansR.begin(), chansR.end(), FREE) > 0) {
         os << "  node [shape=diamond,peripheries=1," MEDSTYLE "];\n";
-        for_each(chansR.begin(), chansR.end(), 
-                 surround(os, "\"", "\"; "));
-//        copy(chansR.begin(), chansR.end(), osi);
-        os << endl;
+        printSide(os, chansR, FREE, chanName, "; ");
+        os << "; " << endl;
     }
-    if (!varsR.empty()) {
+    if (std::count(varSides.begin(), varSides.end(), FREE) > 0) {
         os << "  node [shape=rectangle,peripheries=1," MEDSTYLE "];\n";
-        copy(varsR.begin(), varsR.end(), osi);
-        os << endl;
+        printSide(os, varSides, FREE, varName, "; ");
+        os << "; " << endl;
     }
 
 
 /* draw variable edges */
-    str2strs_t::const_iterator v2c;
+    uint32_t p, pe = graph.getProcessCount();
     os << "// edges for write to variable:\n"
        << "  edge [style=bold];\n";
-    for (p = procs.begin(), pe = procs.end(); p!=pe; ++p) {
-        if (!(*p)->wtVars.empty()) {
-            for (v2c = (*p)->wtVars.begin(); v2c != (*p)->wtVars.end(); ++v2c){
-                os<<"  "<<(*p)->name<< " -> " << v2c->first << " [label=\"(";
+    for (p = 0; p!=pe; ++p) {
+        for (const uint32_t& v: graph.getTargets(FlowGraph::WRITE, p)) {
+            os<<"  "<<graph.getProcessName(p)<< " -> "
+              << graph.getVariableName(v) << " [label=\"(";
 /* enumerate channels when variable is accessed */
-                for_each(v2c->second.begin(), v2c->second.end(),
-                         print<const char*>(os, ","));
-                os<<")\"];\n";
-            }
+            printLabels(os, FlowGraph::WRITE, &v, ",");
+            os<<")\"];\n";
         }
     }
     os << "// edges for read of variable:\n"
        << "  edge [style=solid];\n";
-    for (p = procs.begin(), pe = procs.end(); p!=pe; ++p) {
-        if (!(*p)->rdVars.empty()) {
-            for (v2c = (*p)->rdVars.begin(); v2c != (*p)->rdVars.end(); ++v2c){
-                os<<"  " << v2c->first << " -> " <<(*p)->name<<" [label=\"(";
+    for (p = 0; p!=pe; ++p) {
+        for (const uint32_t& v: graph.getTargets(FlowGraph::READ, p)) {
+            os<<"  " << graph.getVariableName(v) << " -> "
+              << graph.getProcessName(p) <<" [label=\"(";
 /* enumerate channels when variable is accessed */
-                for_each(v2c->second.begin(), v2c->second.end(),
-                         print<const char*>(os, ","));
-                os<<")\"];\n";
-            }
+            printLabels(os, FlowGraph::READ, &v, ",");
+            os<<")\"];\n";
         }
     }
 
 /* enumerate draw channels */
-    if (!channels.empty())
+    if (graph.getChannelCount() > 0)
     {
-        ;
         if (!cEdge)
         { /* channels displayed as separate nodes (like variables) */
             os << "// channel transmit edges:\n"
                << "  edge [style=bold];\n";
-            for (p = procs.begin(), pe = procs.end(); p!=pe; ++p) {
-                for (strs_t::const_iterator c=(*p)->outChans.begin(),
-                         ce=(*p)->outChans.end(); c!=ce; ++c)
+            for (p = 0; p!=pe; ++p) {
+                for (uint32_t c: graph.getTargets(FlowGraph::SEND, p))
                 {
-                    os << "  " << (*p)->name << " -> \"" << *c << "\";\n";
+                    os << "  " << graph.getProcessName(p) << " -> \""
+                       << graph.getChannelName(c) << "\";\n";
                 }
             }
             os << "// channel receive edges:\n"
                << "  edge [style=solid];\n";
-            for (p = procs.begin(), pe = procs.end(); p!=pe; ++p) {
-                for (strs_t::const_iterator c=(*p)->inChans.begin(),
-                         ce=(*p)->inChans.end(); c!=ce; ++c)
+            for (p = 0; p!=pe; ++p) {
+                for (uint32_t c: graph.getTargets(FlowGraph::RECEIVE, p))
                 {
-                    os << "  \"" << *c << "\" -> " << (*p)->name << ";\n";
+                    os << "  \"" << graph.getChannelName(c) << "\" -> "
+                       << graph.getProcessName(p) << ";\n";
                 }
             }
         } else { /* channels are only on edges */
-            const char* src = "NO_SRC";
-            const char* dst = "NO_DST";
-            /* build an index of outgoing edges sorted by destination TA */
-            for (p = procs.begin(), pe = procs.end(); p!=pe; ++p)
-            {
-                /* traverse all outgoing channels */
-                for (strs_t::const_iterator c=(*p)->outChans.begin(),
-                         ce=(*p)->outChans.end(); c!=ce; ++c)
-                {
-                    str2procs_t::const_iterator dests = receivers.find(*c);
-                    if (dests != receivers.end())
-                    { // there are destinations
-                        for (procs_t::const_iterator rec =
-                                 dests->second.begin();
-                             rec != dests->second.end(); ++rec)
-                        {
-                            (*p)->outEdges[*rec].insert(*c);
-                        }
-                    }
-                    else
-                    { // no destination
-                        (*p)->outEdges[NULL].insert(*c);
-                    }
-                }
-            }
             /* display all edges: */
             bool noDst = false;
             os<<"  edge[style=solid];\n";
-            for (p = procs.begin(), pe = procs.end(); p!=pe; ++p)
+            for (p = 0; p!=pe; ++p)
             {
-                /* display outgoing edges: */
-                for (proc2strs_t::const_iterator edge = (*p)->outEdges.begin();
-                     edge != (*p)->outEdges.end(); ++edge)
-                {
-                    // display edge:
-                    if (edge->first != NULL)
-                    {
-                        //normal destination TA
-                        os<<"  " <<(*p)->name << " -> " << edge->first->name
-                          << " [label=\"[";
-                    }
-                    else
-                    { // there was no destination TA
-                        if (!noDst)
-                        {
-                            os<<"  "<<dst
-                              <<" [style=filled,fillcolor=red];\n";
-                            noDst = true;
-                        }
-                        os<<"  " <<(*p)->name << " -> " << dst
-                          << " [label=\"[";
-                    }
-                    // enumerate all channels on the edge:
-                    strs_t::const_iterator ch=edge->second.begin();
-                    while (true)
-                    {
-                        os<< "\"" << *ch << "\"";
-                        ++ch;
-                        if (ch != edge->second.end())
-                        {
-                            os << ",";
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-                    os << "]\"];\n";
-                }
-                /* by now all inps with sources are displayed as outputs
-                 * search and display inputs w/o sources */
-                bool noSrc = false;
-                for (strs_t::const_iterator c=(*p)->inChans.begin(),
-                         ce=(*p)->inChans.end(); c!=ce; ++c)
-                {
-                    str2procs_t::const_iterator trans = transmitters.find(*c);
-                    if (trans==transmitters.end())
-                    {
-                        if (!noSrc)
-                        {
-                            os<<"  "<<src
-                              <<" [style=filled,fillcolor=red];\n";
-                            noSrc = true;
-                        }
-                        os<<"  "<<src<<" -> " << (*p)->name << " [label=\""
-                          << *c << "\"];\n";
-                    }
-                }
+                printOutEdges(os, graph, p, "\"", noDst);
             }
         }
     }
@@ -1506,194 +1608,76 @@ void Partitioner::printForDot(ostream &os, bool ranked, bool erd, bool cEdge)
 
 void Partitioner::fillWithEnvProcs(strs_t& procs)
 {
-    for (procs_t::const_iterator p=procsEnv.begin(); p!=procsEnv.end(); ++p)
-        procs.insert((*p)->name);
+    for (uint32_t p=0; p<procSides.size(); ++p)
+        if (procSides[p] == ENV) procs.insert(graph.getProcessName(p).c_str());
 }
 
 void Partitioner::fillWithIUTProcs(strs_t& procs)
 {
-    for (procs_t::const_iterator p=procsIUT.begin(); p!=procsIUT.end(); ++p)
-        procs.insert((*p)->name);
+    for (uint32_t p=0; p<procSides.size(); ++p)
+        if (procSides[p] == IUT) procs.insert(graph.getProcessName(p).c_str());
 }
 
-
-void DistanceCalculator::addVariableNeedle(const char* var) 
+DistanceCalculator::DistanceCalculator(const char* _title,
+                                       TimedAutomataSystem& ta,
+                                       unsigned threads):
+    SignalFlow(_title, ta, threads), distancesUpToDate(false),
+    procDistances(graph.getProcessCount()),
+    varDistances(graph.getVariableCount()), taSystem(ta)
 {
-    /* FIXME: find global variable if the variable is local process parameter*/
-    distancesUpToDate = false;
-    const char* dot = strchr(var, '.');
-    size_t length = dot == NULL ? strlen(var) : dot - var;
-    char* name = strncpy(new char[length+1], var, length);
-    name[length] = '\0';
-
-    if (variables.find(name)==variables.end()) {
-        cerr << "Variable not found: " << var << endl;
-        delete [] name;
-        return;
-    }
-    dist_t* distance = NULL;
-    str2dist_t::iterator i = distances.find(name);
-    if (i==distances.end()) {
-        varNeedles.insert(name);
-        distances[name] = dist_t(0, 1, 0);
-        //distance = &distances[name]; // FIXME: work-in-progress.
-    } else {
-        distance = &(i->second);
-        if (distance->hops==0 && distance->distance==0) {
-            /* double the complexity if mentioned several times */
-            distance->complexity = 2 * distance->complexity;
-        } else {
-            distance->hops = 0;
-            distance->distance = 0;
-        }
-        delete [] name; // appearently a copy is in varNeedles
+    /* the complexity of a process is the number of its edges */
+    list<instance_t> &ps(taSystem.getProcesses());
+    for (list<instance_t>::iterator i=ps.begin(), e=ps.end(); i!=e; ++i)
+    {
+        uint32_t p = graph.findProcess(i->uid.getName());
+        procDistances[p].complexity = i->templ->edges.size();
     }
 }
 
-void DistanceCalculator::addProcessNeedle(const char* proc)
+void DistanceCalculator::addNeedle(dist_t& distance)
 {
     distancesUpToDate = false;
-    const char* dot = strchr(proc, '.');
-    size_t length = dot == NULL ? strlen(proc) : dot - proc;
-    char* name = strncpy(new char[length+1], proc, length);
-    name[length] = '\0';
-
-    if (processes.find(name)==processes.end()) {
-        cerr << "AddNeedle: Process not found: " << proc << endl;
-        delete [] name;
-        return;
-    }
-
-    dist_t* distance = NULL;
-    str2dist_t::iterator i = distances.find(name);
-    if (i==distances.end()) {
-        procNeedles.insert(name);
-        distances[name] = dist_t(0, calcComplexity(name), 0);
-        //distance = &distances[name]; // FIXME: work-in-progress.
+    if (distance.isNeedle()) {
+        /* double the complexity if mentioned several times */
+        distance.complexity = 2 * distance.complexity;
     } else {
-        distance = &(i->second);
-        if (distance->hops==0 && distance->distance==0) {
-            /* double the complexity if mentioned several times */
-            distance->complexity = 2 * distance->complexity;
-        } else {
-            distance->hops = 0;
-            distance->distance = 0;
-        }
-        delete [] name; // appearently a copy is in procNeedles
+        distance.hops = 0;
+        distance.distance = 0;
     }
 }
 
-void DistanceCalculator::updateDistancesFromVariable(const char* name, 
-                                                     const dist_t* d)
+void DistanceCalculator::addVariableNeedle(const char* var) 
 {
-    // find all processes that transmit/write on this variable:
-    str2procs_t::const_iterator t = transmitters.find(name);
-    if (t == transmitters.end()) return;
-    for (procs_t::const_iterator p=t->second.begin(),e=t->second.end(); 
-         p!=e; ++p)
-    {
-        dist_t* distance = NULL;
-        str2dist_t::iterator i = distances.find((*p)->name);
-        if (i==distances.end()) {
-            procNeedles.insert(strcpy(new char[strlen((*p)->name)+1], 
-                                      (*p)->name));
-            distances[(*p)->name] = dist_t(d->hops+1, 
-                                           calcComplexity((*p)->name), 
-                                           d->distance + d->complexity);
-            distance = &distances[(*p)->name];
-        } else {
-            distance = &(i->second);
-            if (distance->distance <= d->distance + d->complexity)
-                continue; // old distance is shorter, no changes to propagate
-            else {
-                distance->hops = d->hops+1;
-                distance->distance = d->distance + d->complexity;
-            }
-        }        
-        updateDistancesFromProcess((*p)->name, distance);
+    /* FIXME: find global variable if the variable is local process parameter*/
+    const char* dot = strchr(var, '.');
+    string name(var, dot == NULL ? strlen(var) : dot - var);
+    uint32_t v = graph.findVariable(name);
+    if (v == FlowGraph::none) {
+        cerr << "Variable not found: " << var << endl;
+        return;
     }
+    addNeedle(varDistances[v]);
 }
 
-void DistanceCalculator::updateDistancesFromProcess(const char* name, 
-                                                    const dist_t* d)
+void DistanceCalculator::addProcessNeedle(const char* proc)
 {
-    /* find the process structure representing this process */
-    procs_t::const_iterator s = procs.begin();
-    while (s != procs.end()) 
-        if (strcmp((*s)->name, name)==0) break;
-        else ++s;
-    if (s == procs.end()) {
-        cerr << "UpdateDistancesFromProcess: Process not found: "<<name<<endl;
+    const char* dot = strchr(proc, '.');
+    string name(proc, dot == NULL ? strlen(proc) : dot - proc);
+    uint32_t p = graph.findProcess(name);
+    if (p == FlowGraph::none) {
+        cerr << "AddNeedle: Process not found: " << proc << endl;
         return;
     }
-    /* for each channel the process listens to: */
-    for (strs_t::const_iterator c=(*s)->inChans.begin(),ce=(*s)->inChans.end();
-         c!=ce; ++c) { 
-        /* find all processes that send on this channel: */
-        str2procs_t::const_iterator t = transmitters.find(*c);
-        if (t == transmitters.end()) continue;
-        /* update the distances for each transmitting process */
-        for (procs_t::const_iterator p=t->second.begin(),e=t->second.end(); 
-             p!=e; ++p)
-        {
-            dist_t* distance = NULL;
-            str2dist_t::iterator i = distances.find((*p)->name);
-            if (i==distances.end()) {
-                procNeedles.insert(strcpy(new char[strlen((*p)->name)+1], 
-                                          (*p)->name));
-                distances[(*p)->name] = dist_t(d->hops+1, 
-                                               calcComplexity((*p)->name), 
-                                               d->distance + d->complexity);
-                distance = &distances[(*p)->name];
-            } else {
-                distance = &(i->second);
-                if (distance->distance <= d->distance + d->complexity)
-                    continue; // old distance is shorter no changes to propagate
-                else {
-                    distance->hops = d->hops+1;
-                    distance->distance = d->distance + d->complexity;
-                }
-            }        
-            updateDistancesFromProcess((*p)->name, distance);
-        }        
-    }
-    /* for each variable the process reads from: */
-    for (str2strs_t::const_iterator v=(*s)->rdVars.begin(),
-             ve=(*s)->rdVars.end(); v!=ve; ++v)
-    {
-        dist_t* distance = NULL;
-        str2dist_t::iterator i = distances.find(v->first);
-        if (i==distances.end()) {
-            varNeedles.insert(strcpy(new char[strlen(v->first)+1], v->first));
-            distances[v->first] = dist_t(d->hops+1, 1, 
-                                         d->distance + d->complexity);
-            distance = &distances[v->first];
-        } else {
-            distance = &(i->second);
-            if (distance->distance <= d->distance + d->complexity)
-               continue; // old distance is shorter, no changes to propagate
-            else {
-                distance->hops = d->hops+1;
-                distance->distance = d->distance + d->complexity;
-            }
-        }        
-        updateDistancesFromVariable(v->first, distance);        
-    }
+    addNeedle(procDistances[p]);
 }
 
-int DistanceCalculator::calcComplexity(const char* process)
+void DistanceCalculator::printDistance(std::ostream &os, const dist_t& d)
 {
-    int result = 0;
-    list<instance_t> &ps(taSystem.getProcesses());
-    for (list<instance_t>::iterator i=ps.begin(), e=ps.end(); i!=e; ++i)
-    {
-        if (i->uid.getName()==process) {   
-            const template_t* temp = i->templ;
-            deque<edge_t>::const_iterator t = i->templ->edges.begin();
-            while (t != temp->edges.end()) { result++; t++; }
-        }
+    if (d.distance == INT_MAX) {
+        os << "[label=\"\\N\\n(( ?, ?))\"";
+    } else {
+        os << "[label=\"\\N\\n((" << d.hops <<", "<< d.distance <<"))\"";
     }
-    return result;
 }
 
 void DistanceCalculator::printProcsForDot(std::ostream &os, bool erd)
@@ -1710,15 +1694,11 @@ void DistanceCalculator::printProcsForDot(std::ostream &os, bool erd)
     }
     os << "    ";
     
-    for (procs_t::const_iterator p=procs.begin(), e=procs.end(); p!=e; ++p)
+    for (uint32_t p=0; p<graph.getProcessCount(); ++p)
     {
-        str2dist_t::const_iterator d = distances.find((*p)->name);
-        if (d==distances.end()) {
-            os << (*p)->name << "[label=\"\\N\\n(( ?, ?))\"]; ";
-        } else {
-            os << (*p)->name << "[label=\"\\N\\n((" << d->second.hops 
-               <<", "<< d->second.distance <<"))\"]; ";
-        }
+        os << graph.getProcessName(p);
+        printDistance(os, procDistances[p]);
+        os << "]; ";
     }
     os << "\n  }\n";
 }
@@ -1742,43 +1722,28 @@ void DistanceCalculator::printVarsForDot(std::ostream &os, bool ranked,
     {
         os << "    node [shape=rectangle,color=blue];\n    ";
     }
-    for (strs_t::const_iterator i=variables.begin(), e=variables.end(); 
-         i!=e; ++i)
+    for (uint32_t v=0; v<graph.getVariableCount(); ++v)
     {
-        str2dist_t::const_iterator d = distances.find(*i);
-        if (d==distances.end()) {
-            os << *i << "[label=\"\\N\\n(( ?, ?))\"";
-        } else {
-            os << *i << "[label=\"\\N\\n((" << d->second.hops 
-               <<", "<< d->second.distance <<"))\"";
-        }
-        if (transmitters.find(*i) == transmitters.end()) os << "]; "; // const
-        else os << ",style=bold]; "; // others bold
+        os << graph.getVariableName(v);
+        printDistance(os, varDistances[v]);
+        if (graph.getSources(FlowGraph::WRITE, v).empty())
+            os << "]; "; // const
+        else
+            os << ",style=bold]; "; // others bold
     }
     os << "\n  }\n";
 }
 
-DistanceCalculator::~DistanceCalculator()
-{
-    for(strs_t::iterator i=varNeedles.begin(),e=varNeedles.end(); i!=e; ++i)
-        delete [] (*i);
-    varNeedles.clear();
-
-    for(strs_t::iterator i=procNeedles.begin(),e=procNeedles.end(); i!=e; ++i)
-        delete [] (*i);
-    procNeedles.clear();
-}
-
 uint32_t DistanceCalculator::getDistance(const char* element)
 {
     if (!distancesUpToDate) updateDistances();
 
-    str2dist_t::iterator f = distances.find(element);
-    if (f == distances.end()) {
-        //cerr << "GetDistance: Process not found: " << element << endl;
-        return INT_MAX;
-    }
-    return f->second.distance;
+    uint32_t p = graph.findProcess(element);
+    if (p != FlowGraph::none) return procDistances[p].distance;
+    uint32_t v = graph.findVariable(element);
+    if (v != FlowGraph::none) return varDistances[v].distance;
+    //cerr << "GetDistance: Process not found: " << element << endl;
+    return INT_MAX;
 }
 
 void DistanceCalculator::printForDot(ostream &os, bool ranked, bool erd, 
@@ -1789,39 +1754,64 @@ void DistanceCalculator::printForDot(ostream &os, bool ranked, bool erd,
     SignalFlow::printForDot(os, ranked, erd, cEdged);
 }
 
+/**
+ * Computes the distances from all needles at once by Dijkstra's
+ * algorithm. A process is reached from the processes listening to its
+ * output channels and from the processes reading the variables it
+ * writes, and a variable from the processes writing it. Leaving a node
+ * costs its complexity. Among paths of equal distance the one with
+ * fewer hops is preferred.
+ */
 void DistanceCalculator::updateDistances()
 {
+    /* nodes are the processes followed by the variables */
+    const uint32_t procs = procDistances.size();
+    auto node = [&](uint32_t n) -> dist_t& {
+        return n < procs ? procDistances[n] : varDistances[n - procs];
+    };
+    /* queue of (distance, hops, node) with the shortest distance on top */
+    typedef std::tuple<uint32_t, uint32_t, uint32_t> entry_t;
+    std::priority_queue<entry_t, vector<entry_t>, std::greater<entry_t> > queue;
+
     /* cleanup the old stuff: put all distances at infinity=INT_MAX: */
-    for (str2dist_t::iterator i=distances.begin(), e=distances.end(); 
-         i!=e; ++i)
+    for (uint32_t n=0; n<procs+varDistances.size(); ++n)
     {
-        if (i->second.hops>0) {
-            i->second.hops = INT_MAX;
-            i->second.distance = INT_MAX;
-        }
-    }
-    /* calculate distances from variable needles: */
-    for(strs_t::iterator i=varNeedles.begin(),e=varNeedles.end(); 
-        i!=e; ++i) 
-    {
-        str2dist_t::iterator f = distances.find(*i);
-        if (f == distances.end()) {
-            cerr << "Variable not found: " << *i << endl;
-            exit(EXIT_FAILURE);
-        }
-        updateDistancesFromVariable(*i, &(f->second));
+        dist_t& d = node(n);
+        if (d.isNeedle()) queue.emplace(0, 0, n);
+        else d.hops = d.distance = INT_MAX;
     }
-    /* calculate distances from process needles: */
-    for(strs_t::iterator i=procNeedles.begin(),e=procNeedles.end(); 
-        i!=e; ++i)
+    while (!queue.empty())
     {
-        str2dist_t::iterator f = distances.find(*i);
-        if (f == distances.end()) {
-            cerr << "Process not found: " << *i << endl;
-            exit(EXIT_FAILURE);
+        uint32_t distance, hops, n;
+        std::tie(distance, hops, n) = queue.top();
+        queue.pop();
+        const dist_t& d = node(n);
+        if (d.distance != distance || d.hops != hops)
+            continue; // a shorter distance was found meanwhile
+        distance += d.complexity;
+        ++hops;
+        auto shorten = [&](uint32_t m) {
+            dist_t& to = node(m);
+            if (distance < to.distance
+                || (distance == to.distance && hops < to.hops)) {
+                to.distance = distance;
+                to.hops = hops;
+                queue.emplace(distance, hops, m);
+            }
+        };
+        if (n < procs) {
+            /* processes sending on the channels the process listens to */
+            for (uint32_t c: graph.getTargets(FlowGraph::RECEIVE, n))
+                for (uint32_t p: graph.getSources(FlowGraph::SEND, c))
+                    shorten(p);
+            /* variables the process reads from */
+            for (uint32_t v: graph.getTargets(FlowGraph::READ, n))
+                shorten(procs + v);
+        } else {
+            /* processes writing the variable */
+            for (uint32_t p: graph.getSources(FlowGraph::WRITE, n - procs))
+                shorten(p);
         }
-        updateDistancesFromProcess(*i, &(f->second));
     }
     distancesUpToDate = true;
 }
-
@@ -0,0 +1,1391 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/slicer.h"
+#include "utap/expressionbuilder.h"
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <map>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::deque;
+using std::list;
+using std::map;
+using std::ostream;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace
+{
+    /**
+     * Builds the expressions of properties without modifying the
+     * system: errors are recorded locally and positions are not
+     * stored.
+     */
+    class PropertyCollector : public ExpressionBuilder
+    {
+    public:
+        vector<expression_t> properties;
+        bool failed;
+
+        PropertyCollector(TimedAutomataSystem *system)
+            : ExpressionBuilder(system), failed(false) {}
+
+        void addPosition(uint32_t, uint32_t, uint32_t,
+                         const string&) override {}
+        void handleError(const string&) override { failed = true; }
+        void handleWarning(const string&) override {}
+        void property() override
+        {
+            properties.push_back(fragments[0]);
+            fragments.pop();
+        }
+    };
+
+    /** Returns true if the expression uses the deadlock keyword. */
+    bool usesDeadlock(expression_t expr)
+    {
+        if (expr.empty())
+        {
+            return false;
+        }
+        if (expr.getKind() == DEADLOCK)
+        {
+            return true;
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+        {
+            if (usesDeadlock(expr[i]))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Adds the symbols read by the arguments bound to any parameter
+     * in \a symbols, i.e. maps template symbols to process symbols.
+     */
+    void resolveArguments(const instance_t &process, set<symbol_t> &symbols)
+    {
+        set<symbol_t> arguments;
+        for (auto& arg: process.mapping)
+        {
+            if (symbols.find(arg.first) != symbols.end())
+            {
+                arg.second.collectPossibleReads(arguments);
+            }
+        }
+        symbols.insert(arguments.begin(), arguments.end());
+    }
+
+    /**
+     * Collects the symbols used by a property. Contrary to
+     * collectPossibleReads(), references to process local symbols
+     * (P.x) resolve to the symbol of the template.
+     */
+    void collectPropertySymbols(expression_t expr, set<symbol_t> &symbols)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        if (expr.getKind() == DOT && expr[0].getType().isProcess())
+        {
+            symbol_t process = expr[0].getSymbol();
+            instance_t *instance = static_cast<instance_t*>(process.getData());
+            symbols.insert(process);
+            if (instance && expr.getIndex() >= 0
+                && (uint32_t)expr.getIndex() < instance->templ->frame.getSize())
+            {
+                symbols.insert(instance->templ->frame[expr.getIndex()]);
+            }
+            return;
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+        {
+            collectPropertySymbols(expr[i], symbols);
+        }
+        if (expr.getKind() == IDENTIFIER)
+        {
+            symbols.insert(expr.getSymbol());
+        }
+        else if (expr.getKind() == FUNCALL)
+        {
+            expr.collectPossibleReads(symbols);
+        }
+    }
+
+    /** Collects every symbol used in the body of a function. */
+    void collectBody(function_t *fun, set<symbol_t> &symbols)
+    {
+        CollectDependenciesVisitor visitor(symbols);
+        fun->body->accept(&visitor);
+    }
+
+    /**
+     * Collects every symbol used by a template: parameters,
+     * initialisers, function bodies, invariants and edges.
+     */
+    void collectTemplate(template_t &templ, set<symbol_t> &symbols)
+    {
+        for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+        {
+            symbols.insert(templ.parameters[i]);
+        }
+        for (auto& variable: templ.variables)
+        {
+            variable.expr.collectPossibleReads(symbols);
+        }
+        for (auto& fun: templ.functions)
+        {
+            collectBody(&fun, symbols);
+        }
+        for (auto& state: templ.states)
+        {
+            state.invariant.collectPossibleReads(symbols);
+            state.exponentialRate.collectPossibleReads(symbols);
+            state.costRate.collectPossibleReads(symbols);
+        }
+        for (auto& edge: templ.edges)
+        {
+            edge.guard.collectPossibleReads(symbols);
+            edge.sync.collectPossibleReads(symbols);
+            edge.assign.collectPossibleReads(symbols);
+#ifdef ENABLE_PROB
+            edge.prob.collectPossibleReads(symbols);
+#endif
+        }
+        for (auto& message: templ.messages)
+        {
+            message.label.collectPossibleReads(symbols);
+        }
+        for (auto& condition: templ.conditions)
+        {
+            condition.label.collectPossibleReads(symbols);
+        }
+        for (auto& update: templ.updates)
+        {
+            update.label.collectPossibleReads(symbols);
+        }
+    }
+
+    /**
+     * Collects the symbols used outside of templates: process
+     * arguments unless \a arguments is false, priorities, progress
+     * measures, I/O declarations, Gantt charts and the before/after
+     * update expressions.
+     */
+    void collectSystem(TimedAutomataSystem &system, set<symbol_t> &symbols,
+                       bool arguments = true)
+    {
+        for (auto& process: system.getProcesses())
+        {
+            for (auto& arg: process.mapping)
+            {
+                if (arguments)
+                {
+                    arg.second.collectPossibleReads(symbols);
+                }
+            }
+        }
+        for (auto& priority: system.getChanPriorities())
+        {
+            priority.head.collectPossibleReads(symbols);
+            for (auto& entry: priority.tail)
+            {
+                entry.second.collectPossibleReads(symbols);
+            }
+        }
+        declarations_t &globals = system.getGlobals();
+        for (auto& progress: globals.progress)
+        {
+            progress.guard.collectPossibleReads(symbols);
+            progress.measure.collectPossibleReads(symbols);
+        }
+        for (auto& iodecl: globals.iodecl)
+        {
+            for (auto& param: iodecl.param)
+            {
+                param.collectPossibleReads(symbols);
+            }
+            for (auto& e: iodecl.inputs)
+            {
+                e.collectPossibleReads(symbols);
+            }
+            for (auto& e: iodecl.outputs)
+            {
+                e.collectPossibleReads(symbols);
+            }
+            for (auto& e: iodecl.csp)
+            {
+                e.collectPossibleReads(symbols);
+            }
+        }
+        for (auto& gantt: globals.ganttChart)
+        {
+            for (auto& map: gantt.mapping)
+            {
+                map.predicate.collectPossibleReads(symbols);
+                map.mapping.collectPossibleReads(symbols);
+            }
+        }
+        system.getBeforeUpdate().collectPossibleReads(symbols);
+        system.getAfterUpdate().collectPossibleReads(symbols);
+    }
+
+    /**
+     * Returns true if all writes of \a expr are in \a dead. A
+     * function call without side effects writes nothing and is dead
+     * as well.
+     */
+    bool writesOnly(expression_t expr, const set<symbol_t> &dead)
+    {
+        set<symbol_t> writes;
+        expr.collectPossibleWrites(writes);
+        if (writes.empty())
+        {
+            return expr.getKind() == FUNCALL;
+        }
+        for (auto& symbol: writes)
+        {
+            if (dead.find(symbol) == dead.end())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Removes the assignments of a comma separated update, which
+     * only write to symbols in \a dead. Returns the empty expression
+     * if nothing is left.
+     */
+    expression_t sliceUpdate(expression_t expr, const set<symbol_t> &dead,
+                             size_t &removed)
+    {
+        if (expr.empty())
+        {
+            return expr;
+        }
+        if (expr.getKind() == COMMA)
+        {
+            expression_t left = sliceUpdate(expr[0], dead, removed);
+            expression_t right = sliceUpdate(expr[1], dead, removed);
+            if (left.empty())
+            {
+                return right;
+            }
+            if (right.empty())
+            {
+                return left;
+            }
+            if (left == expr[0] && right == expr[1])
+            {
+                return expr;
+            }
+            return expression_t::createBinary(
+                COMMA, left, right, expr.getPosition(), right.getType());
+        }
+        if (writesOnly(expr, dead))
+        {
+            ++removed;
+            return expression_t();
+        }
+        return expr;
+    }
+
+    /**
+     * Removes expression statements from a function body which only
+     * write to symbols in \a dead.
+     */
+    class DeadStoreRemover : public AbstractStatementVisitor
+    {
+    private:
+        const set<symbol_t> &dead;
+        size_t &removed;
+
+        void slice(Statement *&stat)
+        {
+            ExprStatement *expr = dynamic_cast<ExprStatement*>(stat);
+            if (expr == nullptr)
+            {
+                stat->accept(this);
+            }
+            else
+            {
+                expr->expr = sliceUpdate(expr->expr, dead, removed);
+                if (expr->expr.empty())
+                {
+                    delete stat;
+                    stat = new EmptyStatement();
+                }
+            }
+        }
+    public:
+        DeadStoreRemover(const set<symbol_t> &dead, size_t &removed)
+            : dead(dead), removed(removed) {}
+
+        int32_t visitForStatement(ForStatement *stat) override
+        {
+            slice(stat->stat);
+            return 0;
+        }
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            slice(stat->stat);
+            return 0;
+        }
+        int32_t visitWhileStatement(WhileStatement *stat) override
+        {
+            slice(stat->stat);
+            return 0;
+        }
+        int32_t visitDoWhileStatement(DoWhileStatement *stat) override
+        {
+            slice(stat->stat);
+            return 0;
+        }
+        int32_t visitBlockStatement(BlockStatement *stat) override
+        {
+            for (auto i = stat->begin(); i != stat->end(); ++i)
+            {
+                slice(*i);
+            }
+            return 0;
+        }
+        int32_t visitIfStatement(IfStatement *stat) override
+        {
+            slice(stat->trueCase);
+            if (stat->falseCase)
+            {
+                slice(stat->falseCase);
+            }
+            return 0;
+        }
+    };
+
+    /**
+     * Recomputes the symbols changed and used by a function the same
+     * way as the type checker does.
+     */
+    void collectSideEffects(function_t &fun)
+    {
+        fun.changes.clear();
+        fun.depends.clear();
+        CollectChangesVisitor visitor(fun.changes);
+        fun.body->accept(&visitor);
+        CollectDependenciesVisitor visitor2(fun.depends);
+        fun.body->accept(&visitor2);
+        for (auto& variable: fun.variables)
+        {
+            fun.changes.erase(variable.uid);
+            fun.depends.erase(variable.uid);
+        }
+        size_t parameters = fun.uid.getType().size() - 1;
+        for (size_t i = 0; i < parameters; i++)
+        {
+            fun.changes.erase(fun.body->getFrame()[i]);
+            fun.depends.erase(fun.body->getFrame()[i]);
+        }
+    }
+
+    /**
+     * Collects the symbols whose value is read by an expression.
+     * Unlike collectPossibleReads(), the target of a plain assignment
+     * is not a read and a function call reads the function symbol
+     * rather than everything the function depends on.
+     */
+    void collectReads(expression_t expr, set<symbol_t> &reads)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        switch (expr.getKind())
+        {
+        case IDENTIFIER:
+            reads.insert(expr.getSymbol());
+            break;
+        case FUNCALL:
+            reads.insert(expr[0].getSymbol());
+            for (uint32_t i = 1; i < expr.getSize(); ++i)
+            {
+                collectReads(expr[i], reads);
+            }
+            break;
+        case ASSIGN:
+            if (expr[0].getKind() != IDENTIFIER)
+            {
+                collectReads(expr[0], reads);
+            }
+            collectReads(expr[1], reads);
+            break;
+        default:
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+            {
+                collectReads(expr[i], reads);
+            }
+        }
+    }
+
+    /**
+     * An assignment of an update or a function body together with
+     * its reads. Units of a function only matter once the function
+     * is relevant. Control units (conditions, return values) have no
+     * writes and are live as soon as their function is.
+     */
+    struct unit_t
+    {
+        symbol_t owner;
+        set<symbol_t> writes;
+        set<symbol_t> reads;
+        bool control;
+        bool live;
+    };
+
+    void collectUnits(expression_t expr, symbol_t owner, bool control,
+                      list<unit_t> &units)
+    {
+        if (expr.empty())
+        {
+            return;
+        }
+        if (expr.getKind() == COMMA)
+        {
+            collectUnits(expr[0], owner, control, units);
+            collectUnits(expr[1], owner, control, units);
+        }
+        else
+        {
+            units.push_back(unit_t());
+            unit_t &unit = units.back();
+            unit.owner = owner;
+            unit.control = control;
+            unit.live = false;
+            if (!control)
+            {
+                expr.collectPossibleWrites(unit.writes);
+            }
+            collectReads(expr, unit.reads);
+        }
+    }
+
+    /**
+     * Splits a function body into units: expression statements are
+     * assignments, every other expression is control.
+     */
+    class UnitCollector : public ExpressionVisitor
+    {
+    private:
+        symbol_t owner;
+        list<unit_t> &units;
+    protected:
+        void visitExpression(expression_t expr) override
+        {
+            collectUnits(expr, owner, true, units);
+        }
+    public:
+        UnitCollector(symbol_t owner, list<unit_t> &units)
+            : owner(owner), units(units) {}
+
+        int32_t visitExprStatement(ExprStatement *stat) override
+        {
+            collectUnits(stat->expr, owner, false, units);
+            return 0;
+        }
+    };
+
+    void collectUnits(function_t &fun, list<unit_t> &units)
+    {
+        UnitCollector collector(fun.uid, units);
+        fun.body->accept(&collector);
+    }
+
+    bool intersects(const set<symbol_t> &a, const set<symbol_t> &b)
+    {
+        for (auto& symbol: a)
+        {
+            if (b.find(symbol) != b.end())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Returns the channel or array of channels a synchronisation of
+     * \a process uses, or the empty symbol if it is not known.
+     */
+    symbol_t resolveChannel(const instance_t &process, expression_t chan)
+    {
+        while (chan.getKind() == ARRAY)
+        {
+            chan = chan[0];
+        }
+        if (chan.getKind() != IDENTIFIER)
+        {
+            return symbol_t();
+        }
+        auto arg = process.mapping.find(chan.getSymbol());
+        if (arg != process.mapping.end())
+        {
+            return resolveChannel(process, arg->second);
+        }
+        return chan.getSymbol();
+    }
+
+    /** Returns true if the channels may overlap; the empty symbol is any. */
+    bool sharesChannel(const set<symbol_t> &a, const set<symbol_t> &b)
+    {
+        return intersects(a, b) || (!a.empty() && b.count(symbol_t()))
+            || (!b.empty() && a.count(symbol_t()));
+    }
+}
+
+Slicer::Slicer(TimedAutomataSystem &system)
+    : system(system), deadlockQueried(false),
+      removedEdges(0), removedAssignments(0)
+{
+}
+
+const vector<string> &Slicer::getRemovedProcesses() const
+{
+    return removedProcesses;
+}
+
+const vector<string> &Slicer::getRemovedVariables() const
+{
+    return removedVariables;
+}
+
+const vector<string> &Slicer::getRemovedFunctions() const
+{
+    return removedFunctions;
+}
+
+const vector<string> &Slicer::getRemovedLocations() const
+{
+    return removedLocations;
+}
+
+bool Slicer::collectQueries()
+{
+    for (auto& query: system.getQueries())
+    {
+        if (query.formula.empty())
+        {
+            continue;
+        }
+        PropertyCollector collector(&system);
+        try
+        {
+            parseProperty(query.formula.c_str(), &collector);
+        }
+        catch (std::exception &)
+        {
+            collector.failed = true;
+        }
+        if (collector.failed)
+        {
+            return false;
+        }
+        for (auto& property: collector.properties)
+        {
+            collectPropertySymbols(property, queried);
+            deadlockQueried |= usesDeadlock(property);
+        }
+    }
+    return true;
+}
+
+void Slicer::collectRemovable()
+{
+    for (auto& process: system.getProcesses())
+    {
+        sliced.insert(process.templ);
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        sliced.erase(templ);
+    }
+
+    for (auto& variable: system.getGlobals().variables)
+    {
+        type_t type = variable.uid.getType();
+        if (!type.isConstant() && !type.is(COST)
+            && !system.isReferenceClock(variable.uid))
+        {
+            removable.insert(variable.uid);
+        }
+    }
+    for (auto& fun: system.getGlobals().functions)
+    {
+        removable.insert(fun.uid);
+    }
+    for (auto& templ: system.getTemplates())
+    {
+        if (!templ.isTA)
+        {
+            sliced.erase(&templ);
+        }
+        if (sliced.find(&templ) == sliced.end())
+        {
+            continue;
+        }
+        for (auto& variable: templ.variables)
+        {
+            if (!variable.uid.getType().isConstant())
+            {
+                removable.insert(variable.uid);
+            }
+        }
+        for (auto& fun: templ.functions)
+        {
+            removable.insert(fun.uid);
+        }
+    }
+}
+
+void Slicer::resolveChannels(template_t &templ, expression_t sync,
+                             set<symbol_t> &chans) const
+{
+    expression_t chan = sync;
+    while (chan.getKind() == ARRAY)
+    {
+        chan = chan[0];
+    }
+    if (chan.getKind() != IDENTIFIER)
+    {
+        chans.insert(symbol_t()); // unknown channel
+        return;
+    }
+    symbol_t symbol = chan.getSymbol();
+    if (templ.parameters.getIndexOf(symbol) == -1)
+    {
+        chans.insert(symbol);
+        return;
+    }
+    /* Channel parameter: resolve it through the arguments of all
+     * processes instantiated from the template.
+     */
+    for (auto& process: system.getProcesses())
+    {
+        if (process.templ == &templ)
+        {
+            auto arg = process.mapping.find(symbol);
+            if (arg == process.mapping.end())
+            {
+                chans.insert(symbol_t());
+            }
+            else
+            {
+                resolveChannels(templ, arg->second, chans);
+            }
+        }
+    }
+}
+
+void Slicer::collectChannels(template_t &templ)
+{
+    for (auto& edge: templ.edges)
+    {
+        if (edge.sync.empty())
+        {
+            continue;
+        }
+        set<symbol_t> chans;
+        resolveChannels(templ, edge.sync[0], chans);
+        switch (edge.sync.getSync())
+        {
+        case SYNC_BANG:
+            sendChans.insert(chans.begin(), chans.end());
+            break;
+        case SYNC_QUE:
+            recvChans.insert(chans.begin(), chans.end());
+            break;
+        case SYNC_CSP:
+            sendChans.insert(chans.begin(), chans.end());
+            recvChans.insert(chans.begin(), chans.end());
+            break;
+        }
+    }
+}
+
+bool Slicer::isDisabled(template_t &templ, const edge_t &edge) const
+{
+    if (edge.guard.getKind() == CONSTANT && edge.guard.getValue() == 0)
+    {
+        return true;
+    }
+    if (edge.sync.empty() || edge.sync.getSync() == SYNC_CSP)
+    {
+        return false;
+    }
+    set<symbol_t> chans;
+    resolveChannels(templ, edge.sync[0], chans);
+    for (auto& chan: chans)
+    {
+        if (chan == symbol_t())
+        {
+            return false;
+        }
+        if (edge.sync.getSync() == SYNC_BANG)
+        {
+            if (chan.getType().is(BROADCAST)
+                || recvChans.find(chan) != recvChans.end())
+            {
+                return false;
+            }
+        }
+        else if (sendChans.find(chan) != sendChans.end())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Slicer::removeUnreachable(template_t &templ)
+{
+    if (!templ.branchpoints.empty())
+    {
+        return; // keep it simple, branchpoints are rare
+    }
+
+    /* Explore the template graph from the initial location.
+     */
+    set<const state_t*> reached;
+    deque<const state_t*> waiting;
+    vector<bool> enabled(templ.edges.size());
+    for (size_t i = 0; i < templ.edges.size(); ++i)
+    {
+        enabled[i] = !isDisabled(templ, templ.edges[i]);
+    }
+    waiting.push_back(static_cast<const state_t*>(templ.init.getData()));
+    reached.insert(waiting.back());
+    while (!waiting.empty())
+    {
+        const state_t *state = waiting.front();
+        waiting.pop_front();
+        for (size_t i = 0; i < templ.edges.size(); ++i)
+        {
+            const edge_t &edge = templ.edges[i];
+            if (enabled[i] && edge.src == state
+                && reached.insert(edge.dst).second)
+            {
+                waiting.push_back(edge.dst);
+            }
+        }
+    }
+
+    /* Remove edges. Remember the end points by symbol, since
+     * erasing from a deque invalidates the pointers to locations.
+     */
+    deque<edge_t> edges;
+    vector<std::pair<symbol_t, symbol_t>> ends;
+    for (size_t i = 0; i < templ.edges.size(); ++i)
+    {
+        edge_t &edge = templ.edges[i];
+        if (enabled[i] && reached.find(edge.src) != reached.end())
+        {
+            edges.push_back(edge);
+            edges.back().nr = edges.size() - 1;
+            ends.emplace_back(edge.src->uid, edge.dst->uid);
+        }
+        else
+        {
+            ++removedEdges;
+        }
+    }
+    templ.edges.swap(edges);
+
+    /* Remove locations, but keep those mentioned by queries.
+     */
+    deque<state_t> states;
+    set<symbol_t> removed;
+    for (auto& state: templ.states)
+    {
+        if (reached.find(&state) != reached.end()
+            || queried.find(state.uid) != queried.end())
+        {
+            states.push_back(state);
+        }
+        else
+        {
+            removedLocations.push_back(
+                templ.uid.getName() + "." + state.uid.getName());
+            removed.insert(state.uid);
+        }
+    }
+    templ.frame.remove(removed);
+    templ.states.swap(states);
+    for (size_t i = 0; i < templ.states.size(); ++i)
+    {
+        templ.states[i].locNr = i;
+        templ.states[i].uid.setData(&templ.states[i]);
+    }
+    for (size_t i = 0; i < templ.edges.size(); ++i)
+    {
+        templ.edges[i].src = static_cast<state_t*>(ends[i].first.getData());
+        templ.edges[i].dst = static_cast<state_t*>(ends[i].second.getData());
+    }
+}
+
+void Slicer::computeRelevant()
+{
+    relevant.insert(queried.begin(), queried.end());
+    collectSystem(system, relevant);
+
+    list<unit_t> units;
+    auto addFunctions = [&](declarations_t &decls) {
+        for (auto& fun: decls.functions)
+        {
+            collectUnits(fun, units);
+            /* Writes to reference parameters are visible to the
+             * caller, thus we conservatively keep them.
+             */
+            size_t parameters = fun.uid.getType().size() - 1;
+            for (size_t i = 0; i < parameters; i++)
+            {
+                symbol_t param = fun.body->getFrame()[i];
+                if (param.getType().is(REF))
+                {
+                    relevant.insert(param);
+                }
+            }
+        }
+    };
+    addFunctions(system.getGlobals());
+    for (auto& templ: system.getTemplates())
+    {
+        if (sliced.find(&templ) == sliced.end())
+        {
+            /* Templates without processes do not influence anything.
+             */
+            if (!templ.isTA)
+            {
+                collectTemplate(templ, relevant);
+            }
+            continue;
+        }
+        addFunctions(templ);
+        for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+        {
+            relevant.insert(templ.parameters[i]);
+        }
+        for (auto& state: templ.states)
+        {
+            collectReads(state.invariant, relevant);
+            collectReads(state.exponentialRate, relevant);
+            collectReads(state.costRate, relevant);
+        }
+        for (auto& edge: templ.edges)
+        {
+            collectReads(edge.guard, relevant);
+            collectReads(edge.sync, relevant);
+#ifdef ENABLE_PROB
+            collectReads(edge.prob, relevant);
+#endif
+            collectUnits(edge.assign, symbol_t(), false, units);
+        }
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        collectTemplate(*templ, relevant);
+    }
+
+    /* Variables are relevant if they are used to compute the value
+     * of another relevant variable.
+     */
+    set<symbol_t> initialised;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& unit: units)
+        {
+            if (unit.live)
+            {
+                continue;
+            }
+            if (unit.owner != symbol_t()
+                && relevant.find(unit.owner) == relevant.end())
+            {
+                continue;
+            }
+            if (unit.control || intersects(unit.writes, relevant))
+            {
+                unit.live = true;
+                changed = true;
+                relevant.insert(unit.reads.begin(), unit.reads.end());
+            }
+        }
+        set<symbol_t> symbols(relevant);
+        for (auto symbol: symbols)
+        {
+            if (removable.find(symbol) != removable.end()
+                && !symbol.getType().isFunction()
+                && initialised.insert(symbol).second)
+            {
+                size_t size = relevant.size();
+                variable_t *variable = static_cast<variable_t*>(symbol.getData());
+                collectReads(variable->expr, relevant);
+                changed |= size != relevant.size();
+            }
+        }
+    }
+}
+
+void Slicer::removeUnreferenced()
+{
+    /* Collect the symbols referenced by what is left of the system.
+     */
+    set<symbol_t> referenced(queried);
+    collectSystem(system, referenced);
+    for (auto& templ: system.getTemplates())
+    {
+        if (sliced.find(&templ) == sliced.end())
+        {
+            collectTemplate(templ, referenced);
+            continue;
+        }
+        for (auto& state: templ.states)
+        {
+            state.invariant.collectPossibleReads(referenced);
+            state.exponentialRate.collectPossibleReads(referenced);
+            state.costRate.collectPossibleReads(referenced);
+        }
+        for (auto& edge: templ.edges)
+        {
+            edge.guard.collectPossibleReads(referenced);
+            edge.sync.collectPossibleReads(referenced);
+            edge.assign.collectPossibleReads(referenced);
+#ifdef ENABLE_PROB
+            edge.prob.collectPossibleReads(referenced);
+#endif
+        }
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        collectTemplate(*templ, referenced);
+    }
+    for (auto& variable: system.getGlobals().variables)
+    {
+        if (removable.find(variable.uid) == removable.end())
+        {
+            variable.expr.collectPossibleReads(referenced);
+        }
+    }
+
+    /* Follow references into function bodies and initialisers of
+     * removable declarations.
+     */
+    set<symbol_t> visited;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        set<symbol_t> symbols(referenced);
+        for (auto symbol: symbols)
+        {
+            if (removable.find(symbol) == removable.end()
+                || !visited.insert(symbol).second)
+            {
+                continue;
+            }
+            if (symbol.getType().isFunction())
+            {
+                collectBody(static_cast<function_t*>(symbol.getData()),
+                            referenced);
+            }
+            else
+            {
+                static_cast<variable_t*>(symbol.getData())->expr
+                    .collectPossibleReads(referenced);
+            }
+            changed = true;
+        }
+    }
+
+    /* Remove unreferenced declarations.
+     */
+    auto removeFrom = [&](declarations_t &decls, const string &prefix) {
+        set<symbol_t> removed;
+        for (auto v = decls.variables.begin(); v != decls.variables.end();)
+        {
+            if (removable.find(v->uid) != removable.end()
+                && referenced.find(v->uid) == referenced.end())
+            {
+                removedVariables.push_back(prefix + v->uid.getName());
+                removed.insert(v->uid);
+                v = decls.variables.erase(v);
+            }
+            else
+            {
+                ++v;
+            }
+        }
+        for (auto f = decls.functions.begin(); f != decls.functions.end();)
+        {
+            if (removable.find(f->uid) != removable.end()
+                && referenced.find(f->uid) == referenced.end())
+            {
+                removedFunctions.push_back(prefix + f->uid.getName());
+                removed.insert(f->uid);
+                f = decls.functions.erase(f);
+            }
+            else
+            {
+                ++f;
+            }
+        }
+        decls.frame.remove(removed);
+    };
+    removeFrom(system.getGlobals(), "");
+    for (auto& templ: system.getTemplates())
+    {
+        if (sliced.find(&templ) != sliced.end())
+        {
+            removeFrom(templ, templ.uid.getName() + ".");
+        }
+    }
+}
+
+void Slicer::removeIndependentProcesses()
+{
+    if (deadlockQueried || system.hasPriorityDeclaration())
+    {
+        return;
+    }
+
+    struct info_t
+    {
+        instance_t *process;
+        set<symbol_t> reads;    // by guards, invariants, syncs and arguments
+        set<symbol_t> writes;   // by updates, resolved to the arguments
+        list<unit_t> units;     // the assignments of updates and functions
+        set<symbol_t> affects;  // channels restricting other processes
+        set<symbol_t> affected; // channels restricted by other processes
+        bool kept;
+        bool added;             // reads and channels joined the cone
+    };
+    vector<info_t> infos;
+    set<symbol_t> relevant(queried), affected;
+    collectSystem(system, relevant, false);
+    set<template_t*> dynamic(system.getDynamicTemplates().begin(),
+                             system.getDynamicTemplates().end());
+
+    list<unit_t> globalUnits;
+    for (auto& fun: system.getGlobals().functions)
+    {
+        collectUnits(fun, globalUnits);
+    }
+
+    for (auto& process: system.getProcesses())
+    {
+        template_t &templ = *process.templ;
+        infos.push_back(info_t());
+        info_t &info = infos.back();
+        info.process = &process;
+        info.added = false;
+        info.kept = process.unbound > 0 || !templ.isTA
+            || dynamic.find(&templ) != dynamic.end()
+            || !templ.branchpoints.empty()
+            || queried.find(process.uid) != queried.end();
+
+        /* Invariants, urgent and committed locations restrict the
+         * behaviour of all other processes.
+         */
+        for (auto& state: templ.states)
+        {
+            type_t type = state.uid.getType();
+            info.kept |= !state.invariant.empty()
+                || type.is(URGENT) || type.is(COMMITTED);
+            collectReads(state.invariant, info.reads);
+            collectReads(state.exponentialRate, info.reads);
+            collectReads(state.costRate, info.reads);
+        }
+
+        for (auto& arg: process.mapping)
+        {
+            arg.second.collectPossibleReads(info.reads);
+        }
+        for (auto& fun: templ.functions)
+        {
+            collectUnits(fun, info.units);
+            info.writes.insert(fun.changes.begin(), fun.changes.end());
+        }
+        for (auto& edge: templ.edges)
+        {
+            collectReads(edge.guard, info.reads);
+            collectReads(edge.sync, info.reads);
+#ifdef ENABLE_PROB
+            collectReads(edge.prob, info.reads);
+#endif
+            collectUnits(edge.assign, symbol_t(), false, info.units);
+            edge.assign.collectPossibleWrites(info.writes);
+            if (edge.sync.empty())
+            {
+                continue;
+            }
+
+            /* Urgent synchronisations restrict delays of all processes
+             * and a broadcast receiver cannot block the sender.
+             */
+            info.kept |= edge.sync[0].getType().is(URGENT);
+            symbol_t chan = resolveChannel(process, edge.sync[0]);
+            bool broadcast = edge.sync[0].getType().is(BROADCAST);
+            if (!broadcast || edge.sync.getSync() != SYNC_QUE)
+            {
+                info.affects.insert(chan);
+            }
+            if (!broadcast || edge.sync.getSync() != SYNC_BANG)
+            {
+                info.affected.insert(chan);
+            }
+        }
+
+        /* Writes to reference parameters are writes to the arguments.
+         */
+        for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+        {
+            symbol_t param = templ.parameters[i];
+            if (param.getType().is(REF) && !param.getType().isConstant())
+            {
+                info.writes.insert(param);
+            }
+        }
+        resolveArguments(process, info.writes);
+        for (auto& unit: info.units)
+        {
+            resolveArguments(process, unit.writes);
+            resolveArguments(process, unit.reads);
+        }
+    }
+
+    /* A process is in the cone of influence if it writes a symbol
+     * relevant to the cone or may block a process of it. The symbols
+     * relevant to the cone are those read by guards, invariants and
+     * synchronisations of its processes and, transitively, by the
+     * assignments to relevant symbols.
+     */
+    auto propagate = [&relevant](list<unit_t> &units) {
+        bool changed = false;
+        for (auto& unit: units)
+        {
+            if (!unit.live
+                && (unit.owner == symbol_t()
+                    || relevant.find(unit.owner) != relevant.end())
+                && (unit.control || intersects(unit.writes, relevant)))
+            {
+                unit.live = true;
+                changed = true;
+                relevant.insert(unit.reads.begin(), unit.reads.end());
+            }
+        }
+        return changed;
+    };
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& info: infos)
+        {
+            if (!info.kept && (intersects(info.writes, relevant)
+                               || sharesChannel(info.affects, affected)))
+            {
+                info.kept = true;
+            }
+            if (!info.kept)
+            {
+                continue;
+            }
+            if (!info.added)
+            {
+                info.added = true;
+                changed = true;
+                relevant.insert(info.reads.begin(), info.reads.end());
+                affected.insert(info.affected.begin(), info.affected.end());
+            }
+            changed |= propagate(info.units);
+        }
+        changed |= propagate(globalUnits);
+    }
+
+    /* Templates are removed together with their last process.
+     */
+    set<template_t*> used, unused;
+    set<symbol_t> removed;
+    for (auto& info: infos)
+    {
+        if (info.kept)
+        {
+            used.insert(info.process->templ);
+        }
+        else
+        {
+            unused.insert(info.process->templ);
+            removedProcesses.push_back(info.process->uid.getName());
+            removed.insert(info.process->uid);
+        }
+    }
+    system.getProcesses().remove_if([&removed](const instance_t &process) {
+        return removed.find(process.uid) != removed.end();
+    });
+    list<template_t> &templates = system.getTemplates();
+    for (auto t = templates.begin(); t != templates.end();)
+    {
+        if (unused.find(&*t) != unused.end() && used.find(&*t) == used.end())
+        {
+            removed.insert(t->uid);
+            t = templates.erase(t);
+        }
+        else
+        {
+            ++t;
+        }
+    }
+    system.getGlobals().frame.remove(removed);
+}
+
+void Slicer::removeDeadCode()
+{
+    if (collectQueries())
+    {
+        slice();
+    }
+}
+
+void Slicer::sliceQuery(size_t query)
+{
+    queries_t &queries = system.getQueries();
+    if (query >= queries.size())
+    {
+        return;
+    }
+    query_t selected = queries[query];
+    queries.clear();
+    queries.push_back(selected);
+    if (collectQueries())
+    {
+        removeIndependentProcesses();
+        slice();
+    }
+}
+
+void Slicer::slice()
+{
+    collectRemovable();
+
+    for (auto& templ: system.getTemplates())
+    {
+        collectChannels(templ);
+    }
+    for (auto templ: system.getDynamicTemplates())
+    {
+        collectChannels(*templ);
+    }
+    for (auto& templ: system.getTemplates())
+    {
+        if (sliced.find(&templ) != sliced.end())
+        {
+            removeUnreachable(templ);
+        }
+    }
+
+    computeRelevant();
+
+    /* Remove assignments to irrelevant variables.
+     */
+    set<symbol_t> dead;
+    std::set_difference(removable.begin(), removable.end(),
+                        relevant.begin(), relevant.end(),
+                        std::inserter(dead, dead.end()));
+    DeadStoreRemover remover(dead, removedAssignments);
+    for (auto& fun: system.getGlobals().functions)
+    {
+        fun.body->accept(&remover);
+        collectSideEffects(fun);
+    }
+    for (auto& templ: system.getTemplates())
+    {
+        if (sliced.find(&templ) == sliced.end())
+        {
+            continue;
+        }
+        for (auto& fun: templ.functions)
+        {
+            fun.body->accept(&remover);
+            collectSideEffects(fun);
+        }
+        for (auto& edge: templ.edges)
+        {
+            edge.assign = sliceUpdate(edge.assign, dead, removedAssignments);
+        }
+    }
+
+    removeUnreferenced();
+
+    /* The types of processes list the symbols of their templates.
+     */
+    for (auto& process: system.getProcesses())
+    {
+        if (process.unbound == 0)
+        {
+            process.uid.setType(type_t::createProcess(process.templ->frame));
+        }
+    }
+}
+
+void Slicer::printReport(ostream &os) const
+{
+    os << "Removed " << removedProcesses.size() << " process(es), "
+       << removedVariables.size() << " variable(s), "
+       << removedFunctions.size() << " function(s), "
+       << removedLocations.size() << " location(s), "
+       << removedEdges << " edge(s) and "
+       << removedAssignments << " assignment(s).\n";
+    auto print = [&os](const char *title, const vector<string> &names) {
+        if (!names.empty())
+        {
+            os << title << ":";
+            for (auto& name: names)
+            {
+                os << " " << name;
+            }
+            os << "\n";
+        }
+    };
+    print("Processes", removedProcesses);
+    print("Variables", removedVariables);
+    print("Functions", removedFunctions);
+    print("Locations", removedLocations);
+}
@@ -19,6 +19,7 @@
    USA
 */
 
+#include <atomic>
 #include <cstdlib>
 #include <cassert>
 #include <vector>
@@ -120,7 +121,7 @@ uint32_t range_t::size() const
 
 struct symbol_t::symbol_data
 {
-    int32_t count;        // Reference counter
+    std::atomic<int32_t> count; // Reference counter, shared by threads
     void *frame;        // Uncounted pointer to containing frame
     type_t type;        // The type of the symbol
     void *user;                // User data
@@ -152,8 +153,7 @@ symbol_t::~symbol_t()
 {
     if (data)
     {
-        data->count--;
-        if (data->count == 0)
+        if (--data->count == 0)
         {
             delete data;
         }
@@ -165,8 +165,7 @@ const symbol_t &symbol_t::operator = (const symbol_t &symbol)
 {
     if (data)
     {
-        data->count--;
-        if (data->count == 0)
+        if (--data->count == 0)
         {
             delete data;
         }
@@ -250,7 +249,7 @@ std::ostream &operator << (std::ostream &o, UTAP::symbol_t t)
 
 struct frame_t::frame_data
 {
-    int32_t count;                        // Reference count
+    std::atomic<int32_t> count;           // Reference count, shared by threads
     bool hasParent;                        // True if there is a parent
     frame_data *parent;                        // The parent frame data
     vector<symbol_t> symbols;                // The symbols in the frame
@@ -286,8 +285,7 @@ frame_t::~frame_t()
 {
     if (data)
     {
-        data->count--;
-        if (data->count == 0)
+        if (--data->count == 0)
         {
             delete data;
         }
@@ -298,8 +296,7 @@ const frame_t &frame_t::operator = (const frame_t &frame)
 {
     if (data)
     {
-        data->count--;
-        if (data->count == 0)
+        if (--data->count == 0)
         {
             delete data;
         }
@@ -418,6 +415,26 @@ void frame_t::remove(symbol_t s)
     }
 }
 
+void frame_t::remove(const std::set<symbol_t> &removed)
+{
+    if (removed.empty())
+    {
+        return;
+    }
+    vector<symbol_t> symbols = data->symbols;
+    data->symbols.clear();
+    data->mapping.clear();
+    for (uint32_t i = 0; i < symbols.size(); i++)
+    {
+        symbol_t symbol = symbols[i];
+        if (removed.find(symbol) == removed.end())
+        {
+            add(symbol);
+            symbol.data->frame = data;
+        }
+    }
+}
+
 int32_t frame_t::getIndexOf(const string& name) const
 {
     map<string, int32_t>::const_iterator i = data->mapping.find(name);
@@ -0,0 +1,872 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/symmetry.h"
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::ostream;
+using std::string;
+using std::to_string;
+using std::vector;
+
+const uint32_t Symmetry::none;
+
+namespace
+{
+    /** Returns true if the declaration is part of the discrete state. */
+    bool isStateVariable(symbol_t symbol)
+    {
+        type_t type = symbol.getType();
+        type_t base = type.stripArray();
+        return !type.is(REF) && !type.isConstant()
+            && (base.isIntegral() || base.isScalar() || base.isRecord());
+    }
+
+    /** Returns true if the declaration is a clock or an array of them. */
+    bool isClockVariable(symbol_t symbol)
+    {
+        type_t type = symbol.getType();
+        return !type.is(REF) && type.stripArray().isClock();
+    }
+
+    /**
+     * Returns the label identifying the scalar set of \a type, if any,
+     * and sets \a name to the name of its type definition.
+     */
+    string getScalarSet(type_t type, string &name)
+    {
+        while (true)
+        {
+            if (type.getKind() == LABEL)
+            {
+                const string &label = type.getLabel(0);
+                if (label.compare(0, 10, "#scalarset") == 0)
+                {
+                    return label;
+                }
+                if (label.empty() || label.back() != ':')
+                {
+                    name = label;
+                }
+            }
+            if (type.size() == 0)
+            {
+                return string();
+            }
+            type = type[0];
+        }
+    }
+
+    /**
+     * Determines whether a statement may leave the innermost enclosing
+     * loop early by a break or return statement.
+     */
+    class ExitVisitor : public AbstractStatementVisitor
+    {
+    private:
+        uint32_t depth;
+    public:
+        bool exits;
+
+        ExitVisitor() : depth(0), exits(false) {}
+
+        int32_t visitForStatement(ForStatement *stat) override
+        {
+            depth++;
+            stat->stat->accept(this);
+            depth--;
+            return 0;
+        }
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            depth++;
+            stat->stat->accept(this);
+            depth--;
+            return 0;
+        }
+        int32_t visitWhileStatement(WhileStatement *stat) override
+        {
+            depth++;
+            stat->stat->accept(this);
+            depth--;
+            return 0;
+        }
+        int32_t visitDoWhileStatement(DoWhileStatement *stat) override
+        {
+            depth++;
+            stat->stat->accept(this);
+            depth--;
+            return 0;
+        }
+        int32_t visitSwitchStatement(SwitchStatement *stat) override
+        {
+            depth++;
+            visitBlockStatement(stat);
+            depth--;
+            return 0;
+        }
+        int32_t visitBreakStatement(BreakStatement *) override
+        {
+            exits = exits || depth == 0;
+            return 0;
+        }
+        int32_t visitReturnStatement(ReturnStatement *) override
+        {
+            exits = true;
+            return 0;
+        }
+    };
+
+    bool intersects(const std::set<symbol_t> &a, const std::set<symbol_t> &b)
+    {
+        return std::find_first_of(a.begin(), a.end(), b.begin(), b.end())
+            != a.end();
+    }
+
+    /**
+     * Collects the assignments and reads in the body of an iteration
+     * over a scalar set with the given iterator.
+     */
+    class CarryVisitor : public ExpressionVisitor
+    {
+    public:
+        struct assign_t
+        {
+            std::set<symbol_t> targets;
+            std::set<symbol_t> values;  // read to compute the value
+            bool indexed;               // an element selected by the iterator
+            bool accumulates;           // +=, -=, ++ or --, which commute
+        };
+
+        symbol_t iterator;
+        vector<assign_t> assigns;
+        std::set<symbol_t> reads;
+        std::set<symbol_t> locals;      // declared inside the body
+
+        explicit CarryVisitor(symbol_t iterator) : iterator(iterator) {}
+
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            return stat->stat->accept(this);
+        }
+        int32_t visitBlockStatement(BlockStatement *stat) override
+        {
+            frame_t frame = stat->getFrame();
+            for (uint32_t i = 0; i < frame.getSize(); ++i)
+            {
+                locals.insert(frame[i]);
+                if (frame[i].getData())
+                {
+                    expression_t init = static_cast<variable_t*>(
+                        frame[i].getData())->expr;
+                    assign_t assign = { { frame[i] }, {}, false, false };
+                    init.collectPossibleReads(assign.values);
+                    init.collectPossibleReads(reads);
+                    assigns.push_back(assign);
+                }
+            }
+            for (auto sub: *stat)
+            {
+                sub->accept(this);
+            }
+            return 0;
+        }
+    protected:
+        /* Returns true if the lvalue selects an element by the iterator. */
+        bool isIndexed(expression_t lhs) const
+        {
+            switch (lhs.getKind())
+            {
+            case ARRAY:
+                return lhs[1].dependsOn({ iterator }) || isIndexed(lhs[0]);
+            case DOT:
+                return isIndexed(lhs[0]);
+            default:
+                return false;
+            }
+        }
+
+        /* Adds the symbols read by the indices of an lvalue. */
+        void readIndices(expression_t lhs, std::set<symbol_t> &symbols) const
+        {
+            if (lhs.getKind() == ARRAY)
+            {
+                lhs[1].collectPossibleReads(symbols);
+                readIndices(lhs[0], symbols);
+            }
+            else if (lhs.getKind() == DOT)
+            {
+                readIndices(lhs[0], symbols);
+            }
+            else if (lhs.getKind() != IDENTIFIER)
+            {
+                lhs.collectPossibleReads(symbols);
+            }
+        }
+
+        void visitExpression(expression_t expr) override
+        {
+            if (expr.empty())
+            {
+                return;
+            }
+            kind_t kind = expr.getKind();
+            switch (kind)
+            {
+            case ASSIGN: case ASSPLUS: case ASSMINUS: case ASSDIV:
+            case ASSMOD: case ASSMULT: case ASSAND: case ASSOR: case ASSXOR:
+            case ASSLSHIFT: case ASSRSHIFT:
+            case POSTINCREMENT: case POSTDECREMENT:
+            case PREINCREMENT: case PREDECREMENT:
+            {
+                assign_t assign;
+                expr[0].getSymbols(assign.targets);
+                assign.indexed = isIndexed(expr[0]);
+                assign.accumulates = kind == ASSPLUS || kind == ASSMINUS
+                    || kind == POSTINCREMENT || kind == POSTDECREMENT
+                    || kind == PREINCREMENT || kind == PREDECREMENT;
+                readIndices(expr[0], reads);
+                if (!assign.accumulates && kind != ASSIGN)
+                {
+                    reads.insert(assign.targets.begin(), assign.targets.end());
+                }
+                if (expr.getSize() > 1)
+                {
+                    expr[1].collectPossibleReads(assign.values);
+                    visitExpression(expr[1]);
+                }
+                assigns.push_back(assign);
+                return;
+            }
+            case IDENTIFIER:
+                reads.insert(expr.getSymbol());
+                return;
+            case FUNCALL:
+            {
+                /* The effects of the callee are not selected by the
+                 * iterator. */
+                symbol_t symbol = expr[0].getSymbol();
+                if (symbol.getType().isFunction() && symbol.getData())
+                {
+                    function_t *fun = static_cast<function_t*>(symbol.getData());
+                    reads.insert(fun->depends.begin(), fun->depends.end());
+                    assign_t assign;
+                    assign.targets = fun->changes;
+                    assign.indexed = false;
+                    assign.accumulates = false;
+                    assigns.push_back(assign);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+            {
+                visitExpression(expr[i]);
+            }
+        }
+    };
+
+    /**
+     * Returns true if an iteration carries state from one value of the
+     * scalar set to the next: it assigns a value derived from the
+     * iterator to a variable not selected by the iterator, or it
+     * writes such a variable and reads it again. Sums built with
+     * +=, -=, ++ and -- do not depend on the order.
+     */
+    bool carriesState(IterationStatement *stat)
+    {
+        CarryVisitor visitor(stat->symbol);
+        stat->stat->accept(&visitor);
+
+        std::set<symbol_t> derived = { stat->symbol };
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (auto& assign: visitor.assigns)
+            {
+                if (assign.indexed || assign.accumulates
+                    || !intersects(assign.values, derived))
+                {
+                    continue;
+                }
+                for (auto& target: assign.targets)
+                {
+                    if (visitor.locals.find(target) == visitor.locals.end())
+                    {
+                        return true;
+                    }
+                    changed |= derived.insert(target).second;
+                }
+            }
+        }
+        for (auto& assign: visitor.assigns)
+        {
+            if (assign.indexed)
+            {
+                continue;
+            }
+            for (auto& target: assign.targets)
+            {
+                if (visitor.locals.find(target) == visitor.locals.end()
+                    && visitor.reads.find(target) != visitor.reads.end())
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Collects the scalar set iterations which may be left early or
+     * carry state from one value to the next.
+     */
+    class IterationVisitor : public AbstractStatementVisitor
+    {
+    public:
+        vector<type_t> suspects;
+
+        int32_t visitIterationStatement(IterationStatement *stat) override
+        {
+            if (stat->symbol.getType().isScalar())
+            {
+                ExitVisitor visitor;
+                stat->stat->accept(&visitor);
+                if (visitor.exits || carriesState(stat))
+                {
+                    suspects.push_back(stat->symbol.getType());
+                }
+            }
+            return stat->stat->accept(this);
+        }
+    };
+}
+
+Symmetry::Symmetry(TimedAutomataSystem &system, uint64_t limit):
+    system(system), evaluator(system), limit(limit), known(true)
+{
+    /* Processes expanded for their free parameters, with coordinates
+     * counted in processes. */
+    vector<vector<coord_t> > processCoords;
+    vector<const instance_t*> instances;
+    for (auto& instance: system.getProcesses())
+    {
+        if (instance.templ->isTA)
+        {
+            instances.push_back(&instance);
+            addProcesses(instance, processCoords);
+        }
+    }
+
+    for (uint32_t p = 0; p < processes.size(); ++p)
+    {
+        slots.push_back({ { processes[p].name, p, true },
+                          processCoords[p], none });
+    }
+
+    for (auto& var: system.getGlobals().variables)
+    {
+        vector<coord_t> coords;
+        if (isStateVariable(var.uid))
+        {
+            addSlots(var.uid.getType(), var.uid, var.uid.getName(), none,
+                     false, coords);
+        }
+        else if (isClockVariable(var.uid) && !system.isReferenceClock(var.uid))
+        {
+            addSlots(var.uid.getType(), var.uid, var.uid.getName(), none,
+                     true, coords);
+        }
+    }
+
+    /* The local variables and clocks of each process form blocks. */
+    std::set<const template_t*> checked;
+    uint32_t p = 0;
+    for (const instance_t *instance: instances)
+    {
+        const template_t &templ = *instance->templ;
+        evaluator.bind(*instance);
+        uint32_t block = 0, clockBlock = 0;
+        for (auto& var: templ.variables)
+        {
+            uint32_t count;
+            if (isStateVariable(var.uid))
+            {
+                known = countSlots(var.uid.getType(), false, count) && known;
+                block += count;
+            }
+            else if (isClockVariable(var.uid))
+            {
+                known = countSlots(var.uid.getType(), true, count) && known;
+                clockBlock += count;
+            }
+        }
+        for (; p < processes.size() && processes[p].instance == instance; ++p)
+        {
+            vector<coord_t> coords = processCoords[p];
+            vector<coord_t> clockCoords = processCoords[p];
+            for (auto& coord: coords)
+            {
+                coord.stride *= block;
+            }
+            for (auto& coord: clockCoords)
+            {
+                coord.stride *= clockBlock;
+            }
+            for (auto& var: templ.variables)
+            {
+                string name = processes[p].name + "." + var.uid.getName();
+                if (isStateVariable(var.uid))
+                {
+                    addSlots(var.uid.getType(), var.uid, name, p, false,
+                             coords);
+                }
+                else if (isClockVariable(var.uid))
+                {
+                    addSlots(var.uid.getType(), var.uid, name, p, true,
+                             clockCoords);
+                }
+            }
+        }
+        evaluator.clear();
+
+        if (checked.insert(&templ).second)
+        {
+            checkFunctions(templ, templ.uid.getName() + ".");
+        }
+    }
+    checkFunctions(system.getGlobals(), "");
+}
+
+/**
+ * Returns the group of the scalar set of \a type, adding it if it is
+ * new, or none if \a type is not a scalar set.
+ */
+uint32_t Symmetry::getGroup(type_t type)
+{
+    string name;
+    string label = getScalarSet(type, name);
+    if (label.empty())
+    {
+        return none;
+    }
+    auto i = groupIndex.find(label);
+    if (i != groupIndex.end())
+    {
+        return i->second;
+    }
+    group_t group;
+    int32_t lower, upper;
+    if (evaluator.evaluateRange(type, lower, upper))
+    {
+        group.size = upper >= lower ? upper - lower + 1 : 0;
+    }
+    else
+    {
+        group.size = 0;
+        known = false;
+    }
+    group.name = name.empty() ? "scalar[" + to_string(group.size) + "]" : name;
+    groupIndex[label] = groups.size();
+    groups.push_back(group);
+    return groups.size() - 1;
+}
+
+void Symmetry::addVariable(uint32_t group, symbol_t symbol)
+{
+    vector<symbol_t> &variables = groups[group].variables;
+    if (std::find(variables.begin(), variables.end(), symbol) == variables.end())
+    {
+        variables.push_back(symbol);
+    }
+}
+
+/**
+ * Adds an expanded process for every combination of values of the
+ * free parameters of \a instance, the last one varying fastest.
+ */
+void Symmetry::addProcesses(const instance_t &instance,
+                            vector<vector<coord_t> > &coords)
+{
+    uint32_t count = instance.unbound;
+    vector<int32_t> lower(count), upper(count);
+    vector<uint32_t> group(count), stride(count);
+    evaluator.bind(instance);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        type_t type = instance.parameters[i].getType();
+        if (!evaluator.evaluateRange(type, lower[i], upper[i])
+            || upper[i] < lower[i])
+        {
+            known = false;
+            evaluator.clear();
+            return;
+        }
+        group[i] = type.isScalar() ? getGroup(type) : none;
+        if (group[i] != none)
+        {
+            vector<const instance_t*> &members = groups[group[i]].processes;
+            if (members.empty() || members.back() != &instance)
+            {
+                members.push_back(&instance);
+            }
+        }
+    }
+    evaluator.clear();
+    for (uint32_t i = count, s = 1; i-- > 0; )
+    {
+        stride[i] = s;
+        s *= upper[i] - lower[i] + 1;
+    }
+
+    vector<int32_t> values(lower);
+    while (true)
+    {
+        process_t process;
+        process.instance = &instance;
+        process.arguments = values;
+        process.name = instance.uid.getName();
+        vector<coord_t> processCoords;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            process.name += (i == 0 ? "(" : ", ") + to_string(values[i]);
+            if (group[i] != none)
+            {
+                processCoords.push_back({ group[i], values[i] - lower[i],
+                                          stride[i] });
+            }
+        }
+        process.name += count > 0 ? ")" : "";
+        processes.push_back(process);
+        coords.push_back(processCoords);
+
+        uint32_t i = count;
+        while (i > 0 && values[i - 1] == upper[i - 1])
+        {
+            values[i - 1] = lower[i - 1];
+            --i;
+        }
+        if (i == 0)
+        {
+            break;
+        }
+        values[i - 1]++;
+    }
+}
+
+/** Counts the clock or else the integer elements of a value of \a type. */
+bool Symmetry::countSlots(type_t type, bool clock, uint32_t &count) const
+{
+    count = 0;
+    if (type.isArray())
+    {
+        int32_t lower, upper;
+        uint32_t element;
+        if (!evaluator.evaluateRange(type.getArraySize(), lower, upper)
+            || !countSlots(type.getSub(), clock, element))
+        {
+            return false;
+        }
+        count = upper >= lower ? (upper - lower + 1) * element : 0;
+        return true;
+    }
+    if (type.isRecord())
+    {
+        bool result = true;
+        for (size_t i = 0; i < type.getRecordSize(); ++i)
+        {
+            uint32_t field;
+            result = countSlots(type.getSub(i), clock, field) && result;
+            count += field;
+        }
+        return result;
+    }
+    if (clock)
+    {
+        count = type.isClock() ? 1 : 0;
+    }
+    else
+    {
+        count = type.isIntegral() || type.isScalar() ? 1 : 0;
+    }
+    return true;
+}
+
+/**
+ * Adds the slots of the clock or else the integer elements of a
+ * variable, where \a coords are those of the enclosing process and
+ * arrays.
+ */
+void Symmetry::addSlots(type_t type, symbol_t uid, const string &name,
+                        uint32_t process, bool clock, vector<coord_t> &coords)
+{
+    if (type.isArray())
+    {
+        type_t size = type.getArraySize();
+        int32_t lower, upper;
+        uint32_t stride;
+        if (!evaluator.evaluateRange(size, lower, upper)
+            || !countSlots(type.getSub(), clock, stride))
+        {
+            known = false;
+            return;
+        }
+        uint32_t group = size.isScalar() ? getGroup(size) : none;
+        if (group != none)
+        {
+            addVariable(group, uid);
+        }
+        for (int32_t k = lower; k <= upper; ++k)
+        {
+            if (group != none)
+            {
+                coords.push_back({ group, k - lower, stride });
+            }
+            addSlots(type.getSub(), uid, name + "[" + to_string(k) + "]",
+                     process, clock, coords);
+            if (group != none)
+            {
+                coords.pop_back();
+            }
+        }
+    }
+    else if (type.isRecord())
+    {
+        for (size_t i = 0; i < type.getRecordSize(); ++i)
+        {
+            addSlots(type.getSub(i), uid, name + "." + type.getRecordLabel(i),
+                     process, clock, coords);
+        }
+    }
+    else if (clock)
+    {
+        if (type.isClock())
+        {
+            clocks.push_back({ { name, process, false }, coords, none });
+        }
+    }
+    else if (type.isIntegral() || type.isScalar())
+    {
+        uint32_t group = type.isScalar() ? getGroup(type) : none;
+        if (group != none)
+        {
+            addVariable(group, uid);
+        }
+        slots.push_back({ { name, process, false }, coords, group });
+    }
+}
+
+/** Checks the iterations over scalar sets in the functions declared. */
+void Symmetry::checkFunctions(const declarations_t &declarations,
+                              const string &scope)
+{
+    for (auto& fun: declarations.functions)
+    {
+        if (fun.body == nullptr)
+        {
+            continue;
+        }
+        IterationVisitor visitor;
+        fun.body->accept(&visitor);
+        for (auto& type: visitor.suspects)
+        {
+            violations.push_back(
+                "iteration over " + groups[getGroup(type)].name + " in "
+                + scope + fun.uid.getName()
+                + " may depend on the order of its values");
+        }
+    }
+}
+
+/** Returns the index of \a slot of \a layout under \a permutation. */
+uint32_t Symmetry::permute(const vector<slotinfo_t> &layout, uint32_t slot,
+                           const permutation_t &permutation) const
+{
+    int64_t target = slot;
+    for (auto& coord: layout[slot].coords)
+    {
+        target += int64_t(permutation[coord.group][coord.value]
+                          - coord.value) * coord.stride;
+    }
+    return target;
+}
+
+/** Sets \a image to \a state permuted by \a permutation. */
+void Symmetry::apply(const vector<int32_t> &state,
+                     const permutation_t &permutation,
+                     vector<int32_t> &image) const
+{
+    for (uint32_t s = 0; s < slots.size(); ++s)
+    {
+        int32_t value = state[s];
+        uint32_t group = slots[s].valueGroup;
+        if (group != none && value >= 0 && uint32_t(value) < groups[group].size)
+        {
+            value = permutation[group][value];
+        }
+        image[permute(slots, s, permutation)] = value;
+    }
+}
+
+/**
+ * Sets \a permutation to the one moving the values of every group into
+ * the order of the contents of the slots they index.
+ */
+void Symmetry::sortValues(const vector<int32_t> &state,
+                          permutation_t &permutation) const
+{
+    for (uint32_t g = 0; g < groups.size(); ++g)
+    {
+        vector<vector<int32_t> > keys(groups[g].size);
+        for (uint32_t s = 0; s < slots.size(); ++s)
+        {
+            for (auto& coord: slots[s].coords)
+            {
+                if (coord.group == g)
+                {
+                    keys[coord.value].push_back(state[s]);
+                }
+            }
+        }
+        vector<int32_t> order(permutation[g]);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](int32_t a, int32_t b) {
+                             return keys[a] < keys[b];
+                         });
+        for (uint32_t k = 0; k < order.size(); ++k)
+        {
+            permutation[g][order[k]] = k;
+        }
+    }
+}
+
+bool Symmetry::canonicalise(vector<int32_t> &state,
+                            permutation_t &permutation) const
+{
+    if (!isSymmetric() || state.size() != slots.size())
+    {
+        return false;
+    }
+
+    /* Start from the identity and count the permutations up to the
+     * limit. */
+    uint64_t count = 1;
+    permutation.assign(groups.size(), vector<int32_t>());
+    for (uint32_t g = 0; g < groups.size(); ++g)
+    {
+        for (uint32_t v = 0; v < groups[g].size; ++v)
+        {
+            permutation[g].push_back(v);
+            if (count <= limit
+                && __builtin_mul_overflow(count, uint64_t(v + 1), &count))
+            {
+                count = UINT64_MAX;
+            }
+        }
+    }
+
+    vector<int32_t> image(state.size());
+    if (count > limit)
+    {
+        sortValues(state, permutation);
+        apply(state, permutation, image);
+        state.swap(image);
+        return true;
+    }
+
+    permutation_t current(permutation);
+    vector<int32_t> best(state);
+    while (true)
+    {
+        apply(state, current, image);
+        if (image < best)
+        {
+            best.swap(image);
+            permutation = current;
+        }
+
+        /* Next combination; next_permutation wraps around to identity. */
+        uint32_t g = 0;
+        while (g < groups.size()
+               && !std::next_permutation(current[g].begin(), current[g].end()))
+        {
+            ++g;
+        }
+        if (g == groups.size())
+        {
+            break;
+        }
+    }
+    state.swap(best);
+    return true;
+}
+
+uint32_t Symmetry::permuteClock(uint32_t clock,
+                                const permutation_t &permutation) const
+{
+    return permute(clocks, clock, permutation);
+}
+
+void Symmetry::print(ostream &os) const
+{
+    for (auto& group: groups)
+    {
+        os << "scalarset " << group.name << " of size " << group.size << "\n";
+        if (!group.processes.empty())
+        {
+            os << "  processes:";
+            for (auto process: group.processes)
+            {
+                os << " " << process->uid.getName();
+            }
+            os << "\n";
+        }
+        if (!group.variables.empty())
+        {
+            os << "  variables:";
+            for (auto& variable: group.variables)
+            {
+                os << " " << variable.getName();
+            }
+            os << "\n";
+        }
+    }
+    for (auto& violation: violations)
+    {
+        os << "violation: " << violation << "\n";
+    }
+    if (!known)
+    {
+        os << "violation: some size could not be evaluated\n";
+    }
+    os << (isSymmetric() ? "symmetric" : "not symmetric") << ", "
+       << processes.size() << " processes, " << slots.size() << " slots, "
+       << clocks.size() << " clocks\n";
+}
@@ -83,9 +83,33 @@ string function_t::toString() const
     {
         if (!uid.getType().getLabel(i).empty())
         {
-            str += uid.getType().get(i).toDeclarationString();
-            str += " ";
+            /* Written like a variable, e.g. int &a[3]. */
+            type_t param = uid.getType().get(i);
+            bool ref = param.getKind() == REF;
+            if (ref)
+            {
+                param = param.get(0);
+            }
+            string dims;
+            while (param.isArray())
+            {
+                type_t size = param.getArraySize();
+                dims += "[";
+                if (size.isInteger())
+                {
+                    dims += size.getRange().second.get(0).toString();
+                }
+                else
+                {
+                    dims += size.toDeclarationString();
+                }
+                dims += "]";
+                param = param.getSub();
+            }
+            str += param.toDeclarationString();
+            str += ref ? " &" : " ";
             str += uid.getType().getLabel(i);
+            str += dims;
             str += ", ";
         }
     }
@@ -912,7 +936,8 @@ string chan_priority_t::toString() const
 TimedAutomataSystem::TimedAutomataSystem(): syncUsed(UTAP::sync_use_t::unused)
 {
     global.frame = frame_t::createFrame();
-    addVariable(&global, type_t::createPrimitive(CLOCK), "t(0)", expression_t());
+    referenceClock = addVariable(&global, type_t::createPrimitive(CLOCK), "t(0)",
+                                 expression_t())->uid;
 #ifdef ENABLE_CORA
     addVariable(&global, type_t::createPrimitive(COST), "cost", expression_t());
 #endif
@@ -1349,6 +1374,11 @@ int TimedAutomataSystem::getProcPriority(const char* name) const
     return procPriority.find(name)->second;
 }
 
+bool TimedAutomataSystem::isReferenceClock(symbol_t symbol) const
+{
+    return symbol == referenceClock;
+}
+
 bool TimedAutomataSystem::hasPriorityDeclaration() const
 {
     return hasPriorities;
@@ -20,6 +20,13 @@
 */
 
 #include "utap/signalflow.h"
+#include "utap/clockbounds.h"
+#include "utap/controlflow.h"
+#include "utap/independence.h"
+#include "utap/loopbounds.h"
+#include "utap/metrics.h"
+#include "utap/modulegraph.h"
+#include "utap/symmetry.h"
 #include "utap/systembuilder.h"
 #include "utap/typechecker.h"
 #include "utap/system.h"
@@ -38,6 +45,13 @@ using UTAP::TimedAutomataSystem;
 using UTAP::SignalFlow;
 using UTAP::Partitioner;
 using UTAP::DistanceCalculator;
+using UTAP::ClockBounds;
+using UTAP::ControlFlowGraph;
+using UTAP::Independence;
+using UTAP::LoopBounds;
+using UTAP::Metrics;
+using UTAP::ModuleGraph;
+using UTAP::Symmetry;
 
 using std::vector;
 using std::cerr;
@@ -51,32 +65,59 @@ void printHelp(const char* binary)
 {
     cout <<
         "Utility for extracting I/O information from UPPAAL system spec.\n"
-        "Usage:\n " << binary << " [-bxrce -f format -i iofile] model.xml\n"
+        "Usage:\n " << binary << " [-bxrce -f format -i iofile -j threads] model.xml\n"
         "Options:\n"
         "     -b  use old (v. <=3.4) syntax for system specification;\n"
         "     -d  calculate distances from needles rather than partition;\n"
-        "     -f <dot|tron>\n"
+        "     -f <dot|tron|modules|metrics|bounds|symmetry|independence|cfg|loops>\n"
         "         dot:  for DOT (graphviz.org) format (default),\n"
-        "         tron: for UPPAAL TRON format;\n"
+        "         tron: for UPPAAL TRON format,\n"
+        "         modules: for independent subsystems and their modules,\n"
+        "         metrics: for size metrics of templates and processes,\n"
+        "         bounds: for the maximal clock constants per location,\n"
+        "         symmetry: for the symmetry groups of scalar sets,\n"
+        "         independence: for the edges independent of each edge,\n"
+        "         cfg: for the control flow graphs of functions in SSA form,\n"
+        "         loops: for the iteration bounds of loops in functions;\n"
         "     -i <filename>\n"
         "         for partitioning provide input and output channels:\n"
         "              \"input\" (chan)* \"output\" (chan)*\n"
         "         for calculating distances provide a list of needles, e.g.:\n"
-        "              Process.Location1 Proc.localVariable globalVariable"
+        "              Process.Location1 Proc.localVariable globalVariable\n"
+        "     -j <threads>\n"
+        "         number of threads extracting I/O (default: one per core);\n"
         "     -r  [DOT] rank symbols instead of plain map of system;\n"
         "     -c  [DOT] put channels on edges between processes;\n"
         "     -e  [DOT] use entity relationship notation;\n"
         "     -v  increment output verbosity level.\n";
 }
 
+/* Prints the control flow graph of every function in SSA form. */
+static void printControlFlow(std::ostream &os, UTAP::declarations_t &declarations,
+                             const string &prefix)
+{
+    for (auto& fun: declarations.functions)
+    {
+        if (fun.body == NULL)
+        {
+            continue;
+        }
+        ControlFlowGraph graph(fun);
+        graph.constructSSA();
+        os << "function " << prefix << fun.uid.getName() << ":\n";
+        graph.print(os);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     bool old=false, ranked=false, erd=false, chanEdge=false, distances=false;
     int format = 2, verbosity=0;
+    unsigned threads = 0;
     char c;
     const char* iofile = NULL;
 
-    while ((c = getopt(argc,argv,"bcdef:hi:rxv")) != -1)
+    while ((c = getopt(argc,argv,"bcdef:hi:j:rxv")) != -1)
     {
         switch(c) {
         case 'b':
@@ -100,9 +141,38 @@ int main(int argc, char *argv[])
             {
                 format = 1;
             }
+            else if (strcmp(optarg, "modules")==0)
+            {
+                format = 3;
+            }
+            else if (strcmp(optarg, "metrics")==0)
+            {
+                format = 4;
+            }
+            else if (strcmp(optarg, "bounds")==0)
+            {
+                format = 5;
+            }
+            else if (strcmp(optarg, "symmetry")==0)
+            {
+                format = 6;
+            }
+            else if (strcmp(optarg, "independence")==0)
+            {
+                format = 7;
+            }
+            else if (strcmp(optarg, "cfg")==0)
+            {
+                format = 8;
+            }
+            else if (strcmp(optarg, "loops")==0)
+            {
+                format = 9;
+            }
             else
             {
-                cerr << "-f expects either 'gui' or 'dot' argument.\n";
+                cerr << "-f expects one of dot, tron, modules, metrics, bounds,"
+                    " symmetry, independence, cfg or loops.\n";
                 exit(EXIT_FAILURE);
             }
             break;
@@ -112,6 +182,9 @@ int main(int argc, char *argv[])
         case 'i':
             iofile = optarg;
             break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
         case 'r':
             ranked = true;
             break;
@@ -138,7 +211,14 @@ int main(int argc, char *argv[])
         }
         else
         {
-            parseXTA(argv[optind], &system, !old);
+            FILE *file = fopen(argv[optind], "r");
+            if (file == NULL)
+            {
+                perror(argv[optind]);
+                exit(EXIT_FAILURE);
+            }
+            parseXTA(file, &system, !old);
+            fclose(file);
         }
     }
     catch (TypeException& e)
@@ -161,11 +241,49 @@ int main(int argc, char *argv[])
     {
            cerr << *it << endl;
     }
+    if (!errors.empty())
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    if (format == 4) {
+        Metrics(system).print(std::cout);
+        exit(EXIT_SUCCESS);
+    }
+    if (format == 5) {
+        ClockBounds(system).print(std::cout);
+        exit(EXIT_SUCCESS);
+    }
+    if (format == 6) {
+        Symmetry(system).print(std::cout);
+        exit(EXIT_SUCCESS);
+    }
+    if (format == 7) {
+        Independence(system).print(std::cout);
+        exit(EXIT_SUCCESS);
+    }
+    if (format == 8) {
+        printControlFlow(std::cout, system.getGlobals(), "");
+        for (auto& templ: system.getTemplates())
+        {
+            printControlFlow(std::cout, templ, templ.uid.getName() + ".");
+        }
+        for (auto templ: system.getDynamicTemplates())
+        {
+            printControlFlow(std::cout, *templ, templ->uid.getName() + ".");
+        }
+        exit(EXIT_SUCCESS);
+    }
+    if (format == 9) {
+        LoopBounds(system).print(std::cout);
+        exit(EXIT_SUCCESS);
+    }
 
     if (iofile!=NULL) {
         SignalFlow *flow = NULL;
         if (!distances) {
-            Partitioner *partitioner = new Partitioner(argv[optind], system);
+            Partitioner *partitioner = new Partitioner(argv[optind], system,
+                                                       threads);
             partitioner->setVerbose(verbosity);
             ifstream f(iofile);
             if (partitioner->partition(f)>1)
@@ -174,7 +292,7 @@ int main(int argc, char *argv[])
             flow = partitioner;
         } else {
             DistanceCalculator *dcalc = 
-                new DistanceCalculator(argv[optind], system);
+                new DistanceCalculator(argv[optind], system, threads);
             ifstream f(iofile);
             string needle;
             while (f) {
@@ -192,12 +310,15 @@ int main(int argc, char *argv[])
         case 1:
             flow->printForTron(std::cout);
             break;
+        case 3:
+            ModuleGraph(flow->getGraph()).print(std::cout, argv[optind]);
+            break;
         }
         delete flow;
         exit(EXIT_SUCCESS);
     }
 
-    SignalFlow flow(argv[optind], system);
+    SignalFlow flow(argv[optind], system, threads);
     switch (format)
     {
     case 0:
@@ -207,6 +328,9 @@ int main(int argc, char *argv[])
     case 1:
         flow.printForTron(std::cout);
         break;
+    case 3:
+        ModuleGraph(flow.getGraph()).print(std::cout, argv[optind]);
+        break;
     }
     return 0;
 }
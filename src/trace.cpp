@@ -0,0 +1,1072 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/trace.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+#include <sys/stat.h>
+
+using namespace UTAP;
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (mapped)
+    {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+void MappedFile::release(const char *pos)
+{
+#ifndef _WIN32
+    if (mapped)
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t offset = (pos - data) / page * page;
+        if (offset > released)
+        {
+            madvise(const_cast<char*>(data) + released, offset - released,
+                    MADV_DONTNEED);
+            released = offset;
+        }
+    }
+#endif
+}
+
+bool MappedFile::open(const char *path)
+{
+    if (strcmp(path, "-") == 0)
+    {
+        buffer.assign(std::istreambuf_iterator<char>(std::cin),
+                      std::istreambuf_iterator<char>());
+    }
+    else
+    {
+#ifndef _WIN32
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(addr);
+                size = st.st_size;
+                mapped = true;
+            }
+        }
+        close(fd);
+        if (mapped)
+        {
+            return true;
+        }
+#endif
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file),
+                      std::istreambuf_iterator<char>());
+    }
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+void IntermediateModel::loadLayout(Scanner &in)
+{
+    const char *section = "layout section";
+    while (in.entry())
+    {
+        cell_t cell;
+        in.number(section);
+        in.expect(':', section);
+        string_view type = in.field();
+        in.accept(':');
+        if (type == "clock")
+        {
+            cell.type = cell_t::CLOCK;
+            cell.clock.nr = in.number(section);
+            in.expect(':', section);
+            cell.name = in.word(section);
+            clocks.push_back(cell.name);
+        }
+        else if (type == "const")
+        {
+            cell.type = cell_t::CONST;
+            cell.value = in.number(section);
+        }
+        else if (type == "var")
+        {
+            cell.type = cell_t::VAR;
+            cell.var.min = in.number(section);
+            in.expect(':', section);
+            cell.var.max = in.number(section);
+            in.expect(':', section);
+            cell.var.init = in.number(section);
+            in.expect(':', section);
+            cell.var.nr = in.number(section);
+            in.expect(':', section);
+            cell.name = in.word(section);
+            variables.push_back(cell.name);
+        }
+        else if (type == "meta")
+        {
+            cell.type = cell_t::META;
+            cell.meta.min = in.number(section);
+            in.expect(':', section);
+            cell.meta.max = in.number(section);
+            in.expect(':', section);
+            cell.meta.init = in.number(section);
+            in.expect(':', section);
+            cell.meta.nr = in.number(section);
+            in.expect(':', section);
+            cell.name = in.word(section);
+            variables.push_back(cell.name);
+        }
+        else if (type == "sys_meta")
+        {
+            cell.type = cell_t::SYS_META;
+            cell.sys_meta.min = in.number(section);
+            in.expect(':', section);
+            cell.sys_meta.max = in.number(section);
+            in.expect(':', section);
+            cell.name = in.word(section);
+        }
+        else if (type == "static")
+        {
+            cell.type = cell_t::FIXED;
+            cell.fixed.min = in.number(section);
+            in.expect(':', section);
+            cell.fixed.max = in.number(section);
+            in.expect(':', section);
+            cell.name = in.word(section);
+        }
+        else if (type == "location")
+        {
+            string_view flags = in.field();
+            in.expect(':', section);
+            cell.type = cell_t::LOCATION;
+            if (flags.empty())
+            {
+                cell.location.flags = cell_t::NONE;
+            }
+            else if (flags == "committed")
+            {
+                cell.location.flags = cell_t::COMMITTED;
+            }
+            else if (flags == "urgent")
+            {
+                cell.location.flags = cell_t::URGENT;
+            }
+            else
+            {
+                in.error(section);
+            }
+            cell.name = in.word(section);
+        }
+        else if (type == "cost")
+        {
+            cell.type = cell_t::COST;
+        }
+        else
+        {
+            in.error(section);
+        }
+        layout.push_back(std::move(cell));
+        in.rest();
+    }
+#if defined(ENABLE_CORA) || defined(ENABLE_PRICED)
+    cell_t cell;
+    cell.type = cell_t::VAR;
+    cell.var.min = std::numeric_limits<int32_t>::min();
+    cell.var.max = std::numeric_limits<int32_t>::max();
+    cell.var.init = 0;
+
+    cell.name = "infimum_cost";
+    cell.var.nr = variables.size();
+    variables.push_back(cell.name);
+    layout.push_back(cell);
+
+    cell.name = "offset_cost";
+    cell.var.nr = variables.size();
+    variables.push_back(cell.name);
+    layout.push_back(cell);
+
+    for (size_t i=1; i<clocks.size(); ++i) {
+        cell.name = "#rate[";
+        cell.name.append(clocks[i]);
+        cell.name.append("]");
+        cell.var.nr = variables.size();
+        variables.push_back(cell.name);
+        layout.push_back(cell);
+    }
+#endif
+}
+
+void IntermediateModel::loadInstructions(Scanner &in)
+{
+    const char *section = "instruction section";
+    while (in.entry(true))
+    {
+        int value;
+        in.number(section);
+        in.expect(':', section);
+        instructions.push_back(in.number(section));
+        while (in.number(value))
+        {
+            instructions.push_back(value);
+        }
+        in.rest();
+    }
+}
+
+void IntermediateModel::loadProcesses(Scanner &in)
+{
+    const char *section = "process section";
+    while (in.entry())
+    {
+        process_t process;
+        in.number(section);
+        in.expect(':', section);
+        process.initial = in.number(section);
+        in.expect(':', section);
+        process.name = in.word(section);
+        processes.push_back(std::move(process));
+        in.rest();
+    }
+}
+
+void IntermediateModel::loadLocations(Scanner &in)
+{
+    const char *section = "location section";
+    while (in.entry())
+    {
+        int index = in.number(section);
+        in.expect(':', section);
+        int process = in.number(section);
+        in.expect(':', section);
+        int invariant = in.number(section);
+        if (index < 0 || (size_t)index >= layout.size()
+            || process < 0 || (size_t)process >= processes.size())
+        {
+            in.error(section);
+        }
+        layout[index].location.process = process;
+        layout[index].location.invariant = invariant;
+        processes[process].locations.push_back(index);
+        in.rest();
+    }
+}
+
+void IntermediateModel::loadEdges(Scanner &in)
+{
+    const char *section = "edge section";
+    while (in.entry())
+    {
+        edge_t edge;
+        edge.process = in.number(section);
+        in.expect(':', section);
+        edge.source = in.number(section);
+        in.expect(':', section);
+        edge.target = in.number(section);
+        in.expect(':', section);
+        edge.guard = in.number(section);
+        in.expect(':', section);
+        edge.sync = in.number(section);
+        in.expect(':', section);
+        edge.update = in.number(section);
+        if (edge.process < 0 || (size_t)edge.process >= processes.size())
+        {
+            in.error(section);
+        }
+        processes[edge.process].edges.push_back(edges.size());
+        edges.push_back(edge);
+        in.rest();
+    }
+}
+
+void IntermediateModel::loadExpressions(Scanner &in)
+{
+    const char *section = "expression section";
+    while (in.entry())
+    {
+        /* The expression follows the third colon. */
+        int index = in.number(section);
+        in.expect(':', section);
+        in.field();
+        in.expect(':', section);
+        in.field();
+        in.expect(':', section);
+
+        /* Trim white space. */
+        string_view str = in.rest();
+        while (!str.empty() && isspace(static_cast<unsigned char>(str.front())))
+        {
+            str.remove_prefix(1);
+        }
+        while (!str.empty() && isspace(static_cast<unsigned char>(str.back())))
+        {
+            str.remove_suffix(1);
+        }
+
+        /* Expressions are usually listed in order. */
+        expressions.insert_or_assign(expressions.end(), index, string(str));
+    }
+}
+
+void IntermediateModel::load(const char *begin, const char *end)
+{
+    Scanner in(begin, end);
+    while (!in.atEnd())
+    {
+        string_view section = in.rest();
+        if (section.empty())
+        {
+            continue;
+        }
+        else if (section == "layout")
+        {
+            loadLayout(in);
+        }
+        else if (section == "instructions")
+        {
+            loadInstructions(in);
+        }
+        else if (section == "processes")
+        {
+            loadProcesses(in);
+        }
+        else if (section == "locations")
+        {
+            loadLocations(in);
+        }
+        else if (section == "edges")
+        {
+            loadEdges(in);
+        }
+        else if (section == "expressions")
+        {
+            loadExpressions(in);
+        }
+        else
+        {
+            throw FormatException("Unknown section");
+        }
+    }
+}
+
+string_view IntermediateModel::getExpression(int index) const
+{
+    auto it = expressions.find(index);
+    return it == expressions.end() ? string_view() : string_view(it->second);
+}
+
+void DBM::init(size_t dim)
+{
+    this->dim = dim;
+    stride = (dim + 7) & ~size_t(7);
+    raw.assign(dim * stride, rawInfinity);
+    for (size_t i = 0; i < dim; i++)
+    {
+        (*this)(0, i) = rawZero;
+        (*this)(i, i) = rawZero;
+    }
+}
+
+/* Tightens row di of a DBM by paths through clock k, where ik is the
+ * bound from i to k and dk is row k. The loop is branch free and has
+ * a fixed inner trip count, such that it can be vectorised. The rows
+ * must not overlap.
+ */
+static void relax(raw_t *__restrict di, const raw_t *__restrict dk,
+                  raw_t ik, size_t stride)
+{
+    for (size_t j = 0; j < stride; j += 8)
+    {
+        for (size_t l = 0; l < 8; l++)
+        {
+            raw_t kj = dk[j + l];
+            raw_t sum = kj == rawInfinity ? rawInfinity : ik + kj - ((ik | kj) & 1);
+            di[j + l] = std::min(di[j + l], sum);
+        }
+    }
+}
+
+bool DBM::close()
+{
+    for (size_t k = 0; k < dim; k++)
+    {
+        const raw_t *dk = &raw[k * stride];
+        for (size_t i = 0; i < dim; i++)
+        {
+            raw_t *di = &raw[i * stride];
+            if (i != k && di[k] != rawInfinity)
+            {
+                relax(di, dk, di[k], stride);
+                if (di[i] < rawZero)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool DBM::isEmpty() const
+{
+    for (size_t i = 0; i < dim; i++)
+    {
+        if ((*this)(i, i) < rawZero)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DBM::isClosed() const
+{
+    for (size_t k = 0; k < dim; k++)
+    {
+        for (size_t i = 0; i < dim; i++)
+        {
+            for (size_t j = 0; j < dim; j++)
+            {
+                if (addRaw((*this)(i, k), (*this)(k, j)) < (*this)(i, j))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void DBM::reduce(vector<constraint_t> &constraints) const
+{
+    constraints.clear();
+
+    /* Partition the clocks into classes of clocks that are equal up
+     * to a constant, i.e. lie on a cycle of weight (0, <=).
+     */
+    vector<size_t> leader(dim);
+    vector<size_t> leaders;
+    for (size_t i = 0; i < dim; i++)
+    {
+        leader[i] = i;
+        for (size_t l: leaders)
+        {
+            if (addRaw((*this)(l, i), (*this)(i, l)) == rawZero)
+            {
+                leader[i] = l;
+                break;
+            }
+        }
+        if (leader[i] == i)
+        {
+            leaders.push_back(i);
+        }
+    }
+
+    auto add = [&](size_t i, size_t j) {
+        constraint_t c;
+        c.index = i * dim + j;
+        c.bound = toBound((*this)(i, j));
+        constraints.push_back(c);
+    };
+
+    /* Keep a cycle through every class. */
+    vector<size_t> last(dim);
+    for (size_t i = 0; i < dim; i++)
+    {
+        last[i] = i;
+    }
+    for (size_t i = 0; i < dim; i++)
+    {
+        size_t l = leader[i];
+        if (l != i)
+        {
+            add(last[l], i);
+            last[l] = i;
+        }
+    }
+    for (size_t l: leaders)
+    {
+        if (last[l] != l)
+        {
+            add(last[l], l);
+        }
+    }
+
+    /* Keep the constraints between leaders that are not implied. */
+    for (size_t i: leaders)
+    {
+        for (size_t j: leaders)
+        {
+            raw_t ij = (*this)(i, j);
+            if (i == j || ij == rawInfinity)
+            {
+                continue;
+            }
+            bool implied = false;
+            for (size_t k: leaders)
+            {
+                if (k != i && k != j && addRaw((*this)(i, k), (*this)(k, j)) <= ij)
+                {
+                    implied = true;
+                    break;
+                }
+            }
+            if (!implied)
+            {
+                add(i, j);
+            }
+        }
+    }
+
+    std::sort(constraints.begin(), constraints.end(),
+              [](const constraint_t &a, const constraint_t &b) { return a.index < b.index; });
+}
+
+/** Returns the implicit value of DBM entry (i, j). */
+static bound_t getDefault(int i, int j)
+{
+    return (i == 0 || i == j) ? bound_t::zero : bound_t::infinity;
+}
+
+TraceState::TraceState(const IntermediateModel &model):
+    model(&model),
+    clockCount(model.getClockCount()),
+    locations(model.getProcessCount()),
+    integers(model.getVariableCount())
+{
+}
+
+bound_t TraceState::getConstraint(int i, int j) const
+{
+    uint32_t index = i * clockCount + j;
+    auto it = std::lower_bound(
+        constraints.begin(), constraints.end(), index,
+        [](const constraint_t &c, uint32_t index) { return c.index < index; });
+    return (it != constraints.end() && it->index == index)
+        ? it->bound : getDefault(i, j);
+}
+
+void TraceState::expand(DBM &dbm) const
+{
+    dbm.init(clockCount);
+    for (auto &c: constraints)
+    {
+        dbm(c.getI(clockCount), c.getJ(clockCount)) = toRaw(c.bound);
+    }
+}
+
+void TraceState::assign(const TraceState &state)
+{
+    locations.assign(state.locations.begin(), state.locations.end());
+    integers.assign(state.integers.begin(), state.integers.end());
+    constraints.assign(state.constraints.begin(), state.constraints.end());
+}
+
+void TraceState::reset()
+{
+    std::fill(locations.begin(), locations.end(), 0);
+    std::fill(integers.begin(), integers.end(), 0);
+    constraints.clear();
+}
+
+/* Writes the entries in which current differs from previous as a
+ * count followed by pairs of an index gap and the new value.
+ */
+static void writeDelta(Output &out, const vector<int> &current,
+                       const vector<int> &previous)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < current.size(); i++)
+    {
+        count += current[i] != previous[i];
+    }
+    out.varint(count);
+    size_t next = 0;
+    for (size_t i = 0; i < current.size(); i++)
+    {
+        if (current[i] != previous[i])
+        {
+            out.varint(i - next);
+            out.integer(current[i]);
+            next = i + 1;
+        }
+    }
+}
+
+static void readDelta(Decoder &in, vector<int> &values)
+{
+    size_t i = 0;
+    for (uint64_t count = in.varint(); count > 0; count--)
+    {
+        i += in.varint();
+        if (i >= values.size())
+        {
+            in.error();
+        }
+        values[i++] = in.integer();
+    }
+}
+
+/* The zone is written as the indices of the constraints of previous
+ * that are gone, followed by the constraints that are new or have a
+ * different bound. Bounds are encoded like in the text format.
+ */
+void TraceState::writeDelta(Output &out, const TraceState &previous) const
+{
+    ::writeDelta(out, locations, previous.locations);
+    ::writeDelta(out, integers, previous.integers);
+
+    auto diff = [&](auto removed, auto changed) {
+        auto p = previous.constraints.begin(), pe = previous.constraints.end();
+        auto c = constraints.begin(), ce = constraints.end();
+        while (p != pe || c != ce)
+        {
+            if (c == ce || (p != pe && p->index < c->index))
+            {
+                removed(*p++);
+            }
+            else if (p == pe || c->index < p->index)
+            {
+                changed(*c++);
+            }
+            else
+            {
+                if (p->bound.value != c->bound.value || p->bound.strict != c->bound.strict)
+                {
+                    changed(*c);
+                }
+                ++p;
+                ++c;
+            }
+        }
+    };
+    auto ignore = [](const constraint_t &) {};
+
+    size_t removed = 0, changed = 0;
+    diff([&](const constraint_t &) { removed++; }, [&](const constraint_t &) { changed++; });
+    uint32_t next = 0;
+    out.varint(removed);
+    diff([&](const constraint_t &c) {
+            out.varint(c.index - next);
+            next = c.index + 1;
+        }, ignore);
+    next = 0;
+    out.varint(changed);
+    diff(ignore, [&](const constraint_t &c) {
+            out.varint(c.index - next);
+            out.integer(c.bound.value * 2 + c.bound.strict);
+            next = c.index + 1;
+        });
+}
+
+void TraceState::readDelta(Decoder &in)
+{
+    ::readDelta(in, locations);
+    auto &processes = model->getProcesses();
+    for (size_t p = 0; p < locations.size(); p++)
+    {
+        if (locations[p] < 0 || (size_t)locations[p] >= processes[p].locations.size())
+        {
+            in.error();
+        }
+    }
+    ::readDelta(in, integers);
+
+    /* Remove constraints. */
+    auto c = constraints.begin();
+    uint32_t index = 0;
+    merged.clear();
+    for (uint64_t count = in.varint(); count > 0; count--)
+    {
+        index += in.varint();
+        while (c != constraints.end() && c->index < index)
+        {
+            merged.push_back(*c++);
+        }
+        if (c == constraints.end() || c->index != index)
+        {
+            in.error();
+        }
+        ++c;
+        ++index;
+    }
+    merged.insert(merged.end(), c, constraints.end());
+    constraints.swap(merged);
+
+    /* Add or change constraints. */
+    c = constraints.begin();
+    index = 0;
+    merged.clear();
+    for (uint64_t count = in.varint(); count > 0; count--)
+    {
+        index += in.varint();
+        int bnd = in.integer();
+        if (index >= clockCount * clockCount)
+        {
+            in.error();
+        }
+        while (c != constraints.end() && c->index < index)
+        {
+            merged.push_back(*c++);
+        }
+        if (c != constraints.end() && c->index == index)
+        {
+            ++c;
+        }
+        constraint_t constraint;
+        constraint.index = index;
+        constraint.bound.value = bnd >> 1;
+        constraint.bound.strict = bnd & 1;
+        merged.push_back(constraint);
+        ++index;
+    }
+    merged.insert(merged.end(), c, constraints.end());
+    constraints.swap(merged);
+}
+
+void TraceState::read(Scanner &in)
+{
+    const char *context = "trace state";
+
+    /* Read locations.  */
+    auto &processes = model->getProcesses();
+    for (size_t p = 0; p < locations.size(); p++)
+    {
+        int l = in.next(context);
+        if (l < 0 || (size_t)l >= processes[p].locations.size())
+        {
+            in.error(context);
+        }
+        locations[p] = l;
+    }
+    in.dot(context);
+
+    /* Read DBM. */
+    constraints.clear();
+    bool sorted = true;
+    int i, j, bnd;
+    while (in.next(i))
+    {
+        j = in.next(context);
+        bnd = in.next(context);
+        if (i < 0 || (size_t)i >= clockCount || j < 0 || (size_t)j >= clockCount)
+        {
+            in.error(context);
+        }
+        in.dot(context);
+        constraint_t c;
+        c.index = i * clockCount + j;
+        c.bound.value = bnd >> 1;
+        c.bound.strict = bnd & 1;
+        sorted = sorted && (constraints.empty() || constraints.back().index < c.index);
+        constraints.push_back(c);
+    }
+    in.dot(context);
+
+    /* Sort constraints. A later constraint on the same entry
+     * overrides an earlier one.
+     */
+    if (!sorted)
+    {
+        std::stable_sort(
+            constraints.begin(), constraints.end(),
+            [](const constraint_t &a, const constraint_t &b) { return a.index < b.index; });
+        auto last = constraints.begin();
+        for (auto it = constraints.begin(); it != constraints.end(); ++it)
+        {
+            if (last->index != it->index)
+            {
+                ++last;
+            }
+            *last = *it;
+        }
+        constraints.erase(last + 1, constraints.end());
+    }
+
+    /* Read integers. */
+    for (auto &v: integers)
+    {
+        v = in.next(context);
+    }
+    in.dot(context);
+}
+
+void TraceTransition::read(Scanner &in)
+{
+    const char *context = "trace transition";
+    auto &processes = model->getProcesses();
+    int process, select;
+
+    edges.clear();
+    selects.clear();
+    while (in.next(process))
+    {
+        Edge e{process, in.number(context), selects.size(), 0};
+        while (in.number(select))
+        {
+            selects.push_back(select);
+        }
+        if (!in.accept(';'))
+        {
+            if (!in.atEol())
+            {
+                in.error(context);
+            }
+            // old format without ';' indexes edges from 1, hence convert to 0-base
+            e.edge--;
+        }
+        e.last = selects.size();
+        if (process < 0 || (size_t)process >= processes.size() || e.edge < 0
+            || (size_t)e.edge >= processes[process].edges.size())
+        {
+            in.error(context);
+        }
+        edges.push_back(e);
+    }
+    in.dot(context);
+}
+
+void TraceTransition::readBinary(Decoder &in)
+{
+    auto &processes = model->getProcesses();
+    edges.clear();
+    selects.clear();
+    for (uint64_t count = in.varint(); count > 0; count--)
+    {
+        Edge e;
+        e.process = in.varint();
+        e.edge = in.varint();
+        e.first = selects.size();
+        for (uint64_t n = in.varint(); n > 0; n--)
+        {
+            selects.push_back(in.integer());
+        }
+        e.last = selects.size();
+        if ((size_t)e.process >= processes.size()
+            || (size_t)e.edge >= processes[e.process].edges.size())
+        {
+            in.error();
+        }
+        edges.push_back(e);
+    }
+}
+
+void TraceTransition::writeBinary(Output &out) const
+{
+    out.varint(edges.size());
+    for (auto &e: edges)
+    {
+        out.varint(e.process);
+        out.varint(e.edge);
+        out.varint(e.last - e.first);
+        for (size_t s = e.first; s < e.last; s++)
+        {
+            out.integer(selects[s]);
+        }
+    }
+}
+
+TraceReader::TraceReader(const IntermediateModel &model, MappedFile &file):
+    TraceReader(model, file, 0, 0)
+{
+    if (binary)
+    {
+        if (decoder.varint() != model.getProcessCount()
+            || decoder.varint() != model.getVariableCount()
+            || decoder.varint() != model.getClockCount())
+        {
+            throw FormatException("The binary trace does not match the model");
+        }
+    }
+}
+
+TraceReader::TraceReader(const IntermediateModel &model, MappedFile &file,
+                         size_t offset, size_t step):
+    model(model),
+    file(file),
+    binary(size_t(file.end() - file.begin()) >= sizeof(magic) - 1
+           && memcmp(file.begin(), magic, sizeof(magic) - 1) == 0),
+    step(step),
+    scanner(file.begin() + offset, file.end()),
+    decoder(file.begin() + offset, file.end())
+{
+    if (binary && offset == 0)
+    {
+        decoder = Decoder(file.begin(), file.end());
+        for (size_t i = 0; i < sizeof(magic) - 1; i++)
+        {
+            decoder.byte();
+        }
+        if (decoder.varint() != version)
+        {
+            throw FormatException("Unsupported version of binary trace");
+        }
+    }
+}
+
+size_t TraceReader::getOffset() const
+{
+    return (binary ? decoder.position() : scanner.position()) - file.begin();
+}
+
+bool TraceReader::next(TraceState &state, TraceTransition &transition)
+{
+    if (binary)
+    {
+        switch (decoder.byte())
+        {
+        case END:
+            return false;
+        case KEYFRAME:
+            state.reset();
+            break;
+        case DELTA:
+            if (step % interval == 0)
+            {
+                decoder.error();
+            }
+            break;
+        default:
+            decoder.error();
+        }
+        state.readDelta(decoder);
+        if (step > 0)
+        {
+            transition.readBinary(decoder);
+        }
+    }
+    else
+    {
+        scanner.skipSpace();
+        if (step > 0 && scanner.accept('.'))
+        {
+            return false;
+        }
+        state.read(scanner);
+        if (step > 0)
+        {
+            transition.read(scanner);
+        }
+    }
+    step++;
+    return true;
+}
+
+void TraceReader::release()
+{
+    file.release(binary ? decoder.position() : scanner.position());
+}
+
+TraceWriter::TraceWriter(const IntermediateModel &model, FILE *file):
+    out(file), previous(model)
+{
+    out << string_view(TraceReader::magic, sizeof(TraceReader::magic) - 1);
+    out.varint(TraceReader::version);
+    out.varint(model.getProcessCount());
+    out.varint(model.getVariableCount());
+    out.varint(model.getClockCount());
+}
+
+void TraceWriter::write(const TraceState &state, const TraceTransition &transition)
+{
+    if (step % TraceReader::interval == 0)
+    {
+        out << char(TraceReader::KEYFRAME);
+        previous.reset();
+    }
+    else
+    {
+        out << char(TraceReader::DELTA);
+    }
+    state.writeDelta(out, previous);
+    if (step > 0)
+    {
+        transition.writeBinary(out);
+    }
+    previous.assign(state);
+    step++;
+}
+
+void TraceWriter::close()
+{
+    out << char(TraceReader::END);
+    out.flush();
+}
+
+Trace::Trace(const IntermediateModel &model, MappedFile &file):
+    reader(model, file), state(model), transition(model)
+{
+}
+
+bool Trace::next()
+{
+    if (reader.getStep() % 4096 == 0)
+    {
+        reader.release();
+    }
+    return reader.next(state, transition);
+}
+
+Trace::iterator Trace::begin()
+{
+    return iterator(next() ? this : nullptr);
+}
+
+Trace::step_t Trace::iterator::operator*() const
+{
+    return step_t{ trace->reader.getStep() - 1, trace->state, trace->transition };
+}
+
+Trace::iterator &Trace::iterator::operator++()
+{
+    if (!trace->next())
+    {
+        trace = nullptr;
+    }
+    return *this;
+}
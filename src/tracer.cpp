@@ -20,705 +20,1751 @@
    USA
 */
 
+#include "utap/trace.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <limits>
-#include <map>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <getopt.h>
+#include <sys/stat.h>
+
 /* This utility takes an UPPAAL model in the UPPAAL intermediate
  * format and a UPPAAL XTR trace file and prints trace to stdout in a
  * human readable format.
  *
- * The utility basically contains two parsers: One for the
- * intermediate format and one for the XTR format. You may want to use
- * them a starting point for writing analysis tools.
- *
- * Notice that the intermediate format uses a global numbering of
- * clocks, variables, locations, etc. This is in contrast to the XTR
- * format, which makes a clear distinction between e.g. clocks and
- * variables and uses process local number of locations and
- * edges. Care must be taken to convert between these two numbering
- * schemes.
+ * The parsers for the intermediate format and the XTR format are part
+ * of the library (see utap/trace.h). You may want to use them a
+ * starting point for writing analysis tools.
  */
 
-using std::ostream;
-using std::istream;
+using namespace UTAP;
+
 using std::ifstream;
-using std::cout;
 using std::cerr;
 using std::endl;
 using std::string;
+using std::string_view;
 using std::vector;
-using std::map;
 
+typedef IntermediateModel::cell_t cell_t;
+typedef IntermediateModel::process_t process_t;
+typedef IntermediateModel::edge_t edge_t;
 
-/* Representation of a memory cell.
- */
-struct cell_t
-{
-    enum type_t: int { CONST, CLOCK, VAR, META, SYS_META, COST, LOCATION, FIXED };
-    enum flags_t: int { NONE, COMMITTED, URGENT };
-    /** The type of the cell. */
-    type_t type;
-
-    /** Name of cell. Not all types have names. */
-    string name;
-
-    union
-    {
-        int value;
-        struct
-        {
-            int nr;
-        } clock;
-        struct
-        {
-            int min;
-            int max;
-            int init;
-            int nr;
-        } var;
-        struct
-        {
-            int min;
-            int max;
-            int init;
-            int nr;
-        } meta;
-        struct
-        {
-            int min;
-            int max;
-        } sys_meta;
-        struct
-        {
-            flags_t flags;
-            int process;
-            int invariant;
-        } location;
-        struct
-        {
-            int min;
-            int max;
-        } fixed;
-    };
-};
-
-/* Representation of a process.
+/* Output operator for a symbolic state. Prints the location vector,
+ * the variables and the zone of the symbolic state.
  */
-struct process_t
+Output &operator << (Output &o, const TraceState &state)
 {
-    int initial;
-    string name;
-    vector<int> locations;
-    vector<int> edges;
-};
+    const IntermediateModel& model = state.getModel();
+    auto& processes = model.getProcesses();
+    auto& variables = model.getVariables();
+    auto& clocks = model.getClocks();
 
-/* Representation of an edge.
- */
-struct edge_t
-{
-    int process;
-    int source;
-    int target;
-    int guard;
-    int sync;
-    int update;
-};
+    /* Print location vector. */
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        o << processes[p].name << '.'
+          << model.getLocationName(p, state.getLocation(p)) << ' ';
+    }
 
-/* The UPPAAL model in intermediate format.
- */
-static vector<cell_t> layout;
-static vector<int> instructions;
-static vector<process_t> processes;
-static vector<edge_t> edges;
-static map<int,string> expressions;
+    /* Print variables. */
+    for (size_t v = 0; v < variables.size(); v++)
+    {
+        o << variables[v] << '=' << state.getVariable(v) << ' ';
+    }
 
-/* For convenience we keep the size of the system here.
- */
-static size_t processCount = 0;
-static size_t variableCount = 0;
-static size_t clockCount = 0;
+    /* Print clocks. */
+    state.forEachBound([&](size_t i, size_t j, bound_t bnd) {
+        o << clocks[i] << '-' << clocks[j]
+          << (bnd.strict ? "<" : "<=") << (int)bnd.value << ' ';
+    });
 
-/* These are mappings from variable and clock indicies to
- * the names of these variables and clocks.
- */
-static vector<string> clocks;
-static vector<string> variables;
+    return o;
+}
 
-/* Thrown by parser upon parse errors.
+/* Output operator for a transition. Prints all edges in the
+ * transition including the source, destination, guard,
+ * synchronisation and assignment.
  */
-class invalid_format : public std::runtime_error
+Output &operator << (Output &o, const TraceTransition &t)
 {
-public:
-    explicit invalid_format(const string&  arg) : runtime_error(arg) {}
-};
+    const IntermediateModel& model = t.getModel();
+    auto& processes = model.getProcesses();
+    auto& layout = model.getLayout();
+    for (auto& edge: t.edges)
+    {
+        const edge_t& e = model.getEdge(edge.process, edge.edge);
+        o << processes[edge.process].name << '.' << layout[e.source].name
+          << " -> "
+          << processes[edge.process].name << '.' << layout[e.target].name;
+        if (edge.first != edge.last) {
+            o << " [" << t.selects[edge.first];
+            for (size_t s = edge.first + 1; s < edge.last; ++s) {
+                o << ',' << t.selects[s];
+            }
+            o << ']';
+        }
+        o << " {"
+          << model.getExpression(e.guard) << "; "
+          << model.getExpression(e.sync) << "; "
+          << model.getExpression(e.update) << ";} ";
+    }
+
+    return o;
+}
 
-/* Reads one line from file. Skips comments.
+/* Output formats of steps. */
+enum format_t { TEXT, JSON, CSV };
+
+/* Writes str to out quoted by quote. Characters for which escape()
+ * returns an escape sequence are replaced by it; runs of other
+ * characters are copied as a whole.
  */
-bool read(istream& file, string& str)
+template <typename Escape>
+static void putQuoted(Output& out, string_view str, char quote, Escape escape)
 {
-    do
+    out << quote;
+    size_t begin = 0;
+    for (size_t i = 0; i < str.size(); i++)
     {
-        if (!getline(file, str))
+        string_view sequence = escape(str[i]);
+        if (!sequence.empty())
         {
-            return false;
+            out << str.substr(begin, i - begin) << sequence;
+            begin = i + 1;
         }
-    } while (!str.empty() && str[0] == '#');
-    return true;
+    }
+    out << str.substr(begin) << quote;
 }
 
-/* Reads one line and asserts that it contains a (terminating) dot
- */
-istream& readdot(istream& is)
+/* Writes str as a JSON string. */
+static void putJSON(Output& out, string_view str)
 {
-    string str;
-    getline(is, str);
-    if (str.empty())
-    {
-        getline(is, str);
-    }
-    if (str != ".")
-    {
-        cerr << "Expecting a line with '.' but got '" << str << "'" << endl;
-        assert(false);
-        exit(EXIT_FAILURE);
-    }
-    return is;
+    static const char* control[] = {
+        "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005", "\\u0006", "\\u0007",
+        "\\b", "\\t", "\\n", "\\u000b", "\\f", "\\r", "\\u000e", "\\u000f",
+        "\\u0010", "\\u0011", "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+        "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d", "\\u001e", "\\u001f"
+    };
+    putQuoted(out, str, '"', [](char c) -> string_view {
+            if (c == '"')
+            {
+                return "\\\"";
+            }
+            if (c == '\\')
+            {
+                return "\\\\";
+            }
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                return control[static_cast<unsigned char>(c)];
+            }
+            return string_view();
+        });
 }
 
-inline
-istream& skipspaces(istream& is)
+/* Writes str as a quoted CSV field. */
+static void putCSV(Output& out, string_view str)
 {
-    while (is.peek() == ' ')
-    {
-        is.get();
-    }
-    return is;
+    putQuoted(out, str, '"', [](char c) -> string_view {
+            return c == '"' ? "\"\"" : string_view();
+        });
 }
 
-/* Parser for intermediate format.
- */
-void loadIF(istream& file)
+/* Prints a step as a JSON object on a single line. */
+static void printJSON(Output& out, size_t step, const TraceState& state,
+                      const TraceTransition& transition)
 {
-    string str;
-    string section;
-    char name[32];
-    int index;
+    const IntermediateModel& model = state.getModel();
+    auto& processes = model.getProcesses();
+    auto& layout = model.getLayout();
+    auto& variables = model.getVariables();
+    auto& clocks = model.getClocks();
+
+    out << "{\"step\":" << (int)step;
 
-    while (getline(file, section))
+    if (step > 0)
     {
-        if (section == "layout")
+        out << ",\"transition\":[";
+        for (auto& edge: transition.edges)
         {
-            cell_t cell;
-            while (read(file, str) && !str.empty() && !isspace(str[0]))
+            const edge_t& e = model.getEdge(edge.process, edge.edge);
+            out << (&edge == &transition.edges.front() ? "{" : ",{")
+                << "\"process\":";
+            putJSON(out, processes[edge.process].name);
+            out << ",\"source\":";
+            putJSON(out, layout[e.source].name);
+            out << ",\"target\":";
+            putJSON(out, layout[e.target].name);
+            out << ",\"select\":[";
+            for (size_t s = edge.first; s < edge.last; s++)
             {
-                char s[6];
-                auto cstr = str.c_str();
-
-                if (sscanf(cstr, "%d:clock:%d:%31s", &index,
-                           &cell.clock.nr, name) == 3)
-                {
-                    cell.type = cell_t::CLOCK;
-                    cell.name = name;
-                    clocks.emplace_back(name);
-                    clockCount++;
-                }
-                else if (sscanf(cstr, "%d:const:%d", &index,
-                                &cell.value) == 2)
-                {
-                    cell.type = cell_t::CONST;
-                }
-                else if (sscanf(cstr, "%d:var:%d:%d:%d:%d:%31s", &index,
-                                &cell.var.min, &cell.var.max, &cell.var.init,
-                                &cell.var.nr, name) == 6)
-                {
-                    cell.type = cell_t::VAR;
-                    cell.name = name;
-                    variables.emplace_back(name);
-                    variableCount++;
-                }
-                else if (sscanf(cstr, "%d:meta:%d:%d:%d:%d:%31s", &index,
-                                &cell.meta.min, &cell.meta.max, &cell.meta.init,
-                                &cell.meta.nr, name) == 6)
-                {
-                    cell.type = cell_t::META;
-                    cell.name = name;
-                    variables.emplace_back(name);
-                    variableCount++;
-                }
-                else if (sscanf(cstr, "%d:sys_meta:%d:%d:%31s", &index,
-                                &cell.sys_meta.min, &cell.sys_meta.max, name) == 4)
-                {
-                    cell.type = cell_t::SYS_META;
-                    cell.name = name;
-                }
-                else if (sscanf(cstr, "%d:location::%31s", &index, name) == 2)
-                {
-                    cell.type = cell_t::LOCATION;
-                    cell.location.flags = cell_t::NONE;
-                    cell.name = name;
-                }
-                else if (sscanf(cstr, "%d:location:committed:%31s", &index, name) == 2)
-                {
-                    cell.type = cell_t::LOCATION;
-                    cell.location.flags = cell_t::COMMITTED;
-                    cell.name = name;
-                }
-                else if (sscanf(cstr, "%d:location:urgent:%31s", &index, name) == 2)
-                {
-                    cell.type = cell_t::LOCATION;
-                    cell.location.flags = cell_t::URGENT;
-                    cell.name = name;
-                }
-                else if (sscanf(cstr, "%d:static:%d:%d:%31s", &index,
-                                &cell.fixed.min, &cell.fixed.max,
-                                name) == 4)
-                {
-                    cell.type = cell_t::FIXED;
-                    cell.name = name;
-                }
-                else if (sscanf(cstr, "%d:%5s", &index, s) == 2
-                         && strcmp(s, "cost") == 0)
-                {
-                    cell.type = cell_t::COST;
-                }
-                else
+                if (s > edge.first)
                 {
-                    throw invalid_format(str);
+                    out << ',';
                 }
-
-                layout.push_back(cell);
+                out << transition.selects[s];
             }
-#if defined(ENABLE_CORA) || defined(ENABLE_PRICED)
-            cell.type = cell_t::VAR;
-            cell.var.min = std::numeric_limits<int32_t>::min();
-            cell.var.max = std::numeric_limits<int32_t>::max();
-            cell.var.init = 0;
-
-            cell.name = "infimum_cost";
-            cell.var.nr = variableCount++;
-            variables.push_back(cell.name);
-            layout.push_back(cell);
-
-            cell.name = "offset_cost";
-            cell.var.nr = variableCount++;
-            variables.push_back(cell.name);
-            layout.push_back(cell);
-
-            for (size_t i=1; i<clocks.size(); ++i) {
-                cell.name = "#rate[";
-                cell.name.append(clocks[i]);
-                cell.name.append("]");
-                cell.var.nr = variableCount++;
-                variables.push_back(cell.name);
-                layout.push_back(cell);
-            }
-#endif
+            out << "],\"guard\":";
+            putJSON(out, model.getExpression(e.guard));
+            out << ",\"sync\":";
+            putJSON(out, model.getExpression(e.sync));
+            out << ",\"update\":";
+            putJSON(out, model.getExpression(e.update));
+            out << '}';
         }
-        else if (section == "instructions")
-        {
-            while (read(file, str) && !str.empty() && (!isspace(str[0]) || str[0]=='\t'))
-            {
-                int address;
-                int values[4];
-                if (str[0]=='\t')
-                {   // skip pretty-printed instruction text
-                    continue;
-                }
-                int cnt = sscanf(str.c_str(), "%d:%d%d%d%d", &address,
-                                 &values[0], &values[1], &values[2], &values[3]);
-                if (cnt < 2)
-                {
-                    throw invalid_format("In instruction section");
-                }
+        out << ']';
+    }
 
-                for (int i = 0; i < cnt-1; ++i)
-                {
-                    instructions.push_back(values[i]);
-                }
-            }
-        }
-        else if (section == "processes")
+    out << ",\"locations\":{";
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        if (p > 0)
         {
-            while (read(file, str) && !str.empty() && !isspace(str[0]))
-            {
-                process_t process;
-                if (sscanf(str.c_str(), "%d:%d:%31s",
-                           &index, &process.initial, name) != 3)
-                {
-                    throw invalid_format("In process section");
-                }
-                process.name = name;
-                processes.push_back(process);
-                processCount++;
-            }
+            out << ',';
         }
-        else if (section == "locations")
+        putJSON(out, processes[p].name);
+        out << ':';
+        putJSON(out, model.getLocationName(p, state.getLocation(p)));
+    }
+
+    out << "},\"variables\":{";
+    for (size_t v = 0; v < variables.size(); v++)
+    {
+        if (v > 0)
         {
-            while (read(file, str) && !str.empty() && !isspace(str[0]))
-            {
-                int index;
-                int process;
-                int invariant;
+            out << ',';
+        }
+        putJSON(out, variables[v]);
+        out << ':' << state.getVariable(v);
+    }
 
-                if (sscanf(str.c_str(), "%d:%d:%d", &index, &process, &invariant) != 3)
-                {
-                    throw invalid_format("In location section");
-                }
+    /* Each bound x_i - x_j < or <= c becomes [x_i, x_j, "<" or "<=", c]. */
+    out << "},\"zone\":[";
+    bool first = true;
+    state.forEachBound([&](size_t i, size_t j, bound_t bnd) {
+        out << (first ? "[" : ",[");
+        putJSON(out, clocks[i]);
+        out << ',';
+        putJSON(out, clocks[j]);
+        out << (bnd.strict ? ",\"<\"," : ",\"<=\",") << (int)bnd.value << ']';
+        first = false;
+    });
+    out << "]}\n";
+}
 
-                layout[index].location.process = process;
-                layout[index].location.invariant = invariant;
-                processes[process].locations.push_back(index);
-            }
-        }
-        else if (section == "edges")
-        {
-            while (read(file, str) && !str.empty() && !isspace(str[0]))
-            {
-                edge_t edge;
+/* Prints the header of the CSV format: the step, the transition, a
+ * column per process and variable, and the zone as a conjunction.
+ */
+static void printCSVHeader(Output& out, const IntermediateModel& model)
+{
+    out << "step,transition";
+    for (auto& process: model.getProcesses())
+    {
+        out << ',';
+        putCSV(out, process.name);
+    }
+    for (auto& variable: model.getVariables())
+    {
+        out << ',';
+        putCSV(out, variable);
+    }
+    out << ",zone\n";
+}
 
-                if (sscanf(str.c_str(), "%d:%d:%d:%d:%d:%d", &edge.process,
-                           &edge.source, &edge.target,
-                           &edge.guard, &edge.sync, &edge.update) != 6)
-                {
-                    throw invalid_format("In edge section");
-                }
+/* Prints a step as a CSV row. The transition is given as the edges
+ * source->target separated by spaces.
+ */
+static void printCSV(Output& out, size_t step, const TraceState& state,
+                     const TraceTransition& transition)
+{
+    const IntermediateModel& model = state.getModel();
+    auto& layout = model.getLayout();
+    auto& clocks = model.getClocks();
 
-                processes[edge.process].edges.push_back(edges.size());
-                edges.push_back(edge);
-            }
-        }
-        else if (section == "expressions")
+    out << (int)step << ",\"";
+    if (step > 0)
+    {
+        for (auto& edge: transition.edges)
         {
-            while (read(file, str) && !str.empty() && !isspace(str[0]))
+            const edge_t& e = model.getEdge(edge.process, edge.edge);
+            if (&edge != &transition.edges.front())
             {
-                if (sscanf(str.c_str(), "%d", &index) != 1)
-                {
-                    throw invalid_format("In expression section");
-                }
-
-                /* Find expression string (after the third colon). */
-                auto *s = str.c_str();
-                int cnt = 3;
-                while (cnt && *s)
-                {
-                    cnt -= (*s == ':');
-                    s++;
-                }
-                if (cnt)
-                {
-                    throw invalid_format("In expression section");
-                }
-
-                /* Trim white space. */
-                while (*s && isspace(*s))
-                {
-                    s++;
-                }
-                auto *t = s + strlen(s) - 1;
-                while (t >= s && isspace(*t))
-                {
-                    t--;
-                }
-
-                expressions[index] = string(s, t+1);
+                out << ' ';
             }
+            out << layout[e.source].name << "->" << layout[e.target].name;
         }
-        else
+    }
+    out << '"';
+    for (size_t p = 0; p < model.getProcessCount(); p++)
+    {
+        out << ',';
+        putCSV(out, model.getLocationName(p, state.getLocation(p)));
+    }
+    for (size_t v = 0; v < model.getVariableCount(); v++)
+    {
+        out << ',' << state.getVariable(v);
+    }
+    out << ",\"";
+    bool first = true;
+    state.forEachBound([&](size_t i, size_t j, bound_t bnd) {
+        out << (first ? "" : " && ") << clocks[i] << '-' << clocks[j]
+            << (bnd.strict ? "<" : "<=") << (int)bnd.value;
+        first = false;
+    });
+    out << "\"\n";
+}
+
+/* Prints what precedes the steps in the given format. */
+static void printHeader(Output& out, const IntermediateModel& model,
+                        format_t format)
+{
+    if (format == CSV)
+    {
+        printCSVHeader(out, model);
+    }
+}
+
+/* Prints a step in the given format. */
+static void printStep(Output& out, format_t format, size_t step,
+                      const TraceState& state, const TraceTransition& transition)
+{
+    switch (format)
+    {
+    case TEXT:
+        if (step > 0)
         {
-            throw invalid_format("Unknown section");
+            out << "\nTransition: " << transition << "\n\n";
         }
+        out << "State: " << state << '\n';
+        break;
+    case JSON:
+        printJSON(out, step, state, transition);
+        break;
+    case CSV:
+        printCSV(out, step, state, transition);
+        break;
     }
-};
+}
 
-/* A bound for a clock constraint. A bound consists of a value and a
- * bit indicating whether the bound is strict or not.
+/* Reads and prints a trace file. The trace is streamed through a
+ * single state and transition buffer, so memory use does not depend
+ * on the length of the trace. Returns the number of states.
  */
-struct bound_t
+size_t loadTrace(const IntermediateModel& model, MappedFile& file,
+                 Output& out, format_t format)
 {
-    int value   : 31; // The value of the bound
-    bool strict : 1;  // True if the bound is strict
-};
-
-/* The bound (infinity, <).
- */
-static bound_t infinity = { std::numeric_limits<int32_t>::max() >> 1, true };
+    Trace trace(model, file);
+    printHeader(out, model, format);
+    for (auto step: trace)
+    {
+        printStep(out, format, step.number, step.state, step.transition);
+    }
+    return trace.getSteps();
+}
 
-/* The bound (0, <=).
+/* Converts a trace to the binary format. Returns the number of
+ * states.
  */
-static bound_t zero = { 0, false };
+size_t convertTrace(const IntermediateModel& model, MappedFile& file, FILE* output)
+{
+    Trace trace(model, file);
+    TraceWriter writer(model, output);
+    for (auto step: trace)
+    {
+        writer.write(step.state, step.transition);
+    }
+    writer.close();
+    return trace.getSteps();
+}
 
-/* A symbolic state. A symbolic state consists of a location vector, a
- * variable vector and a zone describing the possible values of the
- * clocks in a symbolic manner.
+/* Checks the states and transitions of a trace against the model:
+ * zones must be non-empty, variables within their ranges, and the
+ * edges of a transition must lead from the locations of the source
+ * state to those of the target state. Inconsistencies are reported
+ * one per line.
  */
-class State
+class Validator
 {
 public:
-    State();
-    explicit State(istream& file);
-    State(const State& s) = delete;
-    State(State&& s) = delete;
-    ~State();
-
-    int &getLocation(int i)              { return locations[i]; }
-    int &getVariable(int i)              { return integers[i]; }
-    bound_t &getConstraint(int i, int j) { return dbm[i * clockCount + j]; }
-
-    int getLocation(int i) const              { return locations[i]; }
-    int getVariable(int i) const              { return integers[i]; }
-    bound_t getConstraint(int i, int j) const { return dbm[i * clockCount + j]; }
+    Validator(const IntermediateModel& model, Output& out);
+
+    void checkState(size_t step, const TraceState& state);
+    void checkTransition(size_t step, const TraceState& source,
+                         const TraceTransition& transition, const TraceState& target);
+
+    /* Reports that the trace could not be read beyond step. */
+    void reportFailure(size_t step, const char* what);
+
+    size_t getErrors() const { return errors; }
 private:
-    vector<int> locations;
-    vector<int> integers;
-    bound_t *dbm;
-    void allocate();
+    const IntermediateModel& model;
+    Output& out;
+    DBM dbm;
+    vector<size_t> clocks;        // Clocks of the zone in dbm
+    vector<size_t> index;         // Index of a clock in dbm or 0
+    vector<const cell_t*> cells;  // Layout cells of the variables
+    vector<size_t> moved;         // Last step in which a process moved
+    size_t errors = 0;
+
+    Output& report(size_t step);
+    Output& location(int process, int location);
 };
 
-State::~State()
+Validator::Validator(const IntermediateModel& model, Output& out):
+    model(model), out(out),
+    index(model.getClockCount(), 0), moved(model.getProcessCount(), 0)
 {
-    delete[] dbm;
+    for (auto& cell: model.getLayout())
+    {
+        if (cell.type == cell_t::VAR || cell.type == cell_t::META)
+        {
+            cells.push_back(&cell);
+        }
+    }
 }
 
-State::State()
+Output& Validator::report(size_t step)
 {
-    /* Allocate. */
-    locations.resize(processCount);
-    integers.resize(variableCount);
-    dbm = new bound_t[clockCount * clockCount];
+    errors++;
+    return out << "Step " << (int)step << ": ";
+}
 
-    /* Fill with default values. */
-    std::fill(dbm, dbm + clockCount * clockCount, infinity);
+Output& Validator::location(int process, int location)
+{
+    return out << model.getProcesses()[process].name << '.'
+               << model.getLayout()[location].name;
+}
 
-    /* Set diagonal and lower bounds to zero. */
-    for (size_t i = 0; i < clockCount; i++)
-    {
-        getConstraint(0, i) = zero;
-        getConstraint(i, i) = zero;
-    }
+void Validator::reportFailure(size_t step, const char* what)
+{
+    report(step) << "unreadable trace: " << what << "\n";
 }
 
-State::State(istream& file): State()
+void Validator::checkState(size_t step, const TraceState& state)
 {
-    /* Read locations.  */
-    for (auto& l: locations)
+    size_t n = model.getClockCount();
+
+    /* A clock without explicit constraints is only bounded by the
+     * implicit x_0 - x_i <= 0 and cannot be on a negative cycle, so
+     * the zone is closed on the constrained clocks only.
+     */
+    auto& constraints = state.getConstraints();
+    clocks.assign(1, 0);
+    for (auto& c: constraints)
     {
-        file >> l;
+        for (size_t x: { c.getI(n), c.getJ(n) })
+        {
+            if (x != 0 && index[x] == 0)
+            {
+                index[x] = clocks.size();
+                clocks.push_back(x);
+            }
+        }
     }
-    file >> readdot;
-
-    /* Read DBM. */
-    int i, j, bnd;
-    while (file >> i >> j >> bnd)
+    /* Bounds too large for the closure make the trace malformed. */
+    bool safe = true;
+    for (auto& c: constraints)
+    {
+        if (!isRawSafe(c.bound, clocks.size()))
+        {
+            auto& names = model.getClocks();
+            report(step) << "bound " << c.bound.value << " of "
+                         << names[c.getI(n)] << '-' << names[c.getJ(n)]
+                         << " is out of range\n";
+            safe = false;
+        }
+    }
+    if (safe)
+    {
+        dbm.init(clocks.size());
+        for (auto& c: constraints)
+        {
+            dbm(index[c.getI(n)], index[c.getJ(n)]) = toRaw(c.bound);
+        }
+        if (!dbm.close())
+        {
+            report(step) << "empty zone\n";
+        }
+    }
+    for (size_t x: clocks)
     {
-        file >> readdot;
-        getConstraint(i, j).value = bnd >> 1;
-        getConstraint(i, j).strict = bnd & 1;
+        index[x] = 0;
     }
-    file.clear();
-    file >> readdot;
 
-    /* Read integers. */
-    for (auto& v: integers)
+    for (size_t v = 0; v < cells.size(); v++)
     {
-        file >> v;
+        const cell_t& cell = *cells[v];
+        int min = cell.type == cell_t::VAR ? cell.var.min : cell.meta.min;
+        int max = cell.type == cell_t::VAR ? cell.var.max : cell.meta.max;
+        int value = state.getVariable(v);
+        if (value < min || value > max)
+        {
+            report(step) << cell.name << " = " << value
+                         << " is out of range [" << min << ',' << max << "]\n";
+        }
     }
-    file >> readdot;
 }
 
-struct Edge
+void Validator::checkTransition(size_t step, const TraceState& source,
+                                 const TraceTransition& transition,
+                                 const TraceState& target)
 {
-    int process;
-    int edge;
-    vector<int> select;
-};
+    auto& processes = model.getProcesses();
+    for (auto& edge: transition.edges)
+    {
+        int p = edge.process;
+        const edge_t& e = model.getEdge(p, edge.edge);
+        int src = processes[p].locations[source.getLocation(p)];
+        int dst = processes[p].locations[target.getLocation(p)];
+        if (moved[p] == step)
+        {
+            report(step) << processes[p].name << " takes more than one edge\n";
+        }
+        moved[p] = step;
+        if (e.source != src)
+        {
+            report(step);
+            location(p, e.source) << " -> ";
+            location(p, e.target) << " does not start in ";
+            location(p, src) << '\n';
+        }
+        if (e.target != dst)
+        {
+            report(step);
+            location(p, e.source) << " -> ";
+            location(p, e.target) << " does not end in ";
+            location(p, dst) << '\n';
+        }
+    }
+
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        if (moved[p] != step && source.getLocation(p) != target.getLocation(p))
+        {
+            report(step) << processes[p].name << " moves from ";
+            location(p, processes[p].locations[source.getLocation(p)]) << " to ";
+            location(p, processes[p].locations[target.getLocation(p)])
+                << " without an edge\n";
+        }
+    }
+}
 
-/* A transition consists of one or more edges. Edges are indexes from
- * 0 in the order they appear in the input file.
+/* Reads and checks a trace file without printing it. Two state
+ * buffers hold the source and target of the current transition. A
+ * trace that cannot be read to its end counts as an error. Returns
+ * the number of states read.
  */
-struct Transition
+size_t validateTrace(const IntermediateModel& model, MappedFile& file,
+                     Validator& validator)
 {
-    vector<Edge> edges;
-    explicit Transition(istream& file);
-};
+    TraceReader reader(model, file);
+    TraceState states[2] = { TraceState(model), TraceState(model) };
+    TraceState* source = &states[0];
+    TraceState* target = &states[1];
+    TraceTransition transition(model);
 
-Transition::Transition(istream& file)
-{
-    int process, edge, select;
-    while (file >> process >> edge)
+    try
     {
-        Edge e{process, edge};
-        file >> skipspaces;
-        while (file.peek()!='\n' && file.peek()!=';')
+        reader.next(*source, transition);
+        validator.checkState(0, *source);
+        for (;;)
         {
-            if (file >> select)
+            /* Steps of binary traces are changes to the previous one. */
+            target->assign(*source);
+            if (!reader.next(*target, transition))
             {
-                e.select.push_back(select);
+                break;
             }
-            else
+            size_t step = reader.getStep() - 1;
+            validator.checkState(step, *target);
+            validator.checkTransition(step, *source, transition, *target);
+            std::swap(source, target);
+            if (step % 4096 == 0)
             {
-                cerr << "Transition format error" << endl;
-                exit(EXIT_FAILURE);
+                reader.release();
             }
-            file >> skipspaces;
         }
-        if (file.get()=='\n') // old format without ';'
-        {   // old format indexes edges from 1, hence convert to 0-base
-            e.edge--;
-        }
-        edges.push_back(e);
     }
-    file.clear();
-    file >> readdot;
+    catch (std::exception& e)
+    {
+        validator.reportFailure(reader.getStep(), e.what());
+    }
+    return reader.getStep();
 }
 
-/* Output operator for a symbolic state. Prints the location vector,
- * the variables and the zone of the symbolic state.
+/* A sparse index of a trace file holding the offset of every
+ * interval-th step. The index is cached in a file next to the trace
+ * (the name of the trace followed by .idx) and rebuilt whenever the
+ * size or modification time of the trace no longer match.
  */
-ostream &operator << (ostream &o, const State &state)
+class TraceIndex
 {
-    /* Print location vector. */
-    for (size_t p = 0; p < processCount; p++)
+public:
+    static constexpr uint64_t interval = TraceReader::interval;
+
+    /* Loads or builds the index of the trace of model at path. */
+    TraceIndex(const IntermediateModel& model, const char* path, MappedFile& trace);
+
+    const IntermediateModel& getModel() const { return model; }
+
+    /* Returns the number of steps in the trace. */
+    size_t getSteps() const { return steps; }
+
+    /* Reads step into state and transition. Returns a reader
+     * positioned after the step.
+     */
+    TraceReader seek(size_t step, TraceState& state, TraceTransition& transition) const;
+private:
+    const IntermediateModel& model;
+    MappedFile& trace;
+    uint64_t steps;
+    vector<uint64_t> offsets;
+
+    struct header_t
     {
-        int idx = processes[p].locations[state.getLocation(p)];
-        cout << processes[p].name << '.' << layout[idx].name << " ";
-    }
+        char magic[8];
+        uint64_t size;
+        uint64_t mtime;         // In nanoseconds
+        uint64_t interval;
+        uint64_t steps;
+        uint64_t count;
+    };
 
-    /* Print variables. */
-    for (size_t v = 0; v < variableCount; v++)
+    bool load(const string& file, const header_t& expected);
+    void build(const char* path);
+    void save(const string& file, header_t header) const;
+};
+
+TraceIndex::TraceIndex(const IntermediateModel& model, const char* path,
+                       MappedFile& trace):
+    model(model), trace(trace), steps(0)
+{
+    if (strcmp(path, "-") == 0)
     {
-        cout << variables[v] << "=" << state.getVariable(v) << ' ';
+        build(path);
+        return;
     }
 
-    /* Print clocks. */
-    for (size_t i = 0; i < clockCount; i++)
+    struct stat st;
+    header_t header = { { 'X', 'T', 'R', 'I', 'D', 'X', '2', '\n' } };
+    if (stat(path, &st) == 0)
     {
-        for (size_t j = 0; j < clockCount; j++)
-        {
-            if (i != j)
-            {
-                bound_t bnd = state.getConstraint(i, j);
-
-                if (bnd.value != infinity.value)
-                {
-                    cout << clocks[i] << "-" << clocks[j]
-                         << (bnd.strict ? "<" : "<=") << bnd.value << " ";
-                }
-            }
-        }
+        header.size = st.st_size;
+        header.mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
     }
+    header.interval = interval;
 
-    return o;
+    string file = string(path) + ".idx";
+    if (!load(file, header))
+    {
+        build(path);
+        save(file, header);
+    }
 }
 
-/* Output operator for a transition. Prints all edges in the
- * transition including the source, destination, guard,
- * synchronisation and assignment.
- */
-ostream &operator << (ostream &o, const Transition &t)
+bool TraceIndex::load(const string& file, const header_t& expected)
 {
-    for (auto& edge: t.edges)
+    ifstream is(file, std::ios::binary);
+    header_t header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+        || header.size != expected.size || header.mtime != expected.mtime
+        || header.interval != expected.interval)
     {
-        int eid = processes[edge.process].edges[edge.edge];
-        int src = edges[eid].source;
-        int dst = edges[eid].target;
-        int guard = edges[eid].guard;
-        int sync = edges[eid].sync;
-        int update = edges[eid].update;
-        cout << processes[edge.process].name << '.' << layout[src].name
-             << " -> "
-             << processes[edge.process].name << '.' << layout[dst].name;
-        if (!edge.select.empty()) {
-            auto s=edge.select.begin(), se=edge.select.end();
-            cout << " [" << *s;
-            while (++s != se) cout << "," << *s;
-            cout << "]";
-        }
-        cout << " {"
-             << expressions[guard] << "; " << expressions[sync] << "; " << expressions[update]
-             << ";} ";
+        return false;
     }
-
-    return o;
+    offsets.resize(header.count);
+    if (!is.read(reinterpret_cast<char*>(offsets.data()),
+                 header.count * sizeof(uint64_t)))
+    {
+        offsets.clear();
+        return false;
+    }
+    steps = header.steps;
+    return true;
 }
 
-/* Read and print a trace file.
+/* Reads the whole trace. A trace that cannot be read is reported by
+ * throwing a FormatException naming its path.
  */
-void loadTrace(istream& file)
+void TraceIndex::build(const char* path)
 {
-    /* Read and print trace. */
-    cout << "State: " << State(file) << endl;
-    for (;;)
+    TraceReader reader(model, trace);
+    TraceState state(model);
+    TraceTransition transition(model);
+    offsets.clear();
+    try
+    {
+        for (;;)
+        {
+            if (reader.getStep() % interval == 0)
+            {
+                offsets.push_back(reader.getOffset());
+            }
+            if (!reader.next(state, transition))
+            {
+                break;
+            }
+            if (reader.getStep() % 4096 == 0)
+            {
+                reader.release();
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        throw FormatException(string(path) + ": step "
+                              + std::to_string(reader.getStep()) + ": " + e.what());
+    }
+    steps = reader.getStep();
+}
+
+/* Failing to write the cache is not an error: the index is simply
+ * rebuilt next time.
+ */
+void TraceIndex::save(const string& file, header_t header) const
+{
+    std::ofstream os(file, std::ios::binary);
+    header.steps = steps;
+    header.count = offsets.size();
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(offsets.data()),
+             offsets.size() * sizeof(uint64_t));
+    os.close();
+    if (!os)
+    {
+        std::remove(file.c_str());
+    }
+}
+
+TraceReader TraceIndex::seek(size_t step, TraceState& state,
+                             TraceTransition& transition) const
+{
+    assert(step < steps);
+    TraceReader reader(model, trace, offsets[step / interval], step / interval * interval);
+    while (reader.getStep() <= step)
+    {
+        reader.next(state, transition);
+    }
+    return reader;
+}
+
+/* A conjunction of simple conditions on a state, separated by &&. A
+ * condition is either P.L, meaning that process P is in location L,
+ * or x op c for a variable x, an integer c and op one of ==, !=, <,
+ * <=, > and >=.
+ */
+class Predicate
+{
+public:
+    Predicate(const IntermediateModel& model, string_view text);
+    bool operator()(const TraceState& state) const;
+private:
+    enum op_t { EQ, NEQ, LT, LE, GT, GE, LOCATION };
+    struct condition_t
+    {
+        op_t op;
+        int index;  // Variable or process
+        int value;  // Constant or location
+    };
+    vector<condition_t> conditions;
+};
+
+static string_view trim(string_view str)
+{
+    while (!str.empty() && isspace(static_cast<unsigned char>(str.front())))
+    {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && isspace(static_cast<unsigned char>(str.back())))
+    {
+        str.remove_suffix(1);
+    }
+    return str;
+}
+
+Predicate::Predicate(const IntermediateModel& model, string_view text)
+{
+    auto& processes = model.getProcesses();
+    auto& variables = model.getVariables();
+
+    static const std::pair<const char*, op_t> ops[] = {
+        { "==", EQ }, { "!=", NEQ }, { "<=", LE }, { ">=", GE },
+        { "<", LT }, { ">", GT }
+    };
+
+    while (!text.empty())
     {
-        /* Skip white space. */
-        file >> skipspaces;
+        size_t end = text.find("&&");
+        string_view str = trim(text.substr(0, end));
+        text = (end == string_view::npos) ? string_view() : text.substr(end + 2);
 
-        /* A dot terminates the trace. */
-        if (file.peek() == '.')
+        condition_t condition = { LOCATION, -1, -1 };
+        for (auto& op: ops)
         {
-            file.get();
+            size_t pos = str.find(op.first);
+            if (pos == string_view::npos)
+            {
+                continue;
+            }
+            string_view name = trim(str.substr(0, pos));
+            string_view value = trim(str.substr(pos + strlen(op.first)));
+            for (size_t v = 0; v < variables.size(); v++)
+            {
+                if (variables[v] == name)
+                {
+                    condition.index = v;
+                }
+            }
+            auto result = std::from_chars(value.data(), value.data() + value.size(),
+                                          condition.value);
+            if (condition.index < 0 || result.ec != std::errc()
+                || result.ptr != value.data() + value.size())
+            {
+                throw FormatException("In predicate: " + string(str));
+            }
+            condition.op = op.second;
             break;
         }
+        if (condition.op == LOCATION)
+        {
+            for (size_t p = 0; p < processes.size(); p++)
+            {
+                const string& process = processes[p].name;
+                if (str.size() > process.size() && str[process.size()] == '.'
+                    && str.substr(0, process.size()) == process)
+                {
+                    for (size_t l = 0; l < processes[p].locations.size(); l++)
+                    {
+                        if (model.getLocationName(p, l) == str.substr(process.size() + 1))
+                        {
+                            condition.index = p;
+                            condition.value = l;
+                        }
+                    }
+                }
+            }
+            if (condition.index < 0)
+            {
+                throw FormatException("In predicate: " + string(str));
+            }
+        }
+        conditions.push_back(condition);
+    }
+}
 
-        /* Read a state and a transition. */
-        State state(file);
-        Transition transition(file);
+bool Predicate::operator()(const TraceState& state) const
+{
+    for (auto& c: conditions)
+    {
+        int x = c.op == LOCATION ? state.getLocation(c.index) : state.getVariable(c.index);
+        bool holds;
+        switch (c.op)
+        {
+        case EQ:  holds = x == c.value; break;
+        case NEQ: holds = x != c.value; break;
+        case LT:  holds = x < c.value; break;
+        case LE:  holds = x <= c.value; break;
+        case GT:  holds = x > c.value; break;
+        case GE:  holds = x >= c.value; break;
+        default:  holds = x == c.value; break;
+        }
+        if (!holds)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-        /* Print transition and state. */
-        cout << "\nTransition: " << transition << endl
-             << "\nState: " << state << endl;
+/* Prints the steps first to last of a trace. */
+void printSteps(const TraceIndex& index, Output& out, format_t format,
+                size_t first, size_t last)
+{
+    const IntermediateModel& model = index.getModel();
+    TraceState state(model);
+    TraceTransition transition(model);
+    TraceReader reader = index.seek(first, state, transition);
+    printHeader(out, model, format);
+    printStep(out, format, first, state, transition);
+    for (size_t step = first + 1; step <= last; step++)
+    {
+        reader.next(state, transition);
+        printStep(out, format, step, state, transition);
     }
 }
 
+/* Returns the first step satisfying predicate or the number of steps
+ * if there is none. The trace is scanned from the start, unless the
+ * predicate is known to be monotone, i.e. to hold in all steps after
+ * the first one where it holds: then checkpoints of the index are
+ * searched by bisection and only the interval between two checkpoints
+ * is scanned.
+ */
+size_t findStep(const TraceIndex& index, const Predicate& predicate,
+                bool monotone, TraceState& state, TraceTransition& transition)
+{
+    size_t steps = index.getSteps();
+
+    /* Find the last checkpoint where the predicate does not hold. */
+    size_t low = 0, high = (steps + TraceIndex::interval - 1) / TraceIndex::interval;
+    index.seek(0, state, transition);
+    if (predicate(state))
+    {
+        return 0;
+    }
+    while (monotone && high - low > 1)
+    {
+        size_t middle = (low + high) / 2;
+        index.seek(middle * TraceIndex::interval, state, transition);
+        if (predicate(state))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+
+    /* Scan from there. */
+    size_t step = low * TraceIndex::interval;
+    TraceReader reader = index.seek(step, state, transition);
+    while (++step < steps)
+    {
+        reader.next(state, transition);
+        if (predicate(state))
+        {
+            return step;
+        }
+        if (step % 4096 == 0)
+        {
+            reader.release();
+        }
+    }
+    return steps;
+}
+
+/* Compares states of two traces, possibly of different models.
+ * Processes, locations, variables and clocks are matched by name;
+ * those in only one of the models are ignored. Zones are compared
+ * semantically: if the constraints differ, both zones are closed and
+ * the bounds between matched clocks are compared.
+ */
+class Comparator
+{
+public:
+    Comparator(const IntermediateModel& first, const IntermediateModel& second);
+
+    /* Returns true if the states of the first and the second model
+     * are equal.
+     */
+    bool equal(const TraceState& a, const TraceState& b);
+
+    /* Prints the components in which the states differ, one per
+     * line.
+     */
+    void report(Output& out, const TraceState& a, const TraceState& b);
+
+    /* Prints the components that are in only one of the models. */
+    void printUnmatched(Output& out) const;
+private:
+    const IntermediateModel& first;
+    const IntermediateModel& second;
+    bool identical;                   // All components match in order
+    vector<int> processes;            // Matching process of second or -1
+    vector<vector<int>> locations;    // Matching location of second or -1
+    vector<int> variables;            // Matching variable of second or -1
+    vector<int> clocks;               // Matching clock of second or -1
+    DBM dbm[2];
+
+    bool equalZones(const TraceState& a, const TraceState& b);
+};
+
+/* Returns the index in names of each of the names of from, or -1. */
+template <typename T, typename Name>
+static vector<int> match(const vector<T>& from, const vector<T>& names, Name name)
+{
+    std::unordered_map<string_view, int> index;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        index.emplace(name(names[i]), i);
+    }
+    vector<int> result;
+    for (auto& element: from)
+    {
+        auto it = index.find(name(element));
+        result.push_back(it == index.end() ? -1 : it->second);
+    }
+    return result;
+}
+
+Comparator::Comparator(const IntermediateModel& first, const IntermediateModel& second):
+    first(first), second(second)
+{
+    auto process = [](const process_t& p) { return string_view(p.name); };
+    auto name = [](const string& s) { return string_view(s); };
+    processes = match(first.getProcesses(), second.getProcesses(), process);
+    variables = match(first.getVariables(), second.getVariables(), name);
+    clocks = match(first.getClocks(), second.getClocks(), name);
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        vector<string> names[2];
+        if (processes[p] >= 0)
+        {
+            for (int l: first.getProcesses()[p].locations)
+            {
+                names[0].push_back(first.getLayout()[l].name);
+            }
+            for (int l: second.getProcesses()[processes[p]].locations)
+            {
+                names[1].push_back(second.getLayout()[l].name);
+            }
+        }
+        locations.push_back(match(names[0], names[1], name));
+    }
+
+    auto inOrder = [](const vector<int>& matching, size_t size) {
+        for (size_t i = 0; i < matching.size(); i++)
+        {
+            if (matching[i] != (int)i)
+            {
+                return false;
+            }
+        }
+        return matching.size() == size;
+    };
+    identical = inOrder(processes, second.getProcessCount())
+        && inOrder(variables, second.getVariableCount())
+        && inOrder(clocks, second.getClockCount());
+    for (size_t p = 0; identical && p < processes.size(); p++)
+    {
+        identical = inOrder(locations[p], second.getProcesses()[p].locations.size());
+    }
+}
+
+bool Comparator::equalZones(const TraceState& a, const TraceState& b)
+{
+    auto& ca = a.getConstraints();
+    auto& cb = b.getConstraints();
+    if (identical && ca.size() == cb.size()
+        && std::equal(ca.begin(), ca.end(), cb.begin(),
+                      [](const constraint_t& x, const constraint_t& y) {
+                          return x.index == y.index && toRaw(x.bound) == toRaw(y.bound);
+                      }))
+    {
+        return true;
+    }
+
+    a.expand(dbm[0]);
+    b.expand(dbm[1]);
+    bool empty[2] = { !dbm[0].close(), !dbm[1].close() };
+    if (empty[0] || empty[1])
+    {
+        return empty[0] == empty[1];
+    }
+    for (size_t i = 0; i < clocks.size(); i++)
+    {
+        for (size_t j = 0; j < clocks.size(); j++)
+        {
+            if (clocks[i] >= 0 && clocks[j] >= 0
+                && dbm[0](i, j) != dbm[1](clocks[i], clocks[j]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Comparator::equal(const TraceState& a, const TraceState& b)
+{
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        if (processes[p] >= 0
+            && locations[p][a.getLocation(p)] != b.getLocation(processes[p]))
+        {
+            return false;
+        }
+    }
+    for (size_t v = 0; v < variables.size(); v++)
+    {
+        if (variables[v] >= 0 && a.getVariable(v) != b.getVariable(variables[v]))
+        {
+            return false;
+        }
+    }
+    return equalZones(a, b);
+}
+
+/* Prints a raw bound like "<3", "<=3" or "<inf". */
+static Output& printBound(Output& out, raw_t bound)
+{
+    if (bound == rawInfinity)
+    {
+        return out << "<inf";
+    }
+    bound_t b = toBound(bound);
+    return out << (b.strict ? "<" : "<=") << (int)b.value;
+}
+
+void Comparator::report(Output& out, const TraceState& a, const TraceState& b)
+{
+    for (size_t p = 0; p < processes.size(); p++)
+    {
+        int q = processes[p];
+        if (q >= 0 && locations[p][a.getLocation(p)] != b.getLocation(q))
+        {
+            out << first.getProcesses()[p].name << ": "
+                << first.getLocationName(p, a.getLocation(p)) << " in first, "
+                << second.getLocationName(q, b.getLocation(q)) << " in second\n";
+        }
+    }
+    for (size_t v = 0; v < variables.size(); v++)
+    {
+        int w = variables[v];
+        if (w >= 0 && a.getVariable(v) != b.getVariable(w))
+        {
+            out << first.getVariables()[v] << ": " << a.getVariable(v) << " in first, "
+                << b.getVariable(w) << " in second\n";
+        }
+    }
+    if (!equalZones(a, b))
+    {
+        /* equalZones() leaves the closed zones in dbm. */
+        if (dbm[0].isEmpty() || dbm[1].isEmpty())
+        {
+            out << "zone: " << (dbm[0].isEmpty() ? "empty" : "non-empty") << " in first, "
+                << (dbm[1].isEmpty() ? "empty" : "non-empty") << " in second\n";
+            return;
+        }
+        auto& names = first.getClocks();
+        for (size_t i = 0; i < clocks.size(); i++)
+        {
+            for (size_t j = 0; j < clocks.size(); j++)
+            {
+                if (clocks[i] >= 0 && clocks[j] >= 0
+                    && dbm[0](i, j) != dbm[1](clocks[i], clocks[j]))
+                {
+                    out << names[i] << '-' << names[j] << ": ";
+                    printBound(out, dbm[0](i, j)) << " in first, ";
+                    printBound(out, dbm[1](clocks[i], clocks[j])) << " in second\n";
+                }
+            }
+        }
+    }
+}
+
+void Comparator::printUnmatched(Output& out) const
+{
+    auto print = [&out](const char* kind, const vector<int>& matching,
+                        auto name, const char* model) {
+        for (size_t i = 0; i < matching.size(); i++)
+        {
+            if (matching[i] < 0)
+            {
+                out << kind << ' ' << name(i) << " is only in the " << model << " model\n";
+            }
+        }
+    };
+    if (identical)
+    {
+        return;
+    }
+    print("Process", processes, [&](size_t p) { return string_view(first.getProcesses()[p].name); },
+          "first");
+    print("Variable", variables, [&](size_t v) { return string_view(first.getVariables()[v]); },
+          "first");
+    print("Clock", clocks, [&](size_t c) { return string_view(first.getClocks()[c]); },
+          "first");
+
+    auto reverse = [](const vector<int>& matching, size_t size) {
+        vector<int> result(size, -1);
+        for (size_t i = 0; i < matching.size(); i++)
+        {
+            if (matching[i] >= 0)
+            {
+                result[matching[i]] = i;
+            }
+        }
+        return result;
+    };
+    print("Process", reverse(processes, second.getProcessCount()),
+          [&](size_t p) { return string_view(second.getProcesses()[p].name); }, "second");
+    print("Variable", reverse(variables, second.getVariableCount()),
+          [&](size_t v) { return string_view(second.getVariables()[v]); }, "second");
+    print("Clock", reverse(clocks, second.getClockCount()),
+          [&](size_t c) { return string_view(second.getClocks()[c]); }, "second");
+}
+
+/* Replays two traces in lockstep and prints the first step where
+ * their states differ, together with the transitions leading to it.
+ * Both traces are streamed through one state buffer each. Returns
+ * true if the traces are equal; steps is set to the number of steps
+ * compared. A trace that cannot be read is reported by throwing a
+ * FormatException naming its path.
+ */
+bool diffTraces(const IntermediateModel& first, MappedFile& a,
+                const IntermediateModel& second, MappedFile& b,
+                const char* const paths[2], Output& out, size_t& steps)
+{
+    Comparator comparator(first, second);
+    TraceReader readers[2] = { TraceReader(first, a), TraceReader(second, b) };
+    TraceState states[2] = { TraceState(first), TraceState(second) };
+    TraceTransition transitions[2] = { TraceTransition(first), TraceTransition(second) };
+
+    comparator.printUnmatched(out);
+    size_t& step = steps;
+    auto next = [&](int i) {
+        try
+        {
+            return readers[i].next(states[i], transitions[i]);
+        }
+        catch (std::exception& e)
+        {
+            throw FormatException(string(paths[i]) + ": step "
+                                  + std::to_string(step) + ": " + e.what());
+        }
+    };
+    for (step = 0;; step++)
+    {
+        bool more[2] = { next(0), next(1) };
+        if (!more[0] || !more[1])
+        {
+            if (more[0] != more[1])
+            {
+                out << "The " << (more[0] ? "second" : "first")
+                    << " trace ends after " << (int)step << " steps\n";
+                return false;
+            }
+            out << "The traces are equal in all " << (int)step << " steps\n";
+            return true;
+        }
+        if (!comparator.equal(states[0], states[1]))
+        {
+            out << "Step " << (int)step << " differs\n";
+            if (step > 0)
+            {
+                out << "first:  " << transitions[0] << '\n'
+                    << "second: " << transitions[1] << '\n';
+            }
+            comparator.report(out, states[0], states[1]);
+            return false;
+        }
+        if (step % 4096 == 0)
+        {
+            readers[0].release();
+            readers[1].release();
+        }
+    }
+}
+
+/* A trace replayed in batch mode and the outcome of replaying it.
+ */
+struct job_t
+{
+    string trace;               // Path of the trace
+    string output;              // Path of the output file
+    size_t states = 0;          // Number of states replayed
+    size_t errors = 0;          // Number of inconsistencies found
+    string failure;             // Why the trace could not be replayed
+};
+
+/* Replays or validates the trace of a job and writes the result to
+ * its output file. Only reads the model, so jobs can run in parallel.
+ */
+static void runJob(const IntermediateModel& model, job_t& job, bool validate,
+                   format_t format)
+{
+    try
+    {
+        MappedFile trace;
+        if (!trace.open(job.trace.c_str()))
+        {
+            job.failure = strerror(errno);
+            return;
+        }
+        FILE* file = fopen(job.output.c_str(), "w");
+        if (file == nullptr)
+        {
+            job.failure = job.output + ": " + strerror(errno);
+            return;
+        }
+        try
+        {
+            Output out(file);
+            if (validate)
+            {
+                Validator validator(model, out);
+                job.states = validateTrace(model, trace, validator);
+                job.errors = validator.getErrors();
+                out << (int)job.states << " states checked, "
+                    << (int)job.errors << " errors\n";
+            }
+            else
+            {
+                job.states = loadTrace(model, trace, out, format);
+            }
+        }
+        catch (...)
+        {
+            fclose(file);
+            throw;
+        }
+        if (fclose(file) != 0)
+        {
+            job.failure = job.output + ": " + strerror(errno);
+        }
+    }
+    catch (std::exception& e)
+    {
+        job.failure = e.what();
+    }
+}
+
+/* Adds a job for every trace in paths to jobs. Directories stand for
+ * the regular files in them, except trace indices, in name order. The
+ * output of a trace is written to directory under the name of the
+ * trace with its extension replaced by extension.
+ */
+static void addJobs(vector<job_t>& jobs, char* paths[], int count,
+                    const string& directory, const char* extension)
+{
+    namespace fs = std::filesystem;
+    vector<string> traces;
+    for (int i = 0; i < count; i++)
+    {
+        if (fs::is_directory(paths[i]))
+        {
+            vector<string> files;
+            for (auto& entry: fs::directory_iterator(paths[i]))
+            {
+                if (entry.is_regular_file() && entry.path().extension() != ".idx")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            traces.insert(traces.end(), files.begin(), files.end());
+        }
+        else
+        {
+            traces.push_back(paths[i]);
+        }
+    }
+
+    std::set<string> outputs;
+    for (auto& trace: traces)
+    {
+        fs::path output = fs::path(directory)
+            / fs::path(trace).filename().replace_extension(extension);
+        if (!outputs.insert(output.string()).second)
+        {
+            throw std::runtime_error(trace + " and another trace are both written to "
+                                     + output.string());
+        }
+        jobs.push_back(job_t());
+        jobs.back().trace = trace;
+        jobs.back().output = output.string();
+    }
+}
+
+/* Runs all jobs on the given number of threads. The traces are
+ * handed out one at a time, so long and short traces balance out.
+ */
+static void runJobs(const IntermediateModel& model, vector<job_t>& jobs,
+                    bool validate, format_t format,
+                    size_t threads)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++)
+        {
+            runJob(model, jobs[i], validate, format);
+        }
+    };
+    vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threads, jobs.size()); i++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread: workers)
+    {
+        thread.join();
+    }
+}
+
+/* Prints a line per job and the totals of a batch. Returns the number
+ * of jobs which failed or found inconsistencies.
+ */
+static size_t printSummary(Output& out, const vector<job_t>& jobs)
+{
+    size_t states = 0, failed = 0;
+    for (auto& job: jobs)
+    {
+        out << job.trace << ": ";
+        if (!job.failure.empty())
+        {
+            out << "failed: " << job.failure << '\n';
+            failed++;
+            continue;
+        }
+        out << (int)job.states << " states";
+        if (job.errors > 0)
+        {
+            out << ", " << (int)job.errors << " errors";
+            failed++;
+        }
+        out << '\n';
+        states += job.states;
+    }
+    out << (int)jobs.size() << " traces, " << (int)states << " states, "
+        << (int)failed << " failed\n";
+    return failed;
+}
+
+static void printHelp(const char* binary)
+{
+    cerr << "Synopsis: " << binary
+         << " [-tv] [-c file] [-F format] [-s steps] [-f predicate [-m]] <if> <trace>\n"
+         << "       " << binary
+         << " [-tv] [-F format] [-j jobs] -o <directory> <if> <trace>...\n"
+         << "       " << binary << " [-t] -d <if> <trace> [<if>] <trace>\n"
+         << "Options:\n"
+         << "     -c, --convert <file>\n"
+         << "         write the trace to file in the compact binary format,\n"
+         << "         which is read like the text format;\n"
+         << "     -d, --diff\n"
+         << "         replay two traces, of the same or of two models, in\n"
+         << "         lockstep and print the first step where their\n"
+         << "         locations, variables or zones differ;\n"
+         << "     -F, --format <text|json|csv>\n"
+         << "         print steps as text (default), as JSON objects, one per\n"
+         << "         line, or as CSV with a column per process and variable;\n"
+         << "     -j, --jobs <number>\n"
+         << "         number of traces replayed in parallel in batch mode,\n"
+         << "         by default one per processor;\n"
+         << "     -o, --output <directory>\n"
+         << "         batch mode: load the model once, replay or validate (-v)\n"
+         << "         all traces and the files in directories given, each to\n"
+         << "         a file of the same name in directory, and print a summary;\n"
+         << "     -f, --find <predicate>\n"
+         << "         print the first step satisfying a predicate such as\n"
+         << "         \"P.L && x >= 3\";\n"
+         << "     -m, --monotone\n"
+         << "         with -f, assume the predicate holds in all steps after the\n"
+         << "         first one satisfying it and search by bisection;\n"
+         << "     -s, --steps <first>[:[<last>]]\n"
+         << "         print only the given steps, counting from 0;\n"
+         << "     -t, --timing\n"
+         << "         print the number of states replayed per second to stderr;\n"
+         << "     -v, --validate\n"
+         << "         check the zones, variables and transitions of the trace\n"
+         << "         instead of printing it.\n"
+         << "Options -f and -s use an index of the trace, which is stored\n"
+         << "next to it with the suffix .idx.\n";
+}
 
 int main(int argc, char *argv[])
 {
+    static const option options[] = {
+        { "convert", required_argument, nullptr, 'c' },
+        { "diff", no_argument, nullptr, 'd' },
+        { "find", required_argument, nullptr, 'f' },
+        { "format", required_argument, nullptr, 'F' },
+        { "help", no_argument, nullptr, 'h' },
+        { "jobs", required_argument, nullptr, 'j' },
+        { "monotone", no_argument, nullptr, 'm' },
+        { "output", required_argument, nullptr, 'o' },
+        { "steps", required_argument, nullptr, 's' },
+        { "timing", no_argument, nullptr, 't' },
+        { "validate", no_argument, nullptr, 'v' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    bool diff = false, timing = false, validate = false, monotone = false;
+    format_t format = TEXT;
+    const char* convert = nullptr;
+    const char* find = nullptr;
+    const char* steps = nullptr;
+    const char* output = nullptr;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    int c;
+
+    while ((c = getopt_long(argc, argv, "c:dF:f:hj:mo:s:tv", options, nullptr)) != -1)
+    {
+        switch (c)
+        {
+        case 'F':
+            if (strcmp(optarg, "text") == 0)
+            {
+                format = TEXT;
+            }
+            else if (strcmp(optarg, "json") == 0)
+            {
+                format = JSON;
+            }
+            else if (strcmp(optarg, "csv") == 0)
+            {
+                format = CSV;
+            }
+            else
+            {
+                cerr << "-F expects either 'text', 'json' or 'csv' argument.\n";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'c':
+            convert = optarg;
+            break;
+        case 'd':
+            diff = true;
+            break;
+        case 'f':
+            find = optarg;
+            break;
+        case 'j':
+            if (atoi(optarg) < 1)
+            {
+                cerr << "-j expects a positive number of jobs.\n";
+                exit(EXIT_FAILURE);
+            }
+            jobs = atoi(optarg);
+            break;
+        case 'm':
+            monotone = true;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 's':
+            steps = optarg;
+            break;
+        case 't':
+            timing = true;
+            break;
+        case 'v':
+            validate = true;
+            break;
+        default:
+            printHelp(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
     try
     {
-        if (argc < 3)
+        int args = argc - optind;
+        if ((diff ? args != 3 && args != 4 : output == nullptr ? args != 2 : args < 2)
+            || diff + validate + (convert != nullptr) + (find != nullptr)
+               + (steps != nullptr) > 1
+            || (output != nullptr && (diff || convert != nullptr || find != nullptr
+                                      || steps != nullptr)))
         {
-            printf("Synopsis: %s <if> <trace>\n", argv[0]);
-            exit(1);
+            printHelp(argv[0]);
+            exit(EXIT_FAILURE);
         }
 
         /* Load model in intermediate format.
          */
-        if (strcmp(argv[1], "-") == 0)
+        MappedFile input;
+        if (!input.open(argv[optind]))
         {
-            loadIF(std::cin);
+            perror(argv[optind]);
+            exit(EXIT_FAILURE);
         }
-        else
+        IntermediateModel model;
+        model.load(input.begin(), input.end());
+
+        /* Replay all traces against the model in batch mode.
+         */
+        if (output != nullptr)
         {
-            ifstream file(argv[1]);
-            if (!file)
+            static const char* extensions[] = { ".txt", ".jsonl", ".csv" };
+            vector<job_t> batch;
+            addJobs(batch, argv + optind + 1, argc - optind - 1, output,
+                    validate ? ".log" : extensions[format]);
+            std::filesystem::create_directories(output);
+            auto start = std::chrono::steady_clock::now();
+            runJobs(model, batch, validate, format, jobs);
+            Output out(stdout);
+            size_t failed = printSummary(out, batch);
+            out.flush();
+            if (timing)
             {
-                perror(argv[1]);
-                exit(EXIT_FAILURE);
+                size_t count = 0;
+                for (auto& job: batch)
+                {
+                    count += job.states;
+                }
+                std::chrono::duration<double> time =
+                    std::chrono::steady_clock::now() - start;
+                cerr << count << " states in " << time.count() << " s ("
+                     << (size_t)(count / time.count()) << " states/s)" << endl;
+            }
+            return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
+        /* Compare two traces. With three arguments both are traces of
+         * the same model.
+         */
+        if (diff)
+        {
+            MappedFile files[3];
+            IntermediateModel other;
+            const char* paths[3] = {
+                argv[optind + 1],
+                args == 4 ? argv[optind + 2] : nullptr,
+                argv[argc - 1]
+            };
+            for (int i = 0; i < 3; i++)
+            {
+                if (paths[i] != nullptr && !files[i].open(paths[i]))
+                {
+                    perror(paths[i]);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if (args == 4)
+            {
+                other.load(files[1].begin(), files[1].end());
+            }
+            auto start = std::chrono::steady_clock::now();
+            Output out(stdout);
+            size_t count;
+            const char* traces[2] = { paths[0], paths[2] };
+            bool equal = diffTraces(model, files[0], args == 4 ? other : model,
+                                    files[2], traces, out, count);
+            out.flush();
+            if (timing)
+            {
+                std::chrono::duration<double> time =
+                    std::chrono::steady_clock::now() - start;
+                cerr << count << " steps in " << time.count() << " s ("
+                     << (size_t)(count / time.count()) << " steps/s)" << endl;
             }
-            loadIF(file);
-            file.close();
+            return equal ? EXIT_SUCCESS : EXIT_FAILURE;
         }
 
         /* Load trace.
          */
-        ifstream file(argv[2]);
-        if (!file)
+        MappedFile trace;
+        if (!trace.open(argv[optind + 1]))
         {
-            perror(argv[2]);
+            perror(argv[optind + 1]);
             exit(EXIT_FAILURE);
         }
-        loadTrace(file);
-        file.close();
+        auto start = std::chrono::steady_clock::now();
+        Output out(stdout);
+        size_t count, errors = 0;
+        if (convert != nullptr)
+        {
+            FILE* file = fopen(convert, "wb");
+            if (file == nullptr)
+            {
+                perror(convert);
+                exit(EXIT_FAILURE);
+            }
+            count = convertTrace(model, trace, file);
+            if (fclose(file) != 0)
+            {
+                perror(convert);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (find != nullptr || steps != nullptr)
+        {
+            TraceIndex index(model, argv[optind + 1], trace);
+            TraceState state(model);
+            TraceTransition transition(model);
+            size_t first = index.getSteps(), last = first;
+            if (find != nullptr)
+            {
+                first = last = findStep(index, Predicate(model, find), monotone,
+                                        state, transition);
+                if (first == index.getSteps())
+                {
+                    cerr << "No step satisfies " << find << endl;
+                    return EXIT_FAILURE;
+                }
+                if (format == TEXT)
+                {
+                    out << "Step " << (int)first << ":\n";
+                }
+            }
+            else
+            {
+                /* Parse first[:[last]]. */
+                const char* end = steps + strlen(steps);
+                auto result = std::from_chars(steps, end, first);
+                last = first;
+                if (result.ec == std::errc() && result.ptr != end && *result.ptr == ':')
+                {
+                    last = index.getSteps() - 1;
+                    if (++result.ptr != end)
+                    {
+                        result = std::from_chars(result.ptr, end, last);
+                    }
+                }
+                if (result.ec != std::errc() || result.ptr != end || first > last)
+                {
+                    printHelp(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                if (last >= index.getSteps())
+                {
+                    cerr << "The trace has only " << index.getSteps() << " steps" << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            printSteps(index, out, format, first, last);
+            count = last - first + 1;
+        }
+        else if (validate)
+        {
+            Validator validator(model, out);
+            count = validateTrace(model, trace, validator);
+            errors = validator.getErrors();
+            out << (int)count << " states checked, " << (int)errors << " errors\n";
+        }
+        else
+        {
+            count = loadTrace(model, trace, out, format);
+        }
+        out.flush();
+        if (timing)
+        {
+            std::chrono::duration<double> time =
+                std::chrono::steady_clock::now() - start;
+            cerr << count << " states in " << time.count() << " s ("
+                 << (size_t)(count / time.count()) << " states/s)" << endl;
+        }
+        if (errors > 0)
+        {
+            return EXIT_FAILURE;
+        }
     }
     catch (std::exception &e)
     {
         cerr << "Cought exception: " << e.what() << endl;
+        return EXIT_FAILURE;
     }
 }
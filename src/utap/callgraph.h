@@ -0,0 +1,116 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_CALLGRAPH_HH
+#define UTAP_CALLGRAPH_HH
+
+#include "utap/system.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * The call graph of the functions of a system.
+     *
+     * Nodes are the global functions and the functions of all
+     * templates (including dynamic templates). There is an edge from
+     * a function to every function called somewhere in its body.
+     *
+     * Functions are ordered topologically with callees before their
+     * callers; mutually recursive functions form a strongly connected
+     * component and are adjacent in this order.
+     */
+    class CallGraph
+    {
+    public:
+        explicit CallGraph(TimedAutomataSystem &system);
+
+        /** Returns all functions, callees before callers. */
+        const std::vector<function_t*> &getFunctions() const;
+
+        /** Returns the functions called directly by \a fun. */
+        const std::set<function_t*> &getCallees(const function_t *fun) const;
+
+        /** Returns true if \a fun may (indirectly) call itself. */
+        bool isRecursive(const function_t *fun) const;
+
+        /** Returns true if some function is recursive. */
+        bool hasRecursion() const;
+
+        /**
+         * Recomputes the changes and depends sets of all functions
+         * such that they include the side effects of all functions
+         * called transitively. Each component is processed once in
+         * topological order, recursive components are iterated to a
+         * fixed point.
+         */
+        void computeSummaries();
+
+        /**
+         * Inlines calls to small non-recursive functions into
+         * invariants, guards and updates of all templates:
+         *
+         * - a call to a side effect free function whose body is a
+         *   single return statement is replaced by the returned
+         *   expression,
+         * - a call to a void function used as an update is replaced
+         *   by the expression statements of its body.
+         *
+         * Only functions without local variables and with at most \a
+         * maxStatements statements are inlined. Parameters are
+         * substituted by the arguments, thus arguments must be free
+         * of side effects, must not depend on variables changed by
+         * the function, including those passed by reference, and
+         * arguments to written reference parameters must not alias.
+         * Calls are not inlined where a symbol used by the function
+         * is shadowed. Returns the number of inlined calls.
+         */
+        size_t inlineCalls(size_t maxStatements = 4);
+
+    protected:
+        struct node_t
+        {
+            std::set<function_t*> callees;
+            size_t component;
+            bool recursive;
+        };
+
+        TimedAutomataSystem &system;
+        std::map<const function_t*, node_t> nodes;
+        std::vector<function_t*> order;
+        std::vector<size_t> components; /**< Start of components in order */
+
+        void addFunctions(declarations_t &declarations);
+        void computeComponents();
+        bool isInlineable(function_t *fun, size_t maxStatements,
+                          bool update) const;
+        expression_t inlineCall(expression_t call, bool update) const;
+        bool isSafeCall(expression_t call, frame_t scope) const;
+        expression_t inlineExpression(expression_t expr, frame_t scope,
+                                      size_t maxStatements, bool update,
+                                      size_t &count) const;
+    };
+}
+
+#endif
@@ -0,0 +1,178 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_CLOCKBOUNDS_HH
+#define UTAP_CLOCKBOUNDS_HH
+
+#include "utap/evaluator.h"
+
+#include <climits>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Computes the maximal constants the clocks of a system are
+     * compared with, as needed for the extrapolation of zones.
+     *
+     * A clock is compared with a lower bound in constraints like x > c
+     * and x >= c and with an upper bound in x < c and x <= c, where a
+     * negation swaps the two and equalities give both. Integer offsets
+     * are moved to the constant, i.e. x + e < c compares x with c - e.
+     * Constraints on the difference of two clocks give the absolute value of the
+     * constant as both bounds of both clocks. Guards calling functions
+     * contribute the constraints of the returned expressions, with the
+     * parameters replaced by the arguments, and the other constraints
+     * of the function bodies as both bounds.
+     *
+     * The bounds of a location are those of its invariant, of the
+     * guards of its outgoing edges and, unless an edge resets the
+     * clock, of the location it leads to. Only assignments of a clock
+     * at the top level of an update count as resets. An array of
+     * clocks is a single clock whose bounds hold for every element.
+     *
+     * Guards and invariants are analysed once per template and the
+     * constants are evaluated for each process, with the template
+     * parameters bound to its arguments. A constant which cannot be
+     * evaluated gives the bound ClockBounds::unknown.
+     */
+    class ClockBounds
+    {
+    public:
+        static const int32_t none = -1;         /**< Not compared at all */
+        static const int32_t unknown = INT32_MAX; /**< Not computable */
+        static const uint32_t noClock = UINT32_MAX;
+
+        struct bounds_t
+        {
+            int32_t lower;
+            int32_t upper;
+
+            /** Returns the maximal constant. */
+            int32_t max() const { return lower < upper ? upper : lower; }
+        };
+
+        struct clock_t
+        {
+            symbol_t uid;
+            const instance_t *process; /**< The owner or nullptr if global */
+        };
+
+        explicit ClockBounds(TimedAutomataSystem &system);
+
+        /** Returns the clock or array of clocks \a expr refers to, if any. */
+        static symbol_t clockOf(expression_t expr);
+
+        /** Global clocks come first, then the local ones by process. */
+        uint32_t getClockCount() const { return clocks.size(); }
+        const clock_t &getClock(uint32_t clock) const { return clocks[clock]; }
+
+        /** Processes are numbered in system order. */
+        uint32_t getProcessCount() const { return processes.size(); }
+        const instance_t &getProcess(uint32_t process) const {
+            return *processes[process].instance;
+        }
+
+        /**
+         * Returns the clock \a uid refers to in \a process, which may
+         * be a local or global clock or a reference parameter, or
+         * noClock.
+         */
+        uint32_t findClock(uint32_t process, symbol_t uid) const;
+
+        /** Returns the bounds of \a clock over the whole system. */
+        bounds_t getBounds(uint32_t clock) const;
+
+        /** Returns the maximal constant of \a clock, i.e. max(L, U). */
+        int32_t getMaxConstant(uint32_t clock) const {
+            return getBounds(clock).max();
+        }
+
+        /** Returns the bounds of \a clock over all locations of \a process. */
+        bounds_t getBounds(uint32_t process, uint32_t clock) const;
+
+        /**
+         * Returns the bounds of \a clock in \a location of \a process.
+         * Clocks local to other processes have no bounds.
+         */
+        bounds_t getBounds(uint32_t process, const state_t &location,
+                           uint32_t clock) const;
+
+        /** Prints the global bounds and those of every location. */
+        void print(std::ostream &os) const;
+
+    protected:
+        struct atom_t
+        {
+            symbol_t clock;
+            expression_t value;
+            bool lower, upper;
+            bool diagonal;      // the absolute value is used
+        };
+
+        struct edgeinfo_t
+        {
+            uint32_t src, dst;  // nodes, branchpoints after the locations
+            std::vector<atom_t> atoms;
+            std::vector<symbol_t> resets;
+        };
+
+        struct templinfo_t
+        {
+            uint32_t nodes;     // locations and branchpoints
+            std::vector<std::vector<atom_t> > invariants; // by location
+            std::vector<edgeinfo_t> edges;
+            std::map<symbol_t, uint32_t> clocks; // local ones by offset
+        };
+
+        struct process_t
+        {
+            const instance_t *instance;
+            const templinfo_t *info;
+            uint32_t firstLocal;     // clock index of the first local one
+            uint32_t locals;
+            std::vector<bounds_t> bounds; // by location and column
+        };
+
+        TimedAutomataSystem &system;
+        ConstantEvaluator evaluator;
+        std::vector<clock_t> clocks;
+        std::map<symbol_t, uint32_t> globalClocks;
+        std::map<const template_t*, templinfo_t> templates;
+        std::vector<process_t> processes;
+        std::vector<bounds_t> totals; // by clock
+
+        void collect(expression_t expr, int polarity,
+                     std::vector<atom_t> &atoms,
+                     std::vector<const function_t*> &calls) const;
+        void collectCall(expression_t call, int polarity,
+                         std::vector<atom_t> &atoms,
+                         std::vector<const function_t*> &calls) const;
+        void analyse(const template_t &templ, templinfo_t &info) const;
+        void propagate(process_t &process);
+        uint32_t resolve(const process_t &process, symbol_t uid) const;
+        uint32_t getColumn(const process_t &process, uint32_t clock) const;
+    };
+}
+
+#endif
@@ -0,0 +1,159 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_CONTROLFLOW_HH
+#define UTAP_CONTROLFLOW_HH
+
+#include "utap/system.h"
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * An instruction of a basic block. Before SSA construction the
+     * uses and defs maps are empty; afterwards they map every symbol
+     * read or written by the instruction to its SSA version. Version
+     * 0 is the value a symbol has when the function is entered.
+     */
+    struct instruction_t
+    {
+        enum type_t
+        {
+            EVAL,       /**< Evaluates expr for its side effects */
+            ASSERT,     /**< Evaluates the assertion expr */
+            DEFINE,     /**< Initialises local variable symbol to expr */
+            BRANCH,     /**< Branches on expr, successors: true, false */
+            SWITCH,     /**< Branches to the case matching expr */
+            ITERATE,    /**< Assigns the next value to symbol or exits */
+            RETURN      /**< Returns expr (which may be empty) */
+        };
+
+        type_t type;
+        expression_t expr;
+        symbol_t symbol;
+        std::map<symbol_t, uint32_t> uses;
+        std::map<symbol_t, uint32_t> defs;
+
+        instruction_t(type_t type, expression_t expr,
+                      symbol_t symbol = symbol_t())
+            : type(type), expr(expr), symbol(symbol) {}
+    };
+
+    /**
+     * A phi function merging the versions of a symbol flowing in
+     * from the predecessors of a block.
+     */
+    struct phi_t
+    {
+        symbol_t symbol;
+        uint32_t version;
+        std::vector<uint32_t> operands; /**< One per predecessor */
+    };
+
+    /**
+     * A basic block. Only the last instruction may branch: BRANCH and
+     * ITERATE blocks have two successors (taken, not taken), SWITCH
+     * blocks have one successor per entry in cases, where an empty
+     * label denotes the default case or leaving the switch.
+     */
+    struct basicblock_t
+    {
+        std::vector<phi_t> phis;
+        std::vector<instruction_t> instructions;
+        std::vector<expression_t> cases;
+        std::vector<size_t> successors;
+        std::vector<size_t> predecessors;
+    };
+
+    /**
+     * The control flow graph of a function body with dominator
+     * information and optional SSA form.
+     *
+     * All blocks are reachable from the entry block. The exit block
+     * is the unique block without successors; it is missing (getExit()
+     * returns none) if the function never returns. Blocks are
+     * numbered in reverse postorder.
+     */
+    class ControlFlowGraph
+    {
+    public:
+        static constexpr size_t none = static_cast<size_t>(-1);
+
+        /** Lowers the body of \a fun into basic blocks. */
+        explicit ControlFlowGraph(function_t &fun);
+
+        function_t &getFunction() const { return fun; }
+        size_t size() const { return blocks.size(); }
+        size_t getEntry() const { return 0; }
+        size_t getExit() const { return exit; }
+
+        const basicblock_t &operator[](size_t block) const;
+
+        /** Returns the immediate dominator or none for the entry. */
+        size_t getImmediateDominator(size_t block) const;
+
+        /** Returns true if block \a a dominates block \a b. */
+        bool dominates(size_t a, size_t b) const;
+
+        /** Returns the dominance frontier of \a block. */
+        const std::vector<size_t> &getDominanceFrontier(size_t block) const;
+
+        /** Returns the blocks immediately dominated by \a block. */
+        const std::vector<size_t> &getDominated(size_t block) const;
+
+        /**
+         * Converts the graph to SSA form: places phi functions at the
+         * iterated dominance frontiers of all definitions and assigns
+         * versions to the uses and definitions of every instruction.
+         * Assignments to array elements and record fields define a new
+         * version of the whole variable and use the previous one.
+         */
+        void constructSSA();
+
+        /** Returns true if constructSSA() has been called. */
+        bool isSSA() const { return ssa; }
+
+        /** Returns the number of versions of \a symbol (including 0). */
+        uint32_t getVersions(symbol_t symbol) const;
+
+        /** Prints the blocks, one instruction per line. */
+        void print(std::ostream &os) const;
+
+    protected:
+        function_t &fun;
+        std::vector<basicblock_t> blocks;
+        size_t exit;
+        std::vector<size_t> idom;
+        std::vector<std::vector<size_t>> frontier;
+        std::vector<std::vector<size_t>> dominated;
+        std::map<symbol_t, uint32_t> versions;
+        bool ssa;
+
+        void prune(size_t exit);
+        void computeDominators();
+        void rename(size_t block, std::map<symbol_t, std::vector<uint32_t>> &stacks);
+    };
+}
+
+#endif
@@ -0,0 +1,81 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_EVALUATOR_HH
+#define UTAP_EVALUATOR_HH
+
+#include "utap/system.h"
+#include "utap/typechecker.h"
+
+#include <map>
+
+namespace UTAP
+{
+    /**
+     * Evaluates integer expressions at compile time.
+     *
+     * Identifiers are evaluated if they are bound explicitly (see
+     * bind()) or if they are compile time computable according to
+     * CompileTimeComputableValues and have an initialiser. Constant
+     * arrays initialised with a list can be indexed. Template
+     * parameters are only known once the process is bound.
+     */
+    class ConstantEvaluator
+    {
+    public:
+        explicit ConstantEvaluator(TimedAutomataSystem &system);
+
+        /** Binds \a symbol to \a value. */
+        void bind(symbol_t symbol, int32_t value);
+
+        /** Removes the binding of \a symbol. */
+        void unbind(symbol_t symbol);
+
+        /**
+         * Binds the constant parameters of a template to the
+         * arguments of \a process where these can be evaluated.
+         * Returns false if some argument could not be evaluated.
+         */
+        bool bind(const instance_t &process);
+
+        /** Removes all bindings. */
+        void clear();
+
+        /**
+         * Evaluates \a expr. Returns false if the value depends on
+         * something not known at compile time or on an error such as
+         * division by zero.
+         */
+        bool evaluate(expression_t expr, int32_t &value) const;
+
+        /** Evaluates the bounds of an integer or scalar range type. */
+        bool evaluateRange(type_t type, int32_t &lower, int32_t &upper) const;
+
+    protected:
+        CompileTimeComputableValues computable;
+        std::map<symbol_t, int32_t> bindings;
+
+        bool lookup(symbol_t symbol, int32_t &value) const;
+        bool element(expression_t expr, expression_t &init) const;
+    };
+}
+
+#endif
@@ -0,0 +1,194 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_FLOWGRAPH_HH
+#define UTAP_FLOWGRAPH_HH
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * The data flow between the processes of a system.
+     *
+     * Processes, channels and variables are identified by dense
+     * integer ids. Processes are numbered in the order in which they
+     * are added, channels and variables are numbered alphabetically
+     * by build(). Processes are related to channels by SEND and
+     * RECEIVE and to variables by READ and WRITE. Each relation is
+     * stored in compressed sparse row form both from the processes
+     * and towards them, with the targets of a process and the
+     * sources of a channel or variable in increasing order.
+     *
+     * Every pair in a relation is labelled by the channels on which
+     * the process synchronises when it accesses the variable, where
+     * \a none stands for accesses outside synchronisations, such as
+     * in guards and invariants. Pairs of SEND and RECEIVE are
+     * labelled by \a none only.
+     *
+     * The graph is filled by calling addProcess() followed by add()
+     * for each relation of that process, or by merging graphs filled
+     * separately, and is completed by build().
+     */
+    class FlowGraph
+    {
+    public:
+        enum relation_t { SEND, RECEIVE, READ, WRITE };
+
+        /** Id of no process, channel or variable. */
+        static const uint32_t none = UINT32_MAX;
+
+        /** A sequence of ids stored in the graph. */
+        struct range_t
+        {
+            const uint32_t *first;
+            const uint32_t *last;
+            const uint32_t *begin() const { return first; }
+            const uint32_t *end() const { return last; }
+            size_t size() const { return last - first; }
+            bool empty() const { return first == last; }
+        };
+
+        /** Adds a process and returns its id. */
+        uint32_t addProcess(const std::string &name);
+
+        /**
+         * Returns the id of the channel \a name, adding it if
+         * needed. The id is only valid until build() is called.
+         */
+        uint32_t addChannel(const std::string &name);
+
+        /**
+         * Returns the id of the variable \a name, adding it if
+         * needed. The id is only valid until build() is called.
+         */
+        uint32_t addVariable(const std::string &name);
+
+        /**
+         * Relates the last added process to channel or variable \a
+         * target, labelled by channel \a label.
+         */
+        void add(relation_t relation, uint32_t target, uint32_t label = none);
+
+        /**
+         * Appends the processes of \a other together with their
+         * relations, identifying channels and variables by name.
+         * Neither graph may be built yet.
+         */
+        void merge(const FlowGraph &other);
+
+        /**
+         * Renumbers channels and variables and builds the adjacency
+         * arrays. No further elements can be added afterwards.
+         */
+        void build();
+
+        uint32_t getProcessCount() const { return processes.size(); }
+        uint32_t getChannelCount() const { return channels.size(); }
+        uint32_t getVariableCount() const { return variables.size(); }
+
+        const std::string &getProcessName(uint32_t id) const {
+            return processes[id];
+        }
+        const std::string &getChannelName(uint32_t id) const {
+            return channels[id];
+        }
+        const std::string &getVariableName(uint32_t id) const {
+            return variables[id];
+        }
+
+        /** Returns the id of process \a name or \a none. */
+        uint32_t findProcess(const std::string &name) const;
+
+        /** Returns the id of channel \a name or \a none. */
+        uint32_t findChannel(const std::string &name) const;
+
+        /** Returns the id of variable \a name or \a none. */
+        uint32_t findVariable(const std::string &name) const;
+
+        /** Returns the channels or variables \a process relates to. */
+        range_t getTargets(relation_t relation, uint32_t process) const {
+            return range(forward[relation], process);
+        }
+
+        /** Returns the processes related to the channel or variable. */
+        range_t getSources(relation_t relation, uint32_t target) const {
+            return range(backward[relation], target);
+        }
+
+        /**
+         * Returns the labels of a pair, where \a target points into
+         * the range returned by getTargets() for the same relation.
+         * The labels are in increasing order with \a none first.
+         */
+        range_t getLabels(relation_t relation, const uint32_t *target) const {
+            return range(labels[relation],
+                         target - forward[relation].ids.data());
+        }
+
+        /**
+         * Returns the position of \a target in the targets of \a
+         * process or nullptr if they are not related.
+         */
+        const uint32_t *findTarget(relation_t relation, uint32_t process,
+                                   uint32_t target) const;
+
+    protected:
+        struct csr_t
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> ids;
+        };
+
+        struct pair_t
+        {
+            uint32_t process;
+            uint32_t target;
+            uint32_t label;
+        };
+
+        typedef std::unordered_map<std::string, uint32_t> index_t;
+
+        std::vector<std::string> processes, channels, variables;
+        index_t processIndex, channelIndex, variableIndex;
+        std::vector<pair_t> pairs[4];
+        csr_t forward[4];
+        csr_t backward[4];
+        csr_t labels[4];
+
+        static range_t range(const csr_t &c, size_t i) {
+            const uint32_t *ids = c.ids.data();
+            return { ids + c.offsets[i], ids + c.offsets[i + 1] };
+        }
+        uint32_t intern(const std::string &name,
+                        std::vector<std::string> &names, index_t &index);
+        static std::vector<uint32_t> sortNames(std::vector<std::string> &names,
+                                               index_t &index);
+        void buildRelation(relation_t relation, uint32_t targets,
+                           const std::vector<uint32_t> &rename,
+                           const std::vector<uint32_t> &channelRename);
+    };
+}
+
+#endif
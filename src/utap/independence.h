@@ -0,0 +1,106 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_INDEPENDENCE_HH
+#define UTAP_INDEPENDENCE_HH
+
+#include "utap/system.h"
+
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * A static independence relation between the edges of different
+     * processes for partial order reduction.
+     *
+     * Edges get global ids by numbering the edges of every process in
+     * system order, each in template order. Two edges are independent
+     * if they belong to different processes and
+     *
+     * - neither writes a global variable or clock the other one reads
+     *   or writes, where an edge reads what its guard, synchronisation
+     *   and update as well as the invariants of its source and target
+     *   read, including the functions called and the arguments of
+     *   reference parameters,
+     * - they do not synchronise on the same channel, and
+     * - neither leaves or enters a committed location.
+     *
+     * Arrays count as a whole, thus accessing different elements is a
+     * conflict. Process sets with free parameters are single processes
+     * here, hence their edges are never independent of each other. If
+     * the system declares priorities, no edges are independent.
+     */
+    class Independence
+    {
+    public:
+        explicit Independence(TimedAutomataSystem &system);
+
+        uint32_t getEdgeCount() const { return edges.size(); }
+        uint32_t getProcessCount() const { return firstEdges.size() - 1; }
+
+        /** Returns the global id of edge number \a edge of \a process. */
+        uint32_t getEdgeId(uint32_t process, uint32_t edge) const {
+            return firstEdges[process] + edge;
+        }
+
+        const edge_t &getEdge(uint32_t id) const { return *edges[id]; }
+        uint32_t getProcess(uint32_t id) const { return owners[id]; }
+
+        bool isIndependent(uint32_t a, uint32_t b) const {
+            return (bits[size_t(a) * words + b / 64] >> (b % 64)) & 1;
+        }
+
+        /**
+         * Returns the row of \a id in the matrix: bit b % 64 of word
+         * b / 64 is set if edge b is independent of edge \a id.
+         */
+        const uint64_t *getRow(uint32_t id) const { return &bits[size_t(id) * words]; }
+        uint32_t getRowWords() const { return words; }
+
+        /**
+         * Prints for every edge the number of edges of other processes
+         * it is independent of.
+         */
+        void print(std::ostream &os) const;
+
+    protected:
+        struct access_t
+        {
+            std::vector<uint32_t> reads, writes, channels; // by index
+            bool committed;
+        };
+
+        TimedAutomataSystem &system;
+        std::vector<const instance_t*> processes;
+        std::vector<uint32_t> firstEdges; // by process, one past the last
+        std::vector<const edge_t*> edges;
+        std::vector<uint32_t> owners;     // process by edge
+        uint32_t words;                   // per row
+        std::vector<uint64_t> bits;
+
+        void clear(const std::vector<uint32_t> &rows,
+                   const std::vector<uint32_t> &columns);
+    };
+}
+
+#endif
@@ -0,0 +1,111 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_LIVENESS_HH
+#define UTAP_LIVENESS_HH
+
+#include "utap/system.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Computes the active clocks and variables of every location of
+     * the templates of a system, i.e. those whose value may still be
+     * read before it is overwritten. A verifier may reset the
+     * inactive ones to a fixed value without changing the behaviour.
+     *
+     * Only the clocks and non-constant variables declared in a
+     * template, including its parameters passed by value, are
+     * tracked. A location uses what its invariant and rates read, an
+     * edge what its guard, synchronisation and update read, including
+     * the variables functions called depend on. Only assignments of a
+     * whole clock or variable at the top level of an update kill it;
+     * elements of arrays and records as well as the variables changed
+     * in functions are conservatively assumed to be still live.
+     *
+     * The analysis is a backwards fixpoint over the locations and
+     * branchpoints of each template and does not depend on the
+     * template parameters, hence the results are shared by all
+     * processes of a template.
+     */
+    class Liveness
+    {
+    public:
+        /** A set of clocks or variables, indexed as their list. */
+        typedef std::vector<bool> bitset_t;
+
+        explicit Liveness(TimedAutomataSystem &system);
+
+        /**
+         * Returns the clocks and the variables of \a templ in
+         * declaration order, parameters first. \a templ must be a
+         * timed automaton of the system.
+         */
+        const std::vector<symbol_t> &getClocks(const template_t &templ) const;
+        const std::vector<symbol_t> &getVariables(const template_t &templ) const;
+
+        /** Returns the clocks and variables live in \a location. */
+        const bitset_t &getLiveClocks(const template_t &templ,
+                                      const state_t &location) const;
+        const bitset_t &getLiveVariables(const template_t &templ,
+                                         const state_t &location) const;
+
+        /**
+         * Returns true if \a symbol is live in \a location, or if it
+         * is not tracked at all.
+         */
+        bool isLive(const template_t &templ, const state_t &location,
+                    symbol_t symbol) const;
+
+        /**
+         * Returns a comment listing the live clocks and variables of
+         * every location, keyed by template and location name as in
+         * "P.A", e.g. for PrettyPrinter::setAnnotations().
+         */
+        std::map<std::string, std::string> getAnnotations() const;
+
+        /** Prints the live clocks and variables of every location. */
+        void print(std::ostream &os) const;
+
+    protected:
+        struct templinfo_t
+        {
+            const template_t *templ;
+            std::vector<symbol_t> clocks, variables;
+            std::vector<bitset_t> liveClocks, liveVariables; // by location
+        };
+
+        TimedAutomataSystem &system;
+        std::vector<templinfo_t> templates; // in system order
+        std::map<const template_t*, size_t> index;
+
+        const templinfo_t &getInfo(const template_t &templ) const;
+        void analyse(const template_t &templ, templinfo_t &info) const;
+        std::string describe(const templinfo_t &info, size_t location) const;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_LOOPBOUNDS_HH
+#define UTAP_LOOPBOUNDS_HH
+
+#include "utap/evaluator.h"
+#include "utap/statement.h"
+
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /** A loop in the body of a function. */
+    struct loop_t
+    {
+        function_t *function;
+        Statement *statement;   /**< The loop statement */
+        symbol_t variable;      /**< The loop variable, if recognised */
+        bool leaves;            /**< The body may break or return */
+        bool bounded;           /**< True if iterations is a bound */
+        bool exact;             /**< True if the bound is process independent */
+        uint32_t iterations;    /**< Maximum number of iterations */
+        std::vector<int32_t> values; /**< Values of variable if exact */
+        int32_t last;           /**< Value of variable after the loop */
+    };
+
+    /**
+     * Derives bounds on the number of iterations of loops in function
+     * bodies.
+     *
+     * Iterations over range types are bounded by the size of the
+     * range. For loops are bounded if they have the shape
+     *
+     *     for (i = e1; c; s)
+     *
+     * where s only changes i, the body changes neither i nor anything
+     * else c or s depends on, and c, e1 and s can be evaluated with
+     * ConstantEvaluator once i is known. Loops in template functions
+     * which depend on template parameters are bounded by the maximum
+     * over all processes of the template. While loops are not
+     * bounded.
+     */
+    class LoopBounds
+    {
+    public:
+        /**
+         * Analyses all functions of \a system. Loops with more than
+         * \a limit iterations are considered unbounded.
+         */
+        explicit LoopBounds(TimedAutomataSystem &system,
+                            uint32_t limit = 1u << 16);
+
+        /** Returns all loops found. */
+        const std::vector<loop_t> &getLoops() const;
+
+        /** Returns the loop of the given statement or nullptr. */
+        const loop_t *getLoop(const Statement *stat) const;
+
+        /**
+         * Fully unrolls every loop with an exact bound whose unrolled
+         * body has at most \a maxStatements statements. The loop
+         * variable is replaced by its value in each copy of the body,
+         * and for loops end with an assignment of the final value to
+         * the loop variable. If the body calls functions, the copies
+         * of a for loop are also preceded by an assignment of their
+         * value. Loops whose body declares local variables, breaks or
+         * contains other loops that are not unrolled are kept.
+         * Returns the number of unrolled loops. Afterwards the loops
+         * found by the constructor are no longer valid.
+         */
+        size_t unroll(size_t maxStatements);
+
+        /**
+         * Prints the bound of every loop, which is an upper bound if
+         * the body may break or return.
+         */
+        void print(std::ostream &os) const;
+
+    protected:
+        TimedAutomataSystem &system;
+        ConstantEvaluator evaluator;
+        uint32_t limit;
+        std::vector<loop_t> loops;
+
+        void analyse(function_t &fun, const std::vector<instance_t*> &processes);
+        bool computeBound(loop_t &loop);
+    };
+}
+
+#endif
@@ -0,0 +1,134 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_METRICS_HH
+#define UTAP_METRICS_HH
+
+#include "utap/clockbounds.h"
+#include "utap/evaluator.h"
+
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /** The size of a variable. */
+    struct varmetrics_t
+    {
+        symbol_t uid;
+        bool known;             /**< False if some size could not be evaluated */
+        uint32_t elements;      /**< Number of integer and boolean elements */
+        uint64_t width;         /**< Largest number of values of an element */
+        uint64_t bits;          /**< Bits needed to store all elements */
+    };
+
+    /** The use of a clock in clock constraints. */
+    struct clockmetrics_t
+    {
+        symbol_t uid;
+        uint32_t constraints;   /**< Number of constraints on the clock */
+        bool bounded;           /**< False if some constant could not be evaluated */
+        int32_t maxConstant;    /**< Largest constant compared with, or -1 */
+    };
+
+    /**
+     * Metrics of a template, a process or the global declarations.
+     * For templates, sizes depending on template parameters are
+     * unknown.
+     */
+    struct metrics_t
+    {
+        const instance_t *instance; /**< The template or process, or nullptr */
+        uint32_t locations;
+        uint32_t edges;
+        uint32_t clocks;            /**< Number of clock elements declared */
+        uint32_t variables;         /**< Number of variable elements declared */
+        uint32_t clockConstraints;  /**< Clock constraints in guards and invariants */
+        bool known;                 /**< False if some variable size is unknown */
+        uint64_t stateBits;         /**< Bits of the location and the variables */
+        std::vector<varmetrics_t> vars;
+        std::vector<clockmetrics_t> clockUses;
+    };
+
+    /**
+     * Computes size metrics of the templates and processes of a
+     * system as an estimate of its verification cost.
+     *
+     * Variables are the non-constant integer, boolean and scalar
+     * variables including arrays and records of them as well as the
+     * non-constant parameters passed by value. The state bits of a
+     * variable element are the bits needed for the values of its
+     * range, and the state bits of a process include its location.
+     *
+     * Clock constraints are the comparisons in invariants and guards
+     * whose operands involve a clock, including those of two clocks
+     * or of clock differences, counted syntactically once per
+     * template and once per comparison. Each clock involved counts
+     * the constraint among its own. The maximal
+     * constants of the clocks are those computed by ClockBounds for
+     * each process; those of a template are the largest over its
+     * processes.
+     */
+    class Metrics
+    {
+    public:
+        explicit Metrics(TimedAutomataSystem &system);
+
+        /** Returns the metrics of the global declarations. */
+        const metrics_t &getGlobals() const { return globals; }
+
+        /** Returns the metrics of every template in system order. */
+        const std::vector<metrics_t> &getTemplates() const { return templates; }
+
+        /** Returns the metrics of every process in system order. */
+        const std::vector<metrics_t> &getProcesses() const { return processes; }
+
+        /** Returns the sums over the globals and all processes. */
+        const metrics_t &getTotal() const { return total; }
+
+        /** Prints the metrics, one entity per line. */
+        void print(std::ostream &os) const;
+
+    protected:
+        /** A comparison and the clocks it involves. */
+        struct constraint_t
+        {
+            std::vector<symbol_t> clocks;
+        };
+
+        TimedAutomataSystem &system;
+        ConstantEvaluator evaluator;
+        ClockBounds clockBounds;
+        metrics_t globals, total;
+        std::vector<metrics_t> templates, processes;
+
+        void collect(expression_t expr,
+                     std::vector<constraint_t> &constraints) const;
+        bool measure(type_t type, varmetrics_t &var) const;
+        void addVariable(metrics_t &metrics, symbol_t symbol) const;
+        void addBounds(metrics_t &metrics,
+                       const std::vector<constraint_t> &constraints) const;
+        metrics_t analyse(const instance_t &instance,
+                          const std::vector<constraint_t> &constraints) const;
+    };
+}
+
+#endif
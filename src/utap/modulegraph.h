@@ -0,0 +1,141 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_MODULEGRAPH_HH
+#define UTAP_MODULEGRAPH_HH
+
+#include "utap/flowgraph.h"
+
+#include <ostream>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * The interaction of the processes of a system decomposed into
+     * modules.
+     *
+     * The interaction graph has a node for every process, channel and
+     * variable of a FlowGraph. A process has an edge to the channels
+     * it sends on and to the variables it writes, and a channel or
+     * variable has an edge to the processes receiving on it or
+     * reading it. Thus one process influences another if there is a
+     * path between them. Going through the channels and variables
+     * rather than relating the processes directly keeps the graph
+     * linear in the size of the FlowGraph.
+     *
+     * The strongly connected components of the interaction graph are
+     * numbered topologically such that edges between components only
+     * lead to higher numbers. A component with processes is a module,
+     * the others consist of a single channel or variable connecting
+     * the modules. The weakly connected components are subsystems
+     * which do not interact with each other at all. The components
+     * of a subsystem are numbered consecutively and the subsystems
+     * are ordered by their first process.
+     */
+    class ModuleGraph
+    {
+    public:
+        typedef FlowGraph::range_t range_t;
+
+        explicit ModuleGraph(const FlowGraph &graph);
+
+        uint32_t getComponentCount() const { return processes.offsets.size() - 1; }
+        uint32_t getSubsystemCount() const { return subsystems.size() - 1; }
+
+        /** Returns the component of a process, channel or variable. */
+        uint32_t getProcessComponent(uint32_t process) const {
+            return components[process];
+        }
+        uint32_t getChannelComponent(uint32_t channel) const {
+            return components[channelBase + channel];
+        }
+        uint32_t getVariableComponent(uint32_t variable) const {
+            return components[variableBase + variable];
+        }
+
+        /** Returns the processes, channels and variables of \a component. */
+        range_t getProcesses(uint32_t component) const {
+            return range(processes, component);
+        }
+        range_t getChannels(uint32_t component) const {
+            return range(channels, component);
+        }
+        range_t getVariables(uint32_t component) const {
+            return range(variables, component);
+        }
+
+        /** Returns true if \a component contains processes. */
+        bool isModule(uint32_t component) const {
+            return !getProcesses(component).empty();
+        }
+
+        /** Returns the components directly influenced by \a component. */
+        range_t getSuccessors(uint32_t component) const {
+            return range(successors, component);
+        }
+
+        /** Returns the first component of \a subsystem. */
+        uint32_t getFirstComponent(uint32_t subsystem) const {
+            return subsystems[subsystem];
+        }
+
+        /** Returns the subsystem \a component belongs to. */
+        uint32_t getSubsystem(uint32_t component) const;
+
+        /**
+         * Prints the subsystems with their modules and the channels
+         * and variables connecting them in topological order.
+         */
+        void print(std::ostream &os, const char *title) const;
+
+    protected:
+        struct csr_t
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> ids;
+        };
+
+        const FlowGraph &graph;
+        uint32_t channelBase, variableBase; // node ids of the first ones
+        csr_t edges;                        // of the interaction graph
+        std::vector<uint32_t> components;   // by node id
+        csr_t processes, channels, variables, successors; // by component
+        std::vector<uint32_t> subsystems;   // first component of each
+
+        static range_t range(const csr_t &c, size_t i) {
+            const uint32_t *ids = c.ids.data();
+            return { ids + c.offsets[i], ids + c.offsets[i + 1] };
+        }
+        void buildEdges();
+        std::vector<uint32_t> findComponents() const;
+        std::vector<uint32_t> findSubsystems() const;
+        void numberComponents(const std::vector<uint32_t> &order,
+                              const std::vector<uint32_t> &subsystem);
+        void printConnector(std::ostream &os, const char *kind,
+                            const std::string &name,
+                            FlowGraph::relation_t in, FlowGraph::relation_t out,
+                            uint32_t target,
+                            const std::vector<uint32_t> &moduleIds) const;
+    };
+}
+
+#endif
@@ -22,6 +22,7 @@
 #ifndef UTAP_PRETTYPRINTER_H
 #define UTAP_PRETTYPRINTER_H
 
+#include <map>
 #include <string>
 #include <vector>
 #include <ostream>
@@ -45,6 +46,8 @@ namespace UTAP
         std::string committed;
         std::string param;
         std::string templateset;
+        std::string procName;
+        std::map<std::string, std::string> annotations;
         int select, guard, sync, update, probability;
 
         bool first;
@@ -55,6 +58,12 @@ namespace UTAP
     public:
         PrettyPrinter(std::ostream &stream);
 
+        /**
+         * Sets comments to print after locations, keyed by template
+         * and location name as in "P.A".
+         */
+        void setAnnotations(const std::map<std::string, std::string> &annotations);
+
         void addPosition(
             uint32_t position, uint32_t offset, uint32_t line, const std::string& path) override;
 
@@ -24,12 +24,16 @@
 
 #include "utap/system.h"
 #include "utap/statement.h"
+#include "utap/flowgraph.h"
 
+#include <climits>
 #include <cstring>
 #include <list>
+#include <string>
 #include <set>
 #include <map>
 #include <stack>
+#include <vector>
 #include <algorithm>
 
 namespace UTAP
@@ -47,13 +51,18 @@ namespace UTAP
      *
      * The system must be built by TypeChecker/SystemBuilder before
      * SignalFlow.  Simply create using constructor and then use
-     * print* methods.  The rest of methods are used internally by
-     * visitor pattern.  Feel free to add new print* methods or
-     * inheriting classes.
+     * print* methods.  Feel free to add new print* methods or
+     * inheriting classes.  The extracted information is kept in a
+     * FlowGraph indexed by process, channel and variable ids.
+     *
+     * The processes are visited independently of each other, possibly
+     * in several threads, and their summaries are merged in the order
+     * of the system, hence the result does not depend on the number
+     * of threads.
      *
      * Author: Marius Mikucionis <marius@cs.aau.dk>
      */
-    class SignalFlow: public StatementVisitor
+    class SignalFlow
     {
     public:
         struct less_str {// must be somewhere in utilities, replace if found
@@ -62,50 +71,16 @@ namespace UTAP
             }
         };
         typedef std::set<const char*, const less_str> strs_t;// string set
-        struct proc_t; // info on process input/output
-        typedef std::map<const proc_t*, strs_t> proc2strs_t;//proc->string set
-        typedef std::map<const char*, strs_t> str2strs_t;//string->string set
-
-        struct proc_t { // info about process input/output
-            const char* name; // name of the process
-            strs_t inChans, outChans; // input/output channels used by process
-            str2strs_t rdVars, wtVars; // read/written variables with channels
-            proc2strs_t outEdges; // outChans indexed by destination process
-            proc_t(const char* _name): name(_name) {}
-        };
-        typedef std::set<proc_t*> procs_t;
-        typedef std::map<const char*, procs_t, less_str> str2procs_t;
         typedef std::map<const symbol_t, expression_t> exprref_t;//fn-params
 
     protected:
         int verbosity;//0 - silent, 1 - errors, 2 - warnings, 3 - diagnostics
         const char* title; // title of the Uppaal TA system
-        procs_t procs; // list of all processes in the system
-        str2procs_t receivers, transmitters;// processes sorted by vars/chans
-        strs_t processes, channels, variables;
-        proc_t* cTA; // current automaton in traversal
-        instance_t* cP; // current process in traversal
-        const char* cChan; // channel on current transition in traversal
-        std::string chanString;
-        bool inp, out, sync, paramsExpanded;// current expression state
-        std::stack<std::pair<bool, bool> > ioStack;// remember I/O state
-        std::stack<exprref_t> refparams; // parameter passed by reference
-        std::stack<exprref_t> valparams; // parameter passed by value
-
-        bool checkParams(const symbol_t &s);// maps parameter to global symbol
-        void addChan(const std::string &, strs_t &, str2procs_t&);
-        void addVar(const symbol_t &, str2strs_t&, str2procs_t&);
-        void visitProcess(instance_t &);
-        void visitExpression(const expression_t &);
-        void pushIO(){
-            ioStack.push(std::make_pair(inp, out));
-        }
-        void popIO() {
-            inp = ioStack.top().first;
-            out = ioStack.top().second;
-            ioStack.pop();
-        }
+        FlowGraph graph; // processes, channels and variables with I/O
 
+        /* prints the channels labelling a read/write of a variable */
+        void printLabels(std::ostream &os, FlowGraph::relation_t relation,
+                         const uint32_t *variable, const char *sep);
         /* prints list of processes with their look-attributes */
         virtual void printProcsForDot(std::ostream &os, bool erd);
         /* prints list of variables with their look-attributes */
@@ -122,15 +97,21 @@ namespace UTAP
 
     public:
 /**
- * Analyse the system and extract I/O information:
+ * Analyse the system and extract I/O information using up to
+ * \a threads threads, where 0 stands for the number of cores.
  */
-        SignalFlow(const char* _title, TimedAutomataSystem& ta);
+        SignalFlow(const char* _title, TimedAutomataSystem& ta,
+                   unsigned threads = 0);
 
         void setVerbose(int verbose) { verbosity = verbose; }
+
+        virtual ~SignalFlow();
+
 /**
- * All strings are from TASystem (don't dispose TASystem before SignalFlow).
+ * Returns the extracted I/O information. Process ids follow the order
+ * of processes in the system.
  */
-        virtual ~SignalFlow();
+        const FlowGraph &getGraph() const { return graph; }
 
 /**
  * Print I/O information in TRON format into given output stream.
@@ -145,26 +126,6 @@ namespace UTAP
  */
         virtual void printForDot(std::ostream &os, bool ranked, bool erd,
                                  bool cEdged);
-
-/**
- * System visitor pattern extracts read/write information from UCode.
- * This is actually "const" visitor and should contain "const Statement *stat".
- */
-        int32_t visitEmptyStatement(EmptyStatement *stat) override;
-        int32_t visitExprStatement(ExprStatement *stat) override;
-        int32_t visitForStatement(ForStatement *stat) override;
-        int32_t visitIterationStatement(IterationStatement *stat) override;
-        int32_t visitWhileStatement(WhileStatement *stat) override;
-        int32_t visitDoWhileStatement(DoWhileStatement *stat) override;
-        int32_t visitBlockStatement(BlockStatement *stat) override;
-        int32_t visitSwitchStatement(SwitchStatement *stat) override;
-        int32_t visitCaseStatement(CaseStatement *stat) override;
-        int32_t visitDefaultStatement(DefaultStatement *stat) override;
-        int32_t visitIfStatement(IfStatement *stat) override;
-        int32_t visitBreakStatement(BreakStatement *stat) override;
-        int32_t visitContinueStatement(ContinueStatement *stat) override;
-        int32_t visitReturnStatement(ReturnStatement *stat) override;
-        int32_t visitAssertStatement(UTAP::AssertStatement *stat) override;
     };
 
 /**
@@ -192,14 +153,6 @@ namespace UTAP
         return os;
     }
 
-    inline std::ostream& operator<<(std::ostream& os, const SignalFlow::procs_t& ps)
-    {
-        SignalFlow::procs_t::const_iterator p=ps.begin(), e=ps.end();
-        if (p!=e) { os << (*p)->name; ++p; }
-	while (p!=e) { os << ", " << (*p)->name; ++p; }
-        return os;
-    }
-
 /**
  * Partitions the system into environment and IUT according to TRON
  * assumptions. inputs/outputs are channel names. Environment processes shout
@@ -224,33 +177,90 @@ namespace UTAP
  *  0 if partitioning was consistent and complete,
  *  1 if partitioning was consistent but incomplete (some proc/chan is free)
  *  2 if partitioning was inconsistent (some proc/chan/var is both Env and IUT)
+ *
+ * After a partition the input and output channels can be added and removed
+ * one at a time.  Only the processes connected to the channel by internal
+ * channels and unobservable variable accesses are then partitioned again,
+ * and the processes changing their side are reported.
  */
     class Partitioner: public SignalFlow
     {
+    public:
+        /** The part a process, channel or variable belongs to. */
+        enum side_t { FREE, ENV, IUT, BAD };
+
+        /** A process which moved from one side to another. */
+        struct change_t
+        {
+            uint32_t process;
+            side_t from, to;
+        };
+        typedef std::vector<change_t> changes_t;
+
     protected:
-        procs_t procsEnv, procsIUT, procsBad;
-        strs_t chansIntEnv, chansIntIUT, observable, chansBad;
-        strs_t varsEnv, varsIUT, varsBad;
-        strs_t chansInp, chansOut;
-        const char* rule;
+        /** The processes, channels and variables being partitioned. */
+        struct scope_t
+        {
+            std::vector<uint32_t> procs, chans, vars;
+        };
 
-        void addProcs(const strs_t& chans, const str2procs_t& index,
-                      procs_t& result, procs_t& exclude);
-        void addIntChans(const procs_t& procs,
-                         strs_t& result, strs_t& exclude);
-        void addIntVars(const procs_t& procs, strs_t& result,
-                        strs_t& exclude);
-        void addProcsByVars(const strs_t& vars, procs_t& procs,
-                            procs_t& exclude);
+        std::vector<side_t> procSides, chanSides, varSides; // by graph id
+        std::vector<bool> observable; // by channel id
+        std::set<std::string> chansInp, chansOut;
+        const char* rule;
+        bool changed; // whether the last round of rules changed any side
+
+        bool classify(side_t& current, side_t side, uint32_t process,
+                      const std::string& name);
+        std::vector<uint32_t> getChans(const scope_t& scope, side_t side) const;
+        bool isObservable(FlowGraph::range_t labels) const;
+        void addProcs(const std::vector<uint32_t>& chans,
+                      FlowGraph::relation_t relation, side_t side);
+        void addIntChans(const scope_t& scope, side_t side);
+        void addIntVars(const scope_t& scope, side_t side);
+        void addProcsByVars(const scope_t& scope, side_t side);
+        void close(const scope_t& scope);
+        scope_t getScope(uint32_t chan) const;
+        int update(const std::string& chan, std::set<std::string>& chans,
+                   bool add, changes_t& changes);
+        int getStatus() const;
     public:
-        Partitioner(const char* _title, TimedAutomataSystem& ta):
-            SignalFlow(_title, ta) {}
-        ~Partitioner();
+        Partitioner(const char* _title, TimedAutomataSystem& ta,
+                    unsigned threads = 0):
+            SignalFlow(_title, ta, threads),
+            procSides(graph.getProcessCount(), FREE),
+            chanSides(graph.getChannelCount(), FREE),
+            varSides(graph.getVariableCount(), FREE),
+            observable(graph.getChannelCount(), false), rule(""),
+            changed(false) {}
 
         int partition(const strs_t& inputs, const strs_t& outputs);
         int partition(std::istream& ioinfo);
+
+        /**
+         * Adds or removes an input or output channel and partitions
+         * the affected processes again.  The processes which change
+         * their side are appended to \a changes.  Returns the same as
+         * partition().
+         */
+        int addInput(const std::string& chan, changes_t& changes) {
+            return update(chan, chansInp, true, changes);
+        }
+        int removeInput(const std::string& chan, changes_t& changes) {
+            return update(chan, chansInp, false, changes);
+        }
+        int addOutput(const std::string& chan, changes_t& changes) {
+            return update(chan, chansOut, true, changes);
+        }
+        int removeOutput(const std::string& chan, changes_t& changes) {
+            return update(chan, chansOut, false, changes);
+        }
+
+        /** Returns the side of the given process. */
+        side_t getSide(uint32_t process) const { return procSides[process]; }
+
         void printForDot(std::ostream &os, bool ranked, bool erd, bool cEdged) override;
-        void printViolation(const proc_t* process, const char* variable);
+        void printViolation(uint32_t process, const std::string& name);
         void fillWithEnvProcs(strs_t& procs);
         void fillWithIUTProcs(strs_t& procs);
     };
@@ -259,14 +269,15 @@ namespace UTAP
  * DistanceCalculator is used in TargetFirst heuristic search order of Uppaal.
  * Current implementation calculates complexity distances from a process to
  * the given set of "needles"  (e.g. variables or process location mentioned
- * in query). In the future this can be refined to take the process-local
+ * in query). The distance of an entity is the sum of the complexities (number
+ * of edges of a process, one for a variable) along the cheapest dependency
+ * path to a needle, computed for all needles by one shortest path search.
+ * In the future this can be refined to take the process-local
  * information into account (e.g. calculate distance for individual edges
  * within the process rather than just process).
  */
     class DistanceCalculator: public SignalFlow
     {
-        strs_t varNeedles; // set of variables of interest
-        strs_t procNeedles; // set of processes of interest
         bool distancesUpToDate;
 
         struct dist_t // distance structure
@@ -274,19 +285,15 @@ namespace UTAP
             uint32_t hops; // number of hops to closest needle
             uint32_t complexity; // complexity of this entity
             uint32_t distance; // accumulated complexity|hops to closest needle
-            dist_t(int h, int c, int d): hops(h), complexity(c), distance(d) {}
-            dist_t(): hops(0), complexity(1), distance(0) {}
+            dist_t(): hops(INT_MAX), complexity(1), distance(INT_MAX) {}
+            bool isNeedle() const { return hops == 0 && distance == 0; }
         };
 
-        typedef std::map<const char*, dist_t, less_str> str2dist_t;
-
-        str2dist_t distances;
+        std::vector<dist_t> procDistances; // by process id
+        std::vector<dist_t> varDistances; // by variable id
 
-        void updateDistancesFromVariable(const char* name,
-                                         const dist_t* distance);
-        void updateDistancesFromProcess(const char* name,
-                                        const dist_t* distance);
-        int calcComplexity(const char* process);
+        void addNeedle(dist_t& distance);
+        void printDistance(std::ostream &os, const dist_t& distance);
 
     protected:
         TimedAutomataSystem& taSystem;
@@ -296,9 +303,8 @@ namespace UTAP
         void printVarsForDot(std::ostream &os, bool ranked, bool erd) override;
 
     public:
-        DistanceCalculator(const char* _title, TimedAutomataSystem& ta):
-            SignalFlow(_title, ta), distancesUpToDate(false), taSystem(ta) {}
-        virtual ~DistanceCalculator();
+        DistanceCalculator(const char* _title, TimedAutomataSystem& ta,
+                           unsigned threads = 0);
         /** adds a variable needle to I/O map */
         void addVariableNeedle(const char* var);
         /** adds a variable needle to I/O map */
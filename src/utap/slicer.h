@@ -0,0 +1,147 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_SLICER_HH
+#define UTAP_SLICER_HH
+
+#include "utap/system.h"
+
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Removes the parts of a system which cannot influence any of its
+     * queries.
+     *
+     * A symbol is relevant if it is read by a query, a guard, an
+     * invariant, a synchronisation, a process argument or by an
+     * assignment to another relevant symbol. Removed are:
+     *
+     * - variables, clocks and channels which are not relevant
+     *   together with the assignments to them,
+     * - functions which are no longer called,
+     * - edges which can never be taken (constant false guard or a
+     *   channel without a synchronisation partner) and
+     * - locations which are not reachable in the template graph.
+     *
+     * Constants and template parameters are never removed, since
+     * they may be used in types. Templates which are not
+     * instantiated, LSC and dynamic templates are left untouched.
+     *
+     * The system must be type checked before it is sliced, and it is
+     * modified in place: TimedAutomataSystem cannot be copied, thus
+     * parse the model again if the original is needed. If some query
+     * cannot be parsed then nothing is removed.
+     *
+     * sliceQuery() further reduces the system to the cone of
+     * influence of a single query, which starts from the symbols and
+     * processes the query refers to. A process joins the cone if it
+     * writes a symbol relevant to the cone or may block one of its
+     * processes by synchronising with it; receiving from a broadcast
+     * channel blocks no one. Processes with invariants, urgent or
+     * committed locations or synchronisations on urgent channels
+     * restrict the timing of all processes and are always kept.
+     * Relevant are the symbols read by guards,
+     * invariants and synchronisations of the cone and, transitively,
+     * by its assignments to relevant symbols. Other processes are
+     * removed together with templates left without processes. Since
+     * the system is modified in place, parse the model once per query
+     * to obtain a reduced system for every query.
+     */
+    class Slicer
+    {
+    public:
+        explicit Slicer(TimedAutomataSystem &system);
+
+        /** Removes everything which cannot influence any query. */
+        void removeDeadCode();
+
+        /**
+         * Removes all queries except the one with the given index and
+         * everything which cannot influence it.
+         */
+        void sliceQuery(size_t query);
+
+        /** Returns the names of the removed processes. */
+        const std::vector<std::string> &getRemovedProcesses() const;
+
+        /** Returns qualified names of the removed variables. */
+        const std::vector<std::string> &getRemovedVariables() const;
+
+        /** Returns qualified names of the removed functions. */
+        const std::vector<std::string> &getRemovedFunctions() const;
+
+        /** Returns qualified names of the removed locations. */
+        const std::vector<std::string> &getRemovedLocations() const;
+
+        /** Returns the number of removed edges. */
+        size_t getRemovedEdges() const { return removedEdges; }
+
+        /** Returns the number of removed assignments. */
+        size_t getRemovedAssignments() const { return removedAssignments; }
+
+        /** Prints what has been removed. */
+        void printReport(std::ostream &os) const;
+
+    protected:
+        TimedAutomataSystem &system;
+        std::set<symbol_t> relevant;    /**< Symbols influencing a query */
+        std::set<symbol_t> removable;   /**< Declarations we may remove */
+        std::set<symbol_t> queried;     /**< Symbols used by queries */
+        std::set<template_t*> sliced;   /**< Templates we may modify */
+        bool deadlockQueried;           /**< Some query uses deadlock */
+
+        std::vector<std::string> removedVariables;
+        std::vector<std::string> removedFunctions;
+        std::vector<std::string> removedLocations;
+        std::vector<std::string> removedProcesses;
+        size_t removedEdges;
+        size_t removedAssignments;
+
+        /** Parses the queries and collects the symbols they use. */
+        bool collectQueries();
+        /** Removes processes outside the cone of influence. */
+        void removeIndependentProcesses();
+        /** Slices the system once the queries are collected. */
+        void slice();
+        /** Collects the declarations which may be removed. */
+        void collectRemovable();
+        /** Returns true if the edge can never be taken. */
+        bool isDisabled(template_t &templ, const edge_t &edge) const;
+        /** Removes edges which cannot be taken and unreachable locations. */
+        void removeUnreachable(template_t &templ);
+        /** Computes the relevant symbols as a fixed point. */
+        void computeRelevant();
+        /** Removes the declarations which are no longer referenced. */
+        void removeUnreferenced();
+
+        std::set<symbol_t> sendChans, recvChans; /**< Used channels */
+        void collectChannels(template_t &templ);
+        void resolveChannels(template_t &templ, expression_t sync,
+                             std::set<symbol_t> &chans) const;
+    };
+}
+
+#endif
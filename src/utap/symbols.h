@@ -28,6 +28,7 @@
 
 #include <cinttypes>
 #include <exception>
+#include <set>
 
 namespace UTAP
 {
@@ -240,6 +241,9 @@ namespace UTAP
         /** removes the given symbol*/
         void remove(symbol_t s);
 
+        /** Removes the given symbols, rebuilding the frame once. */
+        void remove(const std::set<symbol_t> &symbols);
+
         /** Resolves a name in this frame or a parent frame. */
         bool resolve(const std::string& name, symbol_t &symbol);
 
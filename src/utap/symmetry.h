@@ -0,0 +1,194 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_SYMMETRY_HH
+#define UTAP_SYMMETRY_HH
+
+#include "utap/evaluator.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Detects the symmetries induced by the scalar sets of a system.
+     *
+     * The type checker already restricts the values of a scalar set
+     * to be compared for equality, assigned and used as array indices
+     * and rejects initialisers of arrays indexed by them. Every
+     * permutation of the values of a scalar set thus maps behaviours
+     * to behaviours, provided the processes created for the free
+     * parameters of a template are permuted along with them and
+     * iterations over the scalar set do not depend on its order. The
+     * latter is checked here, where an iteration is suspect if it may
+     * be left early by a break or return statement or if it carries
+     * state from one value to the next: it assigns the iterator, or a
+     * value derived from it, to a variable not indexed by the
+     * iterator, or it writes such a variable and reads it again.
+     * Accumulations with +=, -=, ++ and -- commute and are allowed.
+     *
+     * Each scalar set gives a symmetry group consisting of all its
+     * permutations. The discrete state of the system is laid out as
+     * a vector of slots: the locations of all processes, with
+     * processes expanded for every value of their free parameters,
+     * followed by the global variables and the local variables of
+     * every process, each flattened into their integer elements.
+     * The clocks are laid out the same way: the global clocks followed
+     * by the local clocks of every process. canonicalise() maps a
+     * state to a representative of its orbit and returns the
+     * permutation it applied, which permuteClock() applies to clocks,
+     * e.g. to permute a zone along with the discrete state.
+     */
+    class Symmetry
+    {
+    public:
+        static const uint32_t none = UINT32_MAX;
+
+        /** The image of every value of every group. */
+        typedef std::vector<std::vector<int32_t> > permutation_t;
+
+        /** A scalar set and the entities it relates. */
+        struct group_t
+        {
+            std::string name;
+            uint32_t size;
+            std::vector<const instance_t*> processes; /**< With free parameters of it */
+            std::vector<symbol_t> variables;  /**< Indexed by it or holding it */
+        };
+
+        /** A process with values for its free parameters. */
+        struct process_t
+        {
+            const instance_t *instance;
+            std::vector<int32_t> arguments; /**< Of the free parameters */
+            std::string name;
+        };
+
+        /** An element of the discrete state. */
+        struct slot_t
+        {
+            std::string name;
+            uint32_t process;   /**< The owner or none if global */
+            bool location;      /**< The location rather than a variable */
+        };
+
+        /**
+         * Analyses \a system. canonicalise() tries all permutations if
+         * there are at most \a limit of them.
+         */
+        explicit Symmetry(TimedAutomataSystem &system, uint64_t limit = 40320);
+
+        const std::vector<group_t> &getGroups() const { return groups; }
+
+        /** Returns the reasons why the scalar sets are not symmetric. */
+        const std::vector<std::string> &getViolations() const {
+            return violations;
+        }
+
+        /** Returns true if there is a group and no violation. */
+        bool isSymmetric() const {
+            return !groups.empty() && violations.empty() && known;
+        }
+
+        uint32_t getProcessCount() const { return processes.size(); }
+        const process_t &getProcess(uint32_t process) const {
+            return processes[process];
+        }
+
+        uint32_t getSlotCount() const { return slots.size(); }
+        const slot_t &getSlot(uint32_t slot) const { return slots[slot].slot; }
+
+        uint32_t getClockCount() const { return clocks.size(); }
+        const slot_t &getClock(uint32_t clock) const { return clocks[clock].slot; }
+
+        /**
+         * Replaces \a state by a representative of its orbit and sets
+         * \a permutation to the permutation mapping \a state to it.
+         * Locations are stored as location numbers. If the product of
+         * the factorials of the group sizes is within the limit, all
+         * permutations are tried and the representative is the
+         * lexicographically smallest state of the orbit. Otherwise the
+         * values of each group are sorted by the slots they index,
+         * which is cheaper but may map states of one orbit to
+         * different representatives. Returns false and leaves \a state
+         * unchanged if the system is not symmetric.
+         */
+        bool canonicalise(std::vector<int32_t> &state,
+                          permutation_t &permutation) const;
+
+        /** Returns the image of \a clock under \a permutation. */
+        uint32_t permuteClock(uint32_t clock,
+                              const permutation_t &permutation) const;
+
+        /** Prints the groups and the violations. */
+        void print(std::ostream &os) const;
+
+    protected:
+        /** A coordinate of a slot permuted by a group. */
+        struct coord_t
+        {
+            uint32_t group;
+            int32_t value;
+            uint32_t stride;    // distance between slots of adjacent values
+        };
+
+        struct slotinfo_t
+        {
+            slot_t slot;
+            std::vector<coord_t> coords;
+            uint32_t valueGroup; // the group of the value or none
+        };
+
+        TimedAutomataSystem &system;
+        ConstantEvaluator evaluator;
+        std::vector<group_t> groups;
+        std::map<std::string, uint32_t> groupIndex; // by scalar set label
+        std::vector<std::string> violations;
+        std::vector<process_t> processes;
+        std::vector<slotinfo_t> slots;
+        std::vector<slotinfo_t> clocks;
+        uint64_t limit;
+        bool known;             // false if some size could not be evaluated
+
+        uint32_t getGroup(type_t type);
+        void addVariable(uint32_t group, symbol_t symbol);
+        bool countSlots(type_t type, bool clock, uint32_t &count) const;
+        void addSlots(type_t type, symbol_t uid, const std::string &name,
+                      uint32_t process, bool clock,
+                      std::vector<coord_t> &coords);
+        void checkFunctions(const declarations_t &declarations,
+                            const std::string &scope);
+        void addProcesses(const instance_t &instance,
+                          std::vector<std::vector<coord_t> > &coords);
+        uint32_t permute(const std::vector<slotinfo_t> &slots, uint32_t slot,
+                         const permutation_t &permutation) const;
+        void apply(const std::vector<int32_t> &state,
+                   const permutation_t &permutation,
+                   std::vector<int32_t> &image) const;
+        void sortValues(const std::vector<int32_t> &state,
+                        permutation_t &permutation) const;
+    };
+}
+
+#endif
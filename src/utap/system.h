@@ -489,6 +489,12 @@ namespace UTAP
         /** Returns the queries enclosed in the model. */
         queries_t &getQueries();
 
+        /**
+         * Returns true if \a symbol is the implicit reference clock,
+         * which is the first global variable.
+         */
+        bool isReferenceClock(symbol_t symbol) const;
+
         void addPosition(
             uint32_t position, uint32_t offset, uint32_t line, const std::string& path);
         const Positions::line_t &findPosition(uint32_t position) const;
@@ -588,6 +594,7 @@ namespace UTAP
         std::list<chan_priority_t> chanPriorities;
         std::map<std::string,int> procPriority;
         sync_use_t syncUsed; // see typechecker
+        symbol_t referenceClock;
 
         // The list of templates.
         std::list<template_t> templates;
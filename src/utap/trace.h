@@ -0,0 +1,956 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2026 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_TRACE_HH
+#define UTAP_TRACE_HH
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Exception indicating a syntax error in the intermediate format
+     * or in a trace.
+     */
+    class FormatException : public std::runtime_error
+    {
+    public:
+        explicit FormatException(const std::string &msg): std::runtime_error(msg) {}
+    };
+
+    /**
+     * A read-only view of the contents of a file. Regular files are
+     * mapped into memory; anything else, e.g. standard input, is read
+     * into a buffer. The contents are not null terminated.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile();
+
+        /**
+         * Opens \a path, or standard input if \a path is "-". Returns
+         * false and sets errno on failure.
+         */
+        bool open(const char *path);
+
+        /**
+         * Tells the system that the contents before \a pos are no
+         * longer needed, such that a mapped file can be streamed in
+         * constant memory.
+         */
+        void release(const char *pos);
+
+        const char *begin() const { return data; }
+        const char *end() const   { return data + size; }
+    private:
+        const char *data = nullptr;
+        size_t size = 0;
+        size_t released = 0;
+        bool mapped = false;
+        std::string buffer;
+    };
+
+    /**
+     * A cursor into text in the intermediate or the XTR format.
+     * Entries are tokenized in place: the scanner itself never
+     * allocates, and names and expressions are only copied when they
+     * are stored in the model.
+     */
+    class Scanner
+    {
+    public:
+        Scanner(const char *begin, const char *end):
+            pos(begin), line(begin), end(end) {}
+
+        bool atEnd() const { return pos == end; }
+        const char *position() const { return pos; }
+
+        /** Returns the rest of the current line and moves to the next. */
+        std::string_view rest()
+        {
+            const char *eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+            if (eol == nullptr)
+            {
+                eol = end;
+            }
+            std::string_view str(pos, eol - pos);
+            if (!str.empty() && str.back() == '\r')
+            {
+                str.remove_suffix(1);
+            }
+            pos = line = (eol == end ? end : eol + 1);
+            return str;
+        }
+
+        /**
+         * Moves to the next entry of a section, skipping comments and,
+         * if \a pretty is set, pretty printed lines starting with a
+         * tab. Returns false after consuming the empty (or indented)
+         * line terminating the section.
+         */
+        bool entry(bool pretty = false)
+        {
+            while (pos != end)
+            {
+                if (*pos == '#' || (pretty && *pos == '\t'))
+                {
+                    rest();
+                }
+                else if (isSpace(*pos))
+                {
+                    rest();
+                    return false;
+                }
+                else
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /** Consumes \a c if it is the next character. */
+        bool accept(char c)
+        {
+            if (pos != end && *pos == c)
+            {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c, const char *context)
+        {
+            if (!accept(c))
+            {
+                error(context);
+            }
+        }
+
+        /** Reads an integer preceded by optional blanks. */
+        bool number(int &value)
+        {
+            while (pos != end && (*pos == ' ' || *pos == '\t'))
+            {
+                ++pos;
+            }
+            auto result = std::from_chars(pos, end, value);
+            if (result.ec != std::errc())
+            {
+                return false;
+            }
+            pos = result.ptr;
+            return true;
+        }
+
+        int number(const char *context)
+        {
+            int value;
+            if (!number(value))
+            {
+                error(context);
+            }
+            return value;
+        }
+
+        /** Reads up to the next colon or the end of the line. */
+        std::string_view field()
+        {
+            const char *begin = pos;
+            while (pos != end && *pos != ':' && *pos != '\n' && *pos != '\r')
+            {
+                ++pos;
+            }
+            return std::string_view(begin, pos - begin);
+        }
+
+        /** Reads a non-empty word up to the next white space. */
+        std::string_view word(const char *context)
+        {
+            const char *begin = pos;
+            while (pos != end && !isSpace(*pos))
+            {
+                ++pos;
+            }
+            if (pos == begin)
+            {
+                error(context);
+            }
+            return std::string_view(begin, pos - begin);
+        }
+
+        /** Skips white space including line breaks. */
+        void skipSpace()
+        {
+            while (pos != end && isSpace(*pos))
+            {
+                if (*pos++ == '\n')
+                {
+                    line = pos;
+                }
+            }
+        }
+
+        /** Returns true if only blanks remain on the current line. */
+        bool atEol()
+        {
+            while (pos != end && (*pos == ' ' || *pos == '\t'))
+            {
+                ++pos;
+            }
+            return pos == end || *pos == '\n' || *pos == '\r';
+        }
+
+        /** Reads an integer preceded by any white space. */
+        bool next(int &value)
+        {
+            skipSpace();
+            return number(value);
+        }
+
+        int next(const char *context)
+        {
+            skipSpace();
+            return number(context);
+        }
+
+        /** Skips white space and the line with a terminating dot. */
+        void dot(const char *context)
+        {
+            skipSpace();
+            expect('.', context);
+            rest();
+        }
+
+        /** Throws FormatException quoting the current line. */
+        [[noreturn]] void error(const char *context)
+        {
+            pos = line;
+            std::string message = "In ";
+            message.append(context).append(": ").append(rest());
+            throw FormatException(message);
+        }
+    private:
+        const char *pos;
+        const char *line;
+        const char *end;
+
+        static bool isSpace(char c)
+        {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+    };
+
+    /**
+     * A cursor into a trace in the binary format. Integers are stored
+     * as LEB128 varints, and signed integers are zigzag encoded first.
+     */
+    class Decoder
+    {
+    public:
+        Decoder(const char *begin, const char *end):
+            begin(begin), pos(begin), end(end) {}
+
+        const char *position() const { return pos; }
+
+        uint8_t byte()
+        {
+            if (pos == end)
+            {
+                error();
+            }
+            return *pos++;
+        }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = byte();
+                value |= uint64_t(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                {
+                    return value;
+                }
+            }
+            error();
+        }
+
+        /** Reads a signed integer, which must fit in 32 bits. */
+        int32_t integer()
+        {
+            uint64_t value = varint();
+            if (value > std::numeric_limits<uint32_t>::max())
+            {
+                error();
+            }
+            return int32_t((value >> 1) ^ -(value & 1));
+        }
+
+        /** Throws FormatException stating the offset of the error. */
+        [[noreturn]] void error()
+        {
+            throw FormatException("In binary trace at offset "
+                                  + std::to_string(pos - begin));
+        }
+    private:
+        const char *begin;
+        const char *pos;
+        const char *end;
+    };
+
+    /**
+     * Buffered output. Text and numbers are copied directly into a
+     * fixed buffer which is written when full, so printing a step
+     * neither allocates nor flushes.
+     */
+    class Output
+    {
+    public:
+        explicit Output(FILE *file): file(file), pos(buffer) {}
+        Output(const Output &) = delete;
+        Output &operator=(const Output &) = delete;
+        ~Output() { flush(); }
+
+        Output &operator<<(char c)
+        {
+            if (pos == buffer + sizeof(buffer))
+            {
+                flush();
+            }
+            *pos++ = c;
+            return *this;
+        }
+
+        Output &operator<<(std::string_view str)
+        {
+            while (!str.empty())
+            {
+                if (pos == buffer + sizeof(buffer))
+                {
+                    flush();
+                }
+                size_t n = std::min(str.size(), size_t(buffer + sizeof(buffer) - pos));
+                memcpy(pos, str.data(), n);
+                pos += n;
+                str.remove_prefix(n);
+            }
+            return *this;
+        }
+
+        Output &operator<<(int value)
+        {
+            if (buffer + sizeof(buffer) - pos < 12)
+            {
+                flush();
+            }
+            pos = std::to_chars(pos, buffer + sizeof(buffer), value).ptr;
+            return *this;
+        }
+
+        /** Writes \a value as a LEB128 varint. */
+        void varint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                *this << char(value | 0x80);
+                value >>= 7;
+            }
+            *this << char(value);
+        }
+
+        /** Writes \a value zigzag encoded as a varint. */
+        void integer(int32_t value)
+        {
+            varint((uint32_t(value) << 1) ^ uint32_t(value >> 31));
+        }
+
+        void flush()
+        {
+            fwrite(buffer, 1, pos - buffer, file);
+            pos = buffer;
+        }
+    private:
+        FILE *file;
+        char buffer[1 << 16];
+        char *pos;
+    };
+
+    /**
+     * A model in the UPPAAL intermediate format. The intermediate
+     * format uses a global numbering of clocks, variables, locations,
+     * etc. This is in contrast to the XTR format, which makes a clear
+     * distinction between e.g. clocks and variables and uses process
+     * local numbers of locations and edges. Care must be taken to
+     * convert between these two numbering schemes.
+     *
+     * A model is not changed by reading traces, so one model can be
+     * shared by any number of traces and threads.
+     */
+    class IntermediateModel
+    {
+    public:
+        /** Representation of a memory cell. */
+        struct cell_t
+        {
+            enum type_t: int { CONST, CLOCK, VAR, META, SYS_META, COST, LOCATION, FIXED };
+            enum flags_t: int { NONE, COMMITTED, URGENT };
+            /** The type of the cell. */
+            type_t type;
+
+            /** Name of cell. Not all types have names. */
+            std::string name;
+
+            union
+            {
+                int value;
+                struct
+                {
+                    int nr;
+                } clock;
+                struct
+                {
+                    int min;
+                    int max;
+                    int init;
+                    int nr;
+                } var;
+                struct
+                {
+                    int min;
+                    int max;
+                    int init;
+                    int nr;
+                } meta;
+                struct
+                {
+                    int min;
+                    int max;
+                } sys_meta;
+                struct
+                {
+                    flags_t flags;
+                    int process;
+                    int invariant;
+                } location;
+                struct
+                {
+                    int min;
+                    int max;
+                } fixed;
+            };
+        };
+
+        /** Representation of a process. */
+        struct process_t
+        {
+            int initial;
+            std::string name;
+            std::vector<int> locations; /**< Layout indices of the locations */
+            std::vector<int> edges;     /**< Indices of the edges */
+        };
+
+        /** Representation of an edge. */
+        struct edge_t
+        {
+            int process;
+            int source;
+            int target;
+            int guard;
+            int sync;
+            int update;
+        };
+
+        /**
+         * Parses the intermediate format in [begin, end) in a single
+         * pass. Throws FormatException on errors.
+         */
+        void load(const char *begin, const char *end);
+
+        const std::vector<cell_t> &getLayout() const { return layout; }
+        const std::vector<int> &getInstructions() const { return instructions; }
+        const std::vector<process_t> &getProcesses() const { return processes; }
+        const std::vector<edge_t> &getEdges() const { return edges; }
+
+        /** Returns the edge with process local index \a edge. */
+        const edge_t &getEdge(int process, int edge) const
+        {
+            return edges[processes[process].edges[edge]];
+        }
+
+        /** Returns the name of a location with process local index. */
+        const std::string &getLocationName(int process, int location) const
+        {
+            return layout[processes[process].locations[location]].name;
+        }
+
+        /** Names of the clocks, starting with the reference clock. */
+        const std::vector<std::string> &getClocks() const { return clocks; }
+
+        /** Names of the variables. */
+        const std::vector<std::string> &getVariables() const { return variables; }
+
+        size_t getProcessCount() const { return processes.size(); }
+        size_t getVariableCount() const { return variables.size(); }
+        size_t getClockCount() const { return clocks.size(); }
+
+        /** Returns the text of an expression, or "" if there is none. */
+        std::string_view getExpression(int index) const;
+    private:
+        std::vector<cell_t> layout;
+        std::vector<int> instructions;
+        std::vector<process_t> processes;
+        std::vector<edge_t> edges;
+        std::map<int, std::string> expressions;
+        std::vector<std::string> clocks;
+        std::vector<std::string> variables;
+
+        void loadLayout(Scanner &in);
+        void loadInstructions(Scanner &in);
+        void loadProcesses(Scanner &in);
+        void loadLocations(Scanner &in);
+        void loadEdges(Scanner &in);
+        void loadExpressions(Scanner &in);
+    };
+
+    /**
+     * A bound for a clock constraint. A bound consists of a value and
+     * a bit indicating whether the bound is strict or not.
+     */
+    struct bound_t
+    {
+        int value   : 31; /**< The value of the bound */
+        bool strict : 1;  /**< True if the bound is strict */
+
+        static const bound_t infinity; /**< The bound (infinity, <) */
+        static const bound_t zero;     /**< The bound (0, <=) */
+
+        bool isInfinity() const { return value == infinity.value; }
+    };
+
+    inline const bound_t bound_t::infinity = { std::numeric_limits<int32_t>::max() >> 1, true };
+    inline const bound_t bound_t::zero = { 0, false };
+
+    /**
+     * A constraint x_i - x_j < or <= bound of a zone of \a n clocks.
+     * The clock pair is stored as the index i * n + j of the entry in
+     * the DBM, so sorting constraints by index sorts them in row-major
+     * order.
+     */
+    struct constraint_t
+    {
+        uint32_t index;
+        bound_t bound;
+
+        size_t getI(size_t n) const { return index / n; }
+        size_t getJ(size_t n) const { return index % n; }
+    };
+
+    /**
+     * Raw encoding of a bound used by the DBM operations: twice the
+     * value plus one if the bound is not strict. Raw bounds are
+     * ordered like the bounds they encode and are added with integer
+     * arithmetic. Like in the DBM library of UPPAAL, sums are not
+     * checked for overflow, so finite bounds must be far from the
+     * infinity bound, see isRawSafe().
+     */
+    typedef int32_t raw_t;
+
+    inline constexpr raw_t rawInfinity = (std::numeric_limits<int32_t>::max() >> 1) * 2;
+    inline constexpr raw_t rawZero = 1;
+
+    inline raw_t toRaw(bound_t b)
+    {
+        return b.isInfinity() ? rawInfinity : (b.value * 2) | !b.strict;
+    }
+
+    inline bound_t toBound(raw_t r)
+    {
+        return r == rawInfinity ? bound_t::infinity : bound_t{ r >> 1, !(r & 1) };
+    }
+
+    inline raw_t addRaw(raw_t a, raw_t b)
+    {
+        return (a == rawInfinity || b == rawInfinity)
+            ? rawInfinity : a + b - ((a | b) & 1);
+    }
+
+    /**
+     * Returns true if \a b is infinite or small enough for a DBM of
+     * \a dim clocks. Until the closure detects a negative cycle, its
+     * entries are sums of at most 2 * dim finite raw bounds, which
+     * then neither overflow nor reach the infinity bound.
+     */
+    inline bool isRawSafe(bound_t b, size_t dim)
+    {
+        int64_t raw = std::abs(int64_t(b.value)) * 2 + 1;
+        return b.isInfinity() || raw * 2 * int64_t(dim) < rawInfinity;
+    }
+
+    /**
+     * A difference bound matrix in raw encoding. Entry (i, j) bounds
+     * x_i - x_j, and clock 0 is the reference clock. Rows are padded
+     * with infinity to a multiple of 8 entries, which gives the inner
+     * loop of the closure a trip count the compiler vectorises.
+     */
+    class DBM
+    {
+    public:
+        explicit DBM(size_t dim = 0) { init(dim); }
+
+        /**
+         * Resets to the zone of \a dim clocks where all clocks are
+         * non-negative.
+         */
+        void init(size_t dim);
+
+        size_t getDimension() const { return dim; }
+
+        raw_t &operator()(size_t i, size_t j)      { return raw[i * stride + j]; }
+        raw_t operator()(size_t i, size_t j) const { return raw[i * stride + j]; }
+
+        /**
+         * Computes the canonical form with the Floyd-Warshall
+         * algorithm. Returns false if the zone is empty, in which case
+         * the contents are undefined except that isEmpty() holds.
+         */
+        bool close();
+
+        /**
+         * Returns true if some clock has a negative bound to itself.
+         * Only meaningful for closed DBMs.
+         */
+        bool isEmpty() const;
+
+        /**
+         * Returns true if no bound can be tightened by a path through
+         * another clock.
+         */
+        bool isClosed() const;
+
+        /**
+         * Computes the minimal set of constraints defining a closed,
+         * non-empty DBM. Clocks that are equal up to a constant form
+         * a cycle of constraints; other constraints are kept if they
+         * are not implied by a path through a third clock.
+         */
+        void reduce(std::vector<constraint_t> &constraints) const;
+    private:
+        size_t dim;
+        size_t stride;
+        std::vector<raw_t> raw;
+    };
+
+    /**
+     * A symbolic state of a trace. A symbolic state consists of a
+     * location vector, a variable vector and a zone describing the
+     * possible values of the clocks in a symbolic manner. A state is a
+     * buffer: read() overwrites it with the next state of a trace
+     * without allocating.
+     *
+     * The zone is kept as the sorted list of constraints given in the
+     * trace. All other entries of the DBM are implicit: the diagonal
+     * and the lower bounds x_0 - x_i <= 0 are zero, and the rest are
+     * infinity. Use expand() to get the full matrix.
+     */
+    class TraceState
+    {
+    public:
+        explicit TraceState(const IntermediateModel &model);
+        TraceState(const TraceState &) = delete;
+        TraceState &operator=(const TraceState &) = delete;
+
+        const IntermediateModel &getModel() const { return *model; }
+
+        /** Reads the next state from a trace. */
+        void read(Scanner &in);
+
+        /** Applies the changes of the next state of a binary trace. */
+        void readDelta(Decoder &in);
+
+        /**
+         * Writes the changes from \a previous to this state in the
+         * binary format.
+         */
+        void writeDelta(Output &out, const TraceState &previous) const;
+
+        /** Copies \a state of the same model without reallocating. */
+        void assign(const TraceState &state);
+
+        /**
+         * Resets to the state with all locations, variables and
+         * constraints zero or implicit.
+         */
+        void reset();
+
+        int &getLocation(int i)              { return locations[i]; }
+        int &getVariable(int i)              { return integers[i]; }
+
+        int getLocation(int i) const         { return locations[i]; }
+        int getVariable(int i) const         { return integers[i]; }
+        bound_t getConstraint(int i, int j) const;
+
+        /** The explicit constraints sorted by index. */
+        const std::vector<constraint_t> &getConstraints() const { return constraints; }
+
+        /**
+         * Calls f(i, j, bound) for every finite bound on x_i - x_j
+         * with i different from j in row-major order, including the
+         * implicit lower bounds.
+         */
+        template <typename F>
+        void forEachBound(F f) const;
+
+        /** Writes the full DBM of the zone to \a dbm. */
+        void expand(DBM &dbm) const;
+    private:
+        const IntermediateModel *model;
+        size_t clockCount;
+        std::vector<int> locations;
+        std::vector<int> integers;
+        std::vector<constraint_t> constraints;
+        std::vector<constraint_t> merged;  // Scratch space of readDelta()
+    };
+
+    /* Only the lower bounds of row 0 and the explicit constraints can
+     * be finite, so these are merged.
+     */
+    template <typename F>
+    void TraceState::forEachBound(F f) const
+    {
+        auto bound = [&f](size_t i, size_t j, bound_t bnd) {
+            if (i != j && !bnd.isInfinity())
+            {
+                f(i, j, bnd);
+            }
+        };
+        auto c = constraints.begin();
+        for (size_t j = 1; j < clockCount; j++)
+        {
+            while (c != constraints.end() && c->index < j)
+            {
+                ++c;
+            }
+            if (c != constraints.end() && c->index == j)
+            {
+                bound(0, j, c->bound);
+                ++c;
+            }
+            else
+            {
+                bound(0, j, bound_t::zero);
+            }
+        }
+        for (; c != constraints.end(); ++c)
+        {
+            bound(c->getI(clockCount), c->getJ(clockCount), c->bound);
+        }
+    }
+
+    /**
+     * A transition of a trace consists of one or more edges. Edges
+     * are indexed from 0 in the order they appear in the input file.
+     * The select values of all edges are kept in one vector such that
+     * read() can reuse the memory of the previous transition.
+     */
+    struct TraceTransition
+    {
+        struct Edge
+        {
+            int process;
+            int edge;       /**< Process local index of the edge */
+            size_t first;   /**< Index of first select value */
+            size_t last;    /**< Index after last select value */
+        };
+
+        std::vector<Edge> edges;
+        std::vector<int> selects;
+
+        explicit TraceTransition(const IntermediateModel &model): model(&model) {}
+
+        const IntermediateModel &getModel() const { return *model; }
+
+        /** Reads the next transition from a trace. */
+        void read(Scanner &in);
+
+        /** Reads the next transition from a binary trace. */
+        void readBinary(Decoder &in);
+
+        /** Writes the transition in the binary format. */
+        void writeBinary(Output &out) const;
+    private:
+        const IntermediateModel *model;
+    };
+
+    /**
+     * Reads the steps of a trace in the text (XTR) or the binary
+     * format. Step 0 is the initial state, every later step a state
+     * and the transition leading to it.
+     *
+     * A binary trace starts with the magic string "UTAPXTRB", a
+     * version number and the number of processes, variables and
+     * clocks, all varints. Every step is a tag byte followed by the
+     * changes to the previous state (see TraceState::writeDelta())
+     * and the transition. Every interval-th step is a keyframe whose
+     * changes are relative to the state reset by TraceState::reset(),
+     * such that reading can start there. The trace ends with an end
+     * tag.
+     */
+    class TraceReader
+    {
+    public:
+        static constexpr size_t interval = 1024;
+        static constexpr char magic[] = "UTAPXTRB";
+        static constexpr uint64_t version = 1;
+        enum tag_t : char { END, KEYFRAME, DELTA };
+
+        /** Starts reading a trace of \a model at step 0. */
+        TraceReader(const IntermediateModel &model, MappedFile &file);
+
+        /**
+         * Starts reading at \a step, which must start at \a offset. In
+         * binary traces \a step must be a multiple of interval.
+         */
+        TraceReader(const IntermediateModel &model, MappedFile &file,
+                    size_t offset, size_t step);
+
+        bool isBinary() const { return binary; }
+
+        /** Returns the number of the next step. */
+        size_t getStep() const { return step; }
+
+        /** Returns the offset of the next step in the file. */
+        size_t getOffset() const;
+
+        /**
+         * Reads the next step. In binary traces \a state must hold the
+         * previous step. Returns false at the end of the trace.
+         */
+        bool next(TraceState &state, TraceTransition &transition);
+
+        /** Releases the part of the file that has been read. */
+        void release();
+    private:
+        const IntermediateModel &model;
+        MappedFile &file;
+        bool binary;
+        size_t step;
+        Scanner scanner;
+        Decoder decoder;
+    };
+
+    /** Writes a trace in the binary format described at TraceReader. */
+    class TraceWriter
+    {
+    public:
+        /** Writes the header of a trace of \a model to \a file. */
+        TraceWriter(const IntermediateModel &model, FILE *file);
+
+        /** Writes the next step. */
+        void write(const TraceState &state, const TraceTransition &transition);
+
+        /** Writes the end tag and flushes the output. */
+        void close();
+    private:
+        Output out;
+        TraceState previous;
+        size_t step = 0;
+    };
+
+    /**
+     * A trace read from a file as a range of steps:
+     *
+     *     for (auto &step: Trace(model, file))
+     *     {
+     *         ... step.state, step.transition ...
+     *     }
+     *
+     * All steps share one state and one transition buffer, so the
+     * references of a step are only valid until the iterator is
+     * incremented, and a trace can only be iterated once. The part of
+     * the file that has been read is released regularly, so memory
+     * use does not depend on the length of the trace.
+     */
+    class Trace
+    {
+    public:
+        struct step_t
+        {
+            size_t number;                      /**< Step 0 is the initial state */
+            const TraceState &state;
+            const TraceTransition &transition;  /**< Leads to state if number > 0 */
+        };
+
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef step_t value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const step_t *pointer;
+            typedef step_t reference;
+
+            explicit iterator(Trace *trace = nullptr): trace(trace) {}
+
+            step_t operator*() const;
+            iterator &operator++();
+            bool operator==(const iterator &it) const { return trace == it.trace; }
+            bool operator!=(const iterator &it) const { return trace != it.trace; }
+        private:
+            Trace *trace;
+        };
+
+        Trace(const IntermediateModel &model, MappedFile &file);
+
+        /** Reads step 0. */
+        iterator begin();
+        iterator end() { return iterator(); }
+
+        /** Returns the number of steps read so far. */
+        size_t getSteps() const { return reader.getStep(); }
+    private:
+        TraceReader reader;
+        TraceState state;
+        TraceTransition transition;
+
+        bool next();
+    };
+}
+
+#endif
@@ -23,6 +23,7 @@
 #define UTAP_HH
 
 #include <cstdio>
+#include <string>
 
 #include "utap/common.h"
 #include "utap/symbols.h"
@@ -37,5 +38,6 @@ int32_t parseXMLBuffer(const char *, UTAP::TimedAutomataSystem *, bool newxta);
 int32_t parseXMLFile(const char *, UTAP::TimedAutomataSystem *, bool newxta);
 UTAP::expression_t parseExpression(const char *, UTAP::TimedAutomataSystem *, bool);
 int32_t writeXMLFile(const char *filename, UTAP::TimedAutomataSystem* taSystem);
+int32_t writeXMLBuffer(std::string &buffer, UTAP::TimedAutomataSystem* taSystem);
 
 #endif
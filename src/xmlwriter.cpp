@@ -443,3 +443,21 @@ int32_t writeXMLFile(const char *filename, TimedAutomataSystem* taSystem) {
     //xmlFreeTextWriter(writer);
     return 0;
 }
+
+int32_t writeXMLBuffer(std::string &buffer, TimedAutomataSystem* taSystem) {
+    xmlBufferPtr xmlBuffer = xmlBufferCreate();
+    if (xmlBuffer == NULL) {
+        throw std::runtime_error("Error creating the xml buffer");
+    }
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(xmlBuffer, 0);
+    if (writer == NULL) {
+        xmlBufferFree(xmlBuffer);
+        throw std::runtime_error("Error creating the xml writer");
+    }
+    /* The writer is flushed to the buffer when it is freed. */
+    XMLWriter(writer, taSystem).project();
+    buffer.assign((const char*) xmlBufferContent(xmlBuffer),
+                  xmlBufferLength(xmlBuffer));
+    xmlBufferFree(xmlBuffer);
+    return 0;
+}